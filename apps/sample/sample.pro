@@ -18,12 +18,14 @@ SUBDIRS = \
 	trimesh_align_pair \
 	trimesh_allocate \
 	trimesh_attribute \
+	trimesh_attribute_lookup \
 	trimesh_attribute_saving \
 	trimesh_ball_pivoting \
 	trimesh_base  \
 	trimesh_closest \
 	trimesh_clustering \
 	trimesh_color \
+	trimesh_coord_ocf \
 	trimesh_copy \
 	trimesh_create \
 	trimesh_curvature \
@@ -43,20 +45,26 @@ SUBDIRS = \
 	trimesh_kdtree \
 	trimesh_montecarlo_sampling \
 	trimesh_normal \
+	trimesh_normal_parallel \
 	trimesh_optional \
 	trimesh_pointmatching \
 	trimesh_pointcloud_sampling \
+	trimesh_progressive \
 	trimesh_ray \
 	trimesh_refine \
 	trimesh_remeshing \
+	trimesh_remove_duplicate \
 	trimesh_sampling \
 	trimesh_select \
 	trimesh_smooth \
+	trimesh_split_components \
 	trimesh_split_vertex \
 	trimesh_texture \
 	trimesh_texture_clean \
 	trimesh_topology \
+	trimesh_topology_parallel \
 	trimesh_topological_cut \
+	trimesh_vf_csr \
 	trimesh_voronoi \
 	trimesh_voronoiatlas \
 	trimesh_voronoiclustering \
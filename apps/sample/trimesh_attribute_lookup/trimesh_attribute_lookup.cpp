@@ -0,0 +1,142 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_attribute_lookup.cpp
+\ingroup code_sample
+
+\brief Check of the hashed attribute lookups against a scan of the attribute set.
+
+Many named and unnamed per-vertex attributes are added to a mesh. Every attribute is then looked up
+by name and by id with the hashed indexes of the attribute set (FindByName, FindById, as used by
+FindPerVertexAttribute and IsValidHandle) and with a linear scan of the set, as done before; the
+timings are printed and the results are checked to be the same, also after deleting half of the attributes.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include<vcg/complex/complex.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+typedef MyMesh::PerVertexAttributeHandle<float> FloatHandle;
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+// the lookups by scanning the whole set, used as reference
+static const PointerToAttribute *ScanByName(const MyMesh &m, const std::string &name)
+{
+  for(AttributeSet::const_iterator ai=m.vert_attr.begin();ai!=m.vert_attr.end();++ai)
+    if((*ai)._name==name) return &*ai;
+  return 0;
+}
+
+static const PointerToAttribute *ScanById(const MyMesh &m, int n_attr)
+{
+  for(AttributeSet::const_iterator ai=m.vert_attr.begin();ai!=m.vert_attr.end();++ai)
+    if((*ai).n_attr==n_attr) return &*ai;
+  return 0;
+}
+
+static const PointerToAttribute *Hashed(const MyMesh &m, AttributeSet::const_iterator ai)
+{
+  return ai==m.vert_attr.end() ? 0 : &*ai;
+}
+
+// compare the hashed lookups with the scans for all the given names and handles
+static int CheckLookups(MyMesh &m, const std::vector<std::string> &names, const std::vector<FloatHandle> &named,
+                        const std::vector<FloatHandle> &unnamed)
+{
+  int diffCnt=0;
+  for(size_t i=0;i<names.size();++i)
+  {
+    const PointerToAttribute *p = ScanByName(m,names[i]);
+    if(Hashed(m,m.vert_attr.FindByName(names[i]))!=p) ++diffCnt;
+    if(tri::HasPerVertexAttribute(m,names[i])!=(p!=0)) ++diffCnt;
+    if(tri::Allocator<MyMesh>::IsValidHandle(m,named[i])!=(ScanById(m,named[i].n_attr)!=0)) ++diffCnt;
+    if(p!=0 && tri::Allocator<MyMesh>::FindPerVertexAttribute<float>(m,names[i])._handle!=p->_handle) ++diffCnt;
+  }
+  for(size_t i=0;i<unnamed.size();++i)
+  {
+    const PointerToAttribute *p = ScanById(m,unnamed[i].n_attr);
+    if(Hashed(m,m.vert_attr.FindById(unnamed[i].n_attr))!=p) ++diffCnt;
+    if(tri::Allocator<MyMesh>::IsValidHandle(m,unnamed[i])!=(p!=0)) ++diffCnt;
+  }
+  return diffCnt;
+}
+
+int main(int argc,char ** argv)
+{
+  int attrNum = 2000;
+  if(argc>1) attrNum = atoi(argv[1]);
+
+  MyMesh m;
+  tri::Allocator<MyMesh>::AddVertices(m,100);
+  std::vector<std::string> names;
+  std::vector<FloatHandle> named, unnamed;
+  for(int i=0;i<attrNum;++i)
+  {
+    names.push_back("attr_"+std::to_string(i));
+    named.push_back(tri::Allocator<MyMesh>::GetPerVertexAttribute<float>(m,names.back()));
+    unnamed.push_back(tri::Allocator<MyMesh>::GetPerVertexAttribute<float>(m));
+  }
+  printf("Mesh has %i per vertex attributes\n",int(m.vert_attr.size()));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  size_t found0=0;
+  for(int i=0;i<attrNum;++i)
+    found0 += (ScanByName(m,names[i])!=0) + (ScanById(m,unnamed[i].n_attr)!=0);
+  printf("Scanned lookups %8.5f sec\n",Elapsed(start));
+
+  start = std::chrono::steady_clock::now();
+  size_t found1=0;
+  for(int i=0;i<attrNum;++i)
+    found1 += (m.vert_attr.FindByName(names[i])!=m.vert_attr.end()) + (m.vert_attr.FindById(unnamed[i].n_attr)!=m.vert_attr.end());
+  printf("Hashed  lookups %8.5f sec\n",Elapsed(start));
+
+  int diffCnt = (found0==found1 && found1==size_t(2*attrNum)) ? 0 : 1;
+  diffCnt += CheckLookups(m,names,named,unnamed);
+
+  // delete half of the attributes, by name and by handle, and check again
+  for(int i=0;i<attrNum;i+=2)
+  {
+    tri::Allocator<MyMesh>::DeletePerVertexAttribute(m,names[i]);
+    tri::Allocator<MyMesh>::DeletePerVertexAttribute(m,unnamed[i]);
+  }
+  if(int(m.vert_attr.size())!=attrNum) ++diffCnt;
+  diffCnt += CheckLookups(m,names,named,unnamed);
+
+  printf("%i differences\n",diffCnt);
+  return diffCnt==0 ? 0 : -1;
+}
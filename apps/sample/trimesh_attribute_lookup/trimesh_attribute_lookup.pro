@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_attribute_lookup
+SOURCES += trimesh_attribute_lookup.cpp
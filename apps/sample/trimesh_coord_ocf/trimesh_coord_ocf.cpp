@@ -0,0 +1,140 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2026                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+
+/*! \file trimesh_coord_ocf.cpp
+\ingroup code_sample
+
+\brief how to keep the vertex positions out of the vertices with the Coord3fOcf component.
+
+With vertex::Coord3fOcf the positions are packed in an array owned by the vector_ocf container,
+so the container operations that add, move or remove vertices must carry the positions along.
+This sample checks them against an identical mesh that uses the plain Coord3f component.
+*/
+
+#include<vcg/complex/complex.h>
+
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/complex/algorithms/clean.h>
+#include<vcg/complex/append.h>
+
+class MyFace;
+class MyVertex;
+
+struct MyUsedTypes:    public	vcg::UsedTypes<
+    vcg::Use<MyVertex>::AsVertexType,
+    vcg::Use<MyFace  >::AsFaceType>{};
+
+class MyVertex     : public vcg::Vertex<	MyUsedTypes,
+    vcg::vertex::Coord3f,  vcg::vertex::BitFlags >{};
+
+class MyFace       : public vcg::Face< MyUsedTypes,
+    vcg::face::VertexRef,  vcg::face::BitFlags > {};
+class MyMesh       : public vcg::tri::TriMesh<     std::vector<MyVertex   >,           std::vector<MyFace   > > {};
+
+
+class MyVertexOcf;
+class MyFaceOcf;
+
+struct MyUsedTypesOcf: public	vcg::UsedTypes<
+    vcg::Use<MyVertexOcf>::AsVertexType,
+    vcg::Use<MyFaceOcf>::AsFaceType>{};
+
+class MyVertexOcf  : public vcg::Vertex< MyUsedTypesOcf,
+    vcg::vertex::InfoOcf,       //   <--- the 'special' InfoOcf component is needed also by Coord3fOcf
+    vcg::vertex::Coord3fOcf,    //   <--- the position is kept in the vector_ocf container
+    vcg::vertex::BitFlags >{};
+
+class MyFaceOcf    : public vcg::Face< MyUsedTypesOcf,
+    vcg::face::VertexRef,  vcg::face::BitFlags > {};
+
+class MyMeshOcf : public vcg::tri::TriMesh< vcg::vertex::vector_ocf<MyVertexOcf>, std::vector<MyFaceOcf> > {};
+
+
+using namespace vcg;
+using namespace std;
+
+// Compare the vertex positions and the faces of the two meshes
+bool SameMesh(MyMesh &m, MyMeshOcf &mo)
+{
+  if(m.vert.size()!=mo.vert.size() || m.face.size()!=mo.face.size()) return false;
+  for(size_t i=0;i<m.vert.size();++i)
+    if(m.vert[i].IsD()!=mo.vert[i].IsD() || (!m.vert[i].IsD() && m.vert[i].cP()!=mo.vert[i].cP())) return false;
+  for(size_t i=0;i<m.face.size();++i)
+    if(!m.face[i].IsD())
+      for(int j=0;j<3;++j)
+        if(tri::Index(m,m.face[i].cV(j))!=tri::Index(mo,mo.face[i].cV(j))) return false;
+  return true;
+}
+
+int main(int , char **)
+{
+  MyMesh m;
+  MyMeshOcf mo;
+
+  // Some vertices are added below directly through the containers, without the Allocator:
+  // reserve the space so that the face to vertex pointers stay valid.
+  m.vert.reserve(100);
+  mo.vert.reserve(100);
+
+  tri::Dodecahedron(m);
+  tri::Dodecahedron(mo);
+  printf("Generated mesh has %i vertices and %i triangular faces\n",mo.VN(),mo.FN());
+  int ok=SameMesh(m,mo);
+  printf("Create:        %s\n",ok?"ok":"FAILED");
+
+
+  // push_back of a vertex of the same container: the position must be copied too
+  m.vert.push_back(m.vert[3]);   m.vn++;
+  mo.vert.push_back(mo.vert[3]); mo.vn++;
+  ok&=SameMesh(m,mo);
+  printf("push_back:     %s\n",SameMesh(m,mo)?"ok":"FAILED");
+
+  // resize keeps the existing positions and grows the packed array
+  m.vert.resize(m.vert.size()+5);  m.vn+=5;
+  mo.vert.resize(mo.vert.size()+5); mo.vn+=5;
+  for(size_t i=m.vert.size()-5;i<m.vert.size();++i)
+  {
+    m.vert[i].P()  = Point3f(i,2*i,3*i);
+    mo.vert[i].P() = Point3f(i,2*i,3*i);
+  }
+  ok&=SameMesh(m,mo);
+  printf("resize:        %s\n",SameMesh(m,mo)?"ok":"FAILED");
+
+  // Append copies the positions through ImportData, also from a mesh with the plain Coord3f
+  MyMesh ico;
+  tri::Icosahedron(ico);
+  tri::Append<MyMesh,MyMesh>::Mesh(m,ico);
+  tri::Append<MyMeshOcf,MyMesh>::Mesh(mo,ico);
+  ok&=SameMesh(m,mo);
+  printf("Append:        %s\n",SameMesh(m,mo)?"ok":"FAILED");
+
+  // Compact moves the surviving positions and shrinks the packed array
+  tri::Clean<MyMesh>::RemoveUnreferencedVertex(m);
+  tri::Clean<MyMeshOcf>::RemoveUnreferencedVertex(mo);
+  tri::Allocator<MyMesh>::CompactEveryVector(m);
+  tri::Allocator<MyMeshOcf>::CompactEveryVector(mo);
+  ok&=SameMesh(m,mo);
+  printf("Compact:       %s (%i vertices)\n",SameMesh(m,mo)?"ok":"FAILED",mo.VN());
+
+  return ok?0:1;
+}
@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_coord_ocf
+SOURCES += trimesh_coord_ocf.cpp
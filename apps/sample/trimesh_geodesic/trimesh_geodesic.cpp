@@ -89,6 +89,13 @@ int main( int argc, char **argv )
   printf("Geodesic dijkstra %6.3f\n",float(t1-t0)/CLOCKS_PER_SEC);
   tri::UpdateColor<MyMesh>::PerVertexQualityRamp(m);
   tri::io::ExporterPLY<MyMesh>::Save(m,"base_d.ply",tri::io::Mask::IOM_VERTCOLOR | tri::io::Mask::IOM_VERTQUALITY);
+  int t2=clock();
+  tri::Geodesic<MyMesh>::PerVertexDeltaSteppingCompute(m,seedVec,ed);
+  int t3=clock();
+  printf("Geodesic delta-stepping %6.3f\n",float(t3-t2)/CLOCKS_PER_SEC);
+  tri::Geodesic<MyMesh>::ParallelCompute(m,seedVec,ed);
+  minmax = tri::Stat<MyMesh>::ComputePerVertexQualityMinMax(m);
+  printf("parallel min %f max %f\n",minmax.first,minmax.second);
 
   return 0;
 }
@@ -27,6 +27,7 @@
 
 Two meshes are created a rectangular box and a torus and their mass properties are computed and shown.
 The result should match the closed formula for these objects (with a reasonable approximation)
+The volume, area and edge statistics of the torus are also computed in a single pass with vcg::tri::Stat::ComputeStatistics.
 
 */
 
@@ -35,6 +36,7 @@ The result should match the closed formula for these objects (with a reasonable
 #include<wrap/io_trimesh/import_off.h>
 
 #include<vcg/complex/algorithms/inertia.h>
+#include<vcg/complex/algorithms/stat.h>
 #include<vcg/complex/algorithms/create/platonic.h>
 
 class MyEdge;
@@ -98,6 +100,13 @@ int main( int argc, char **argv )
   printf(" %6.3f %6.3f %6.3f\n",IT[1][0],IT[1][1],IT[1][2]);
   printf(" %6.3f %6.3f %6.3f\n",IT[2][0],IT[2][1],IT[2][2]);
 
+  typedef vcg::tri::Stat<MyMesh> MyStat;
+  MyStat::Statistics st;
+  MyStat::ComputeStatistics(torusMesh,st,MyStat::STAT_AREA|MyStat::STAT_VOLUME|MyStat::STAT_SHELL_BARYCENTER|MyStat::STAT_FACE_EDGE_LENGTH);
+  printf("Volume %f Area %f\n",st.volume,st.area);
+  printf("ShellBarycenter %f %f %f\n",st.shellBarycenter[0],st.shellBarycenter[1],st.shellBarycenter[2]);
+  printf("Edge length min %f max %f avg %f\n",st.edgeLengthMin,st.edgeLengthMax,st.edgeLengthAvg);
+
   /*
      Now we have a torus with c = 2, a = 1
      c = radius of the ring
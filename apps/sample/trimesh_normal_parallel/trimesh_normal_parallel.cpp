@@ -0,0 +1,123 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_normal_parallel.cpp
+\ingroup code_sample
+
+\brief Comparison of the gather-based parallel vertex normals with the serial ones.
+
+A torus is generated, its vertices are randomly displaced and some faces are deleted. The vertex
+normals are computed with UpdateNormal::PerVertexNormalized and with PerVertexParallel followed by
+NormalizePerVertex, and the same is done for the angle and the Nelson Max weighting; the timings
+are printed and the normals are checked to be identical. The adjacency is then reused after moving the vertices.
+*/
+
+#include <chrono>
+#include <cstdlib>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/math/random_generator.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::Normal3f, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+typedef tri::UpdateNormal<MyMesh> UN;
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+static void Displace(MyMesh &m, math::MarsenneTwisterRNG &rnd, float amount)
+{
+  for(size_t i=0;i<m.vert.size();++i)
+    m.vert[i].P() += Point3f(rnd.generate01()-0.5f,rnd.generate01()-0.5f,rnd.generate01()-0.5f)*amount;
+}
+
+static std::vector<Point3f> Normals(const MyMesh &m)
+{
+  std::vector<Point3f> n(m.vert.size());
+  for(size_t i=0;i<m.vert.size();++i) n[i]=m.vert[i].cN();
+  return n;
+}
+
+int main(int argc,char ** argv)
+{
+  int ringDiv = 1000;
+  if(argc>1) ringDiv = atoi(argv[1]);
+
+  MyMesh m;
+  tri::Torus(m,2.0f,1.0f,ringDiv,ringDiv);
+  math::MarsenneTwisterRNG rnd(42);
+  Displace(m,rnd,0.5f/ringDiv);
+  for(size_t i=0;i<m.face.size();i+=13)
+    tri::Allocator<MyMesh>::DeleteFace(m,m.face[i]);
+  printf("Mesh has %i vert and %i faces\n",m.VN(),m.FN());
+
+  int diffCnt=0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  UN::PerVertexNormalized(m);
+  printf("PerVertexNormalized %6.3f sec\n",Elapsed(start));
+  std::vector<Point3f> n0 = Normals(m);
+
+  tri::VFAdjacencyCSR<MyMesh> vfa;
+  start = std::chrono::steady_clock::now();
+  UN::PerVertexParallel(m,vfa);
+  UN::NormalizePerVertex(m);
+  printf("PerVertexParallel   %6.3f sec (adjacency included)\n",Elapsed(start));
+  if(Normals(m)!=n0) ++diffCnt;
+
+  UN::PerVertexAngleWeighted(m);
+  UN::NormalizePerVertex(m);
+  n0 = Normals(m);
+  UN::PerVertexParallel(m,vfa,UN::AngleWeight);
+  UN::NormalizePerVertex(m);
+  if(Normals(m)!=n0) ++diffCnt;
+
+  UN::PerVertexNelsonMaxWeighted(m);
+  UN::NormalizePerVertex(m);
+  n0 = Normals(m);
+  UN::PerVertexParallel(m,vfa,UN::NelsonMaxWeight);
+  UN::NormalizePerVertex(m);
+  if(Normals(m)!=n0) ++diffCnt;
+
+  // only the positions change: the adjacency is reused
+  Displace(m,rnd,0.5f/ringDiv);
+  UN::PerVertexNormalized(m);
+  n0 = Normals(m);
+  start = std::chrono::steady_clock::now();
+  UN::PerVertexParallel(m,vfa);
+  UN::NormalizePerVertex(m);
+  printf("PerVertexParallel   %6.3f sec (adjacency reused)\n",Elapsed(start));
+  if(Normals(m)!=n0) ++diffCnt;
+
+  printf("%i differences\n",diffCnt);
+  return diffCnt==0 ? 0 : -1;
+}
@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_normal_parallel
+SOURCES += trimesh_normal_parallel.cpp
@@ -0,0 +1,143 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_progressive.cpp
+\ingroup code_sample
+
+\brief Record a quadric simplification as a progressive mesh and refine it back.
+
+A torus is simplified with the quadric edge collapse while a tri::ProgressiveMesh records the collapses;
+the base mesh and the vertex splits are saved to a file. The file is then reopened with
+tri::ProgressiveMeshReader into a mesh that has only the vertex references of the faces, refined to an
+intermediate face budget and finally to the end: the fully refined mesh must have exactly the faces
+of the original torus.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/complex/algorithms/local_optimization.h>
+#include<vcg/complex/algorithms/local_optimization/tri_edge_collapse_quadric.h>
+#include<vcg/complex/algorithms/local_optimization/progressive_mesh.h>
+
+using namespace vcg;
+
+// the mesh used for the simplification, with the quadric and the adjacency needed by the collapse
+class MyVertex;
+class MyFace;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::VFAdj, vertex::Coord3f, vertex::Mark, vertex::BitFlags  >{
+public:
+  math::Quadric<double> &Qd() {return q;}
+private:
+  math::Quadric<double> q;
+};
+class MyFace    : public Face  < MyUsedTypes, face::VFAdj, face::VertexRef, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+typedef tri::BasicVertexPair<MyVertex> VertexPair;
+class MyTriEdgeCollapse: public tri::TriEdgeCollapseQuadric< MyMesh, VertexPair, MyTriEdgeCollapse, tri::QInfoStandard<MyVertex> > {
+public:
+  typedef tri::TriEdgeCollapseQuadric< MyMesh, VertexPair, MyTriEdgeCollapse, tri::QInfoStandard<MyVertex> > TECQ;
+  inline MyTriEdgeCollapse( const VertexPair &p, int i, BaseParameterClass *pp) :TECQ(p,i,pp){}
+};
+
+// the mesh used for the refinement, with the vertex references only
+class PVertex;
+class PFace;
+struct PUsedTypes : public UsedTypes<	Use<PVertex>::AsVertexType, Use<PFace>::AsFaceType>{};
+class PVertex  : public Vertex< PUsedTypes, vertex::Coord3f, vertex::BitFlags  >{};
+class PFace    : public Face  < PUsedTypes, face::VertexRef, face::BitFlags > {};
+class PMesh : public tri::TriMesh< std::vector<PVertex>, std::vector<PFace > >{};
+
+// the faces of a mesh as position triples, each one starting from its smallest vertex, sorted
+template <class MeshType>
+static std::vector< std::vector<Point3f> > FaceSet(const MeshType &m)
+{
+  std::vector< std::vector<Point3f> > fs;
+  for(size_t i=0;i<m.face.size();++i)
+    if(!m.face[i].IsD())
+    {
+      std::vector<Point3f> f(3);
+      for(int k=0;k<3;++k) f[k]=m.face[i].cP(k);
+      std::rotate(f.begin(),std::min_element(f.begin(),f.end()),f.end());
+      fs.push_back(f);
+    }
+  std::sort(fs.begin(),fs.end());
+  return fs;
+}
+
+int main(int argc,char ** argv)
+{
+  const char *filename = "torus.pm";
+  int baseFaceNum = 500;
+  if(argc>1) baseFaceNum = atoi(argv[1]);
+  if(argc>2) filename = argv[2];
+
+  MyMesh m;
+  tri::Torus(m,2.0f,1.0f,100,100);
+  const std::vector< std::vector<Point3f> > origFaces = FaceSet(m);
+  const int origFaceNum = m.FN();
+
+  // simplify recording the collapses
+  tri::TriEdgeCollapseQuadricParameter qparams;
+  tri::UpdateTopology<MyMesh>::VertexFace(m);
+  LocalOptimization<MyMesh> deciSession(m,&qparams);
+  tri::ProgressiveMesh<MyMesh> pm;
+  pm.Start(m);
+  deciSession.Recorder = &pm;
+  deciSession.Init<MyTriEdgeCollapse>();
+  deciSession.SetTargetSimplices(baseFaceNum);
+  while(deciSession.DoOptimization() && m.fn>baseFaceNum) {}
+  printf("Simplified %i faces to %i, recorded %i vertex splits\n",origFaceNum,m.FN(),pm.SplitNum());
+  if(!pm.Save(filename))
+  {
+    printf("Unable to save %s\n",filename);
+    return -1;
+  }
+
+  // reopen it and refine it, first to an intermediate budget then to the end
+  PMesh pmesh;
+  tri::ProgressiveMeshReader<PMesh> pmr;
+  if(!pmr.Open(pmesh,filename))
+  {
+    printf("Unable to open %s\n",filename);
+    return -1;
+  }
+  printf("Base mesh %i vert %i faces, %i splits to %i faces\n",pmesh.VN(),pmesh.FN(),pmr.SplitLeft(),pmr.FullFaceNum());
+  int errCnt = 0;
+  const int midFaceNum = (baseFaceNum+origFaceNum)/2;
+  int splitNum = pmr.Refine(pmesh,midFaceNum);
+  printf("Refined with %i splits to %i vert %i faces\n",splitNum,pmesh.VN(),pmesh.FN());
+  if(splitNum<0 || pmesh.FN()<midFaceNum || pmesh.FN()>midFaceNum+2) ++errCnt;
+  splitNum = pmr.Refine(pmesh,origFaceNum);
+  printf("Refined with %i splits to %i vert %i faces\n",splitNum,pmesh.VN(),pmesh.FN());
+  if(splitNum<0 || pmr.SplitLeft()!=0) ++errCnt;
+  pmr.Close();
+
+  if(pmesh.FN()!=origFaceNum || FaceSet(pmesh)!=origFaces) ++errCnt;
+  printf("%i errors\n",errCnt);
+  return errCnt==0 ? 0 : -1;
+}
@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_progressive
+SOURCES += trimesh_progressive.cpp
@@ -0,0 +1,141 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_remove_duplicate.cpp
+\ingroup code_sample
+
+\brief Benchmark of Clean::RemoveDuplicateVertex on a triangle soup.
+
+A torus is generated and exploded into a triangle soup (every face has its own three vertices,
+as in a mesh loaded from STL). The soup is welded with Clean::RemoveDuplicateVertex and with a
+plain sort based implementation kept here as reference; the timings are printed and the two
+resulting meshes are checked to be identical.
+One vertex slot of the last face is left null, as it can happen in a partially built mesh:
+both implementations must skip it.
+The default size gives a soup of more than 10M vertices.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/complex/algorithms/clean.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+// the sort and map based welding, used as reference
+static int RemoveDuplicateVertexSorted(MyMesh &m)
+{
+  std::vector<MyVertex *> perm(m.vert.size());
+  for(size_t i=0;i<m.vert.size();++i)
+    perm[i]=&m.vert[i];
+  std::sort(perm.begin(),perm.end(),tri::Clean<MyMesh>::RemoveDuplicateVert_Compare());
+
+  std::map<MyVertex *, MyVertex *> mp;
+  int deleted=0;
+  size_t j=0;
+  for(size_t i=1;i<perm.size();++i)
+  {
+    if(!perm[i]->IsD() && !perm[j]->IsD() && perm[i]->cP()==perm[j]->cP())
+    {
+      mp[perm[i]]=perm[j];
+      tri::Allocator<MyMesh>::DeleteVertex(m,*perm[i]);
+      ++deleted;
+    }
+    else j=i;
+  }
+  for(MyMesh::FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+    for(int k=0;k<3;++k)
+      if(mp.find(fi->V(k))!=mp.end())
+        fi->V(k)=mp[fi->V(k)];
+  return deleted;
+}
+
+static void BuildSoup(MyMesh &soup, int ringDiv)
+{
+  MyMesh torus;
+  tri::Torus(torus,2.0f,1.0f,ringDiv,ringDiv);
+  MyMesh::VertexIterator vi = tri::Allocator<MyMesh>::AddVertices(soup,torus.face.size()*3);
+  MyMesh::FaceIterator fi = tri::Allocator<MyMesh>::AddFaces(soup,torus.face.size());
+  for(size_t i=0;i<torus.face.size();++i,++fi)
+    for(int k=0;k<3;++k,++vi)
+    {
+      vi->P()=torus.face[i].P(k);
+      fi->V(k)=&*vi;
+    }
+}
+
+int main(int argc,char ** argv)
+{
+  int ringDiv = 1300;
+  if(argc>1) ringDiv = atoi(argv[1]);
+
+  MyMesh m0,m1;
+  BuildSoup(m0,ringDiv);
+  BuildSoup(m1,ringDiv);
+  // a face with a null vertex slot must be left untouched
+  m0.face.back().V(2)=0;
+  m1.face.back().V(2)=0;
+  printf("Soup has %i vert and %i faces\n",m0.VN(),m0.FN());
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  int del0 = RemoveDuplicateVertexSorted(m0);
+  printf("Sorted  welding %6.3f sec (%i removed)\n",Elapsed(start),del0);
+
+  start = std::chrono::steady_clock::now();
+  int del1 = tri::Clean<MyMesh>::RemoveDuplicateVertex(m1,false);
+  printf("Hashed  welding %6.3f sec (%i removed)\n",Elapsed(start),del1);
+
+  int diffCnt = (del0==del1) ? 0 : 1;
+  for(size_t i=0;i<m0.vert.size();++i)
+    if(m0.vert[i].IsD()!=m1.vert[i].IsD())
+      ++diffCnt;
+  for(size_t i=0;i<m0.face.size();++i)
+    for(int k=0;k<3;++k)
+    {
+      if(m0.face[i].V(k)==0 || m1.face[i].V(k)==0)
+      {
+        if(m0.face[i].V(k)!=0 || m1.face[i].V(k)!=0)
+          ++diffCnt;
+      }
+      else if(tri::Index(m0,m0.face[i].V(k))!=tri::Index(m1,m1.face[i].V(k)))
+        ++diffCnt;
+    }
+
+  printf("%i differences\n",diffCnt);
+  return diffCnt==0 ? 0 : -1;
+}
@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_remove_duplicate
+SOURCES += trimesh_remove_duplicate.cpp
@@ -0,0 +1,108 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_split_components.cpp
+\ingroup code_sample
+
+\brief Check of Clean::SplitManifoldComponents on a mesh with non-manifold vertices.
+
+A grid of octahedra is built so that each one touches its neighbours in a single vertex; the coincident
+vertices are welded, so that the whole grid is a single vertex connected piece where every contact
+point is a non-manifold vertex. After SplitManifoldComponents the number of components must be the
+number of octahedra, no vertex may be shared by two components and the mesh must be compact.
+*/
+
+#include <cstdlib>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/append.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/complex/algorithms/clean.h>
+#include<vcg/complex/algorithms/update/position.h>
+#include<vcg/complex/algorithms/update/topology.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef, face::FFAdj, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+// a gridDim x gridDim grid of unit octahedra, each one touching its neighbours in a vertex
+static void BuildGrid(MyMesh &m, int gridDim)
+{
+  for(int i=0;i<gridDim;++i)
+    for(int j=0;j<gridDim;++j)
+    {
+      MyMesh oct;
+      tri::Octahedron(oct);
+      tri::UpdatePosition<MyMesh>::Translate(oct,Point3f(2.0f*i,2.0f*j,0));
+      tri::Append<MyMesh,MyMesh>::Mesh(m,oct);
+    }
+  tri::Clean<MyMesh>::RemoveDuplicateVertex(m);
+  tri::Allocator<MyMesh>::CompactEveryVector(m);
+}
+
+int main(int argc,char ** argv)
+{
+  int gridDim = 10;
+  if(argc>1) gridDim = atoi(argv[1]);
+  const int octNum = gridDim*gridDim;
+
+  MyMesh m;
+  BuildGrid(m,gridDim);
+  tri::UpdateTopology<MyMesh>::FaceFace(m);
+  std::vector<int> label;
+  const int nonManifoldNum = tri::Clean<MyMesh>::CountNonManifoldVertexFF(m);
+  const int vertexCCNum = tri::Clean<MyMesh>::ConnectedComponentsLabel(m,label,true);
+  printf("Grid of %i octahedra: %i vert, %i faces, %i non manifold vertices, %i vertex connected pieces\n",
+         octNum,m.VN(),m.FN(),nonManifoldNum,vertexCCNum);
+
+  const size_t ccNum = tri::Clean<MyMesh>::SplitManifoldComponents(m);
+  printf("Split in %i components: %i vert, %i faces\n",int(ccNum),m.VN(),m.FN());
+
+  int errCnt = 0;
+  if(int(ccNum)!=octNum) ++errCnt;
+  if(m.VN()!=6*octNum || m.FN()!=8*octNum) ++errCnt;
+  if(m.VN()!=int(m.vert.size()) || m.FN()!=int(m.face.size())) ++errCnt;
+
+  // every vertex must belong to the faces of a single component
+  tri::UpdateTopology<MyMesh>::FaceFace(m);
+  const int splitCCNum = tri::Clean<MyMesh>::ConnectedComponentsLabel(m,label);
+  std::vector<int> vertLabel(m.vert.size(),-1);
+  int sharedCnt = 0;
+  for(size_t i=0;i<m.face.size();++i)
+    for(int k=0;k<3;++k)
+    {
+      int &vl = vertLabel[tri::Index(m,m.face[i].V(k))];
+      if(vl==-1) vl = label[i];
+      else if(vl!=label[i]) ++sharedCnt;
+    }
+  if(splitCCNum!=octNum || sharedCnt!=0) ++errCnt;
+  if(tri::Clean<MyMesh>::CountNonManifoldVertexFF(m)!=0) ++errCnt;
+  if(tri::Clean<MyMesh>::ConnectedComponentsLabel(m,label,true)!=octNum) ++errCnt;
+  printf("%i vertices shared between components, %i errors\n",sharedCnt,errCnt);
+  return errCnt==0 ? 0 : -1;
+}
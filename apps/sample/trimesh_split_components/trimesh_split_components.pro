@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_split_components
+SOURCES += trimesh_split_components.cpp
@@ -0,0 +1,95 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_topology_parallel.cpp
+\ingroup code_sample
+
+\brief Benchmark of the multi-threaded FaceFace adjacency builder against the serial one.
+
+A torus is generated (optionally made non manifold by doubling some of its faces),
+then the FF adjacency is computed with both UpdateTopology::FaceFace and
+UpdateTopology::FaceFaceParallel, timing them and checking that the results are identical.
+*/
+
+#include <chrono>
+#include <cstdlib>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef,face::FFAdj, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc,char ** argv)
+{
+  int ringDiv = 1000;
+  if(argc>1) ringDiv = atoi(argv[1]);
+
+  MyMesh m;
+  tri::Torus(m,2.0f,1.0f,ringDiv,ringDiv);
+
+  // add a few faces sharing edges with existing ones to get some non manifold fans
+  const size_t baseFaceNum = m.face.size();
+  for(size_t i=0;i<baseFaceNum;i+=7)
+    tri::Allocator<MyMesh>::AddFace(m,m.face[i].V(0),m.face[i].V(2),m.face[i].V(1));
+  printf("Mesh has %i vert and %i faces\n",m.VN(),m.FN());
+
+  std::vector<MyFace *> ffp(m.face.size()*3);
+  std::vector<int> ffi(m.face.size()*3);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  tri::UpdateTopology<MyMesh>::FaceFace(m);
+  printf("FaceFace         %6.3f sec\n",Elapsed(start));
+
+  for(size_t i=0;i<m.face.size();++i)
+    for(int j=0;j<3;++j)
+    {
+      ffp[i*3+j]=m.face[i].FFp(j);
+      ffi[i*3+j]=m.face[i].FFi(j);
+    }
+  tri::UpdateTopology<MyMesh>::ClearFaceFace(m);
+
+  start = std::chrono::steady_clock::now();
+  tri::UpdateTopology<MyMesh>::FaceFaceParallel(m);
+  printf("FaceFaceParallel %6.3f sec\n",Elapsed(start));
+
+  int diffCnt=0;
+  for(size_t i=0;i<m.face.size();++i)
+    for(int j=0;j<3;++j)
+      if(ffp[i*3+j]!=m.face[i].FFp(j) || ffi[i*3+j]!=m.face[i].FFi(j))
+        ++diffCnt;
+
+  printf("%i different FF entries\n",diffCnt);
+  return diffCnt==0 ? 0 : -1;
+}
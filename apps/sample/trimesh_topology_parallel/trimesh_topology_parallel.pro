@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_topology_parallel
+SOURCES += trimesh_topology_parallel.cpp
@@ -0,0 +1,108 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+/*! \file trimesh_vf_csr.cpp
+\ingroup code_sample
+
+\brief Comparison of the CSR vertex-face adjacency with the VF linked lists.
+
+A torus is generated and some of its faces are deleted, then the vertex-face adjacency is built
+both with UpdateTopology::VertexFace and with tri::VFAdjacencyCSR. The build and the one-ring walk
+used to compute the star barycenter of every vertex are timed, and the two adjacencies are checked
+to list the same (face, index) pairs for every vertex.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include<vcg/complex/complex.h>
+#include<vcg/complex/algorithms/create/platonic.h>
+#include<vcg/complex/algorithms/vf_adjacency_csr.h>
+
+using namespace vcg;
+
+class MyFace;
+class MyVertex;
+struct MyUsedTypes : public UsedTypes<	Use<MyVertex>::AsVertexType, Use<MyFace>::AsFaceType>{};
+
+class MyVertex  : public Vertex< MyUsedTypes, vertex::Coord3f, vertex::VFAdj, vertex::BitFlags  >{};
+class MyFace    : public Face  < MyUsedTypes, face::VertexRef, face::VFAdj, face::BitFlags > {};
+class MyMesh : public tri::TriMesh< std::vector<MyVertex>, std::vector<MyFace > >{};
+
+typedef tri::VFAdjacencyCSR<MyMesh> VFCSR;
+
+static double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc,char ** argv)
+{
+  int ringDiv = 1000;
+  if(argc>1) ringDiv = atoi(argv[1]);
+
+  MyMesh m;
+  tri::Torus(m,2.0f,1.0f,ringDiv,ringDiv);
+  for(size_t i=0;i<m.face.size();i+=11)
+    tri::Allocator<MyMesh>::DeleteFace(m,m.face[i]);
+  printf("Mesh has %i vert and %i faces\n",m.VN(),m.FN());
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  tri::UpdateTopology<MyMesh>::VertexFace(m);
+  printf("VertexFace     %6.3f sec\n",Elapsed(start));
+
+  start = std::chrono::steady_clock::now();
+  VFCSR vfa(m);
+  printf("VFAdjacencyCSR %6.3f sec\n",Elapsed(start));
+
+  std::vector<Point3f> star0(m.vert.size(),Point3f(0,0,0)), star1(m.vert.size(),Point3f(0,0,0));
+  start = std::chrono::steady_clock::now();
+  for(size_t i=0;i<m.vert.size();++i)
+    for(face::VFIterator<MyFace> vfi(&m.vert[i]);!vfi.End();++vfi)
+      star0[i]+=vfi.V1()->P();
+  printf("VF  one-ring walk %6.3f sec\n",Elapsed(start));
+
+  start = std::chrono::steady_clock::now();
+  for(size_t i=0;i<m.vert.size();++i)
+    for(VFCSR::Iterator vfi=vfa.Begin(i);!vfi.End();++vfi)
+      star1[i]+=vfi.V1()->P();
+  printf("CSR one-ring walk %6.3f sec\n",Elapsed(start));
+
+  int diffCnt=0;
+  for(size_t i=0;i<m.vert.size();++i)
+  {
+    std::vector< std::pair<MyFace *,int> > ring0, ring1;
+    for(face::VFIterator<MyFace> vfi(&m.vert[i]);!vfi.End();++vfi)
+      ring0.push_back(std::make_pair(vfi.F(),vfi.I()));
+    for(VFCSR::Iterator vfi=vfa.Begin(i);!vfi.End();++vfi)
+      ring1.push_back(std::make_pair(vfi.F(),vfi.I()));
+    // the CSR rings are sorted by face, the linked lists are not
+    std::sort(ring0.begin(),ring0.end());
+    if(ring0!=ring1 || vfa.Degree(i)!=int(ring1.size()))
+      ++diffCnt;
+  }
+  if(!vfa.IsUpToDate(m)) ++diffCnt;
+
+  printf("%i vertices with different rings\n",diffCnt);
+  return diffCnt==0 ? 0 : -1;
+}
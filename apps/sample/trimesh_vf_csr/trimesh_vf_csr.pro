@@ -0,0 +1,3 @@
+include(../common.pri)
+TARGET = trimesh_vf_csr
+SOURCES += trimesh_vf_csr.cpp
@@ -8,6 +8,11 @@
 // local optimization
 #include <vcg/complex/algorithms/local_optimization.h>
 #include <vcg/complex/algorithms/local_optimization/tri_edge_collapse_quadric.h>
+#include <vcg/complex/algorithms/stream_decimation.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace vcg;
 using namespace tri;
@@ -96,6 +101,10 @@ void Usage()
           "     -T[y|n]  Preserve or not Topology (default no)\n"
           "     -W[y|n]  Use or not per vertex Quality to weight the quadric error (default no)\n"
           "     -C       Before simplification, remove duplicate & unreferenced vertices\n"
+          "     -j#      Parallel decimation with # threads (0 use all the cores, default serial)\n"
+          "     -I       Use an indexed heap, with a single entry for each edge\n"
+          "     -M#      Out-of-core simplification of a PLY within # MB of memory\n"
+          "     -Rfile   Save also the progressive mesh (the vertex splits undoing the simplification) in file\n"
           );
   exit(-1);
 }
@@ -107,18 +116,14 @@ int main(int argc ,char**argv)
   MyMesh mesh;
   
   int FinalSize=atoi(argv[3]);
-  int err=vcg::tri::io::Importer<MyMesh>::Open(mesh,argv[1]);
-  if(err)
-  {
-    printf("Unable to open mesh %s : '%s'\n",argv[1],vcg::tri::io::Importer<MyMesh>::ErrorMsg(err));
-    exit(-1);
-  }
-  printf("mesh loaded %d %d \n",mesh.vn,mesh.fn);
-
   TriEdgeCollapseQuadricParameter qparams;
   qparams.QualityThr  =.3;
   double TargetError=std::numeric_limits<double >::max();
   bool CleaningFlag =false;
+  int ThreadNum = -1;
+  bool IndexedHeapFlag = false;
+  int MemoryBudgetMB = 0;
+  const char *ProgressiveFile = 0;
      // parse command line.
     for(int i=4; i < argc;)
     {
@@ -154,6 +159,10 @@ int main(int argc ,char**argv)
         case 'E' : qparams.QuadricEpsilon         = atof(argv[i]+2);       printf("Setting QuadricEpsilon to %f\n",atof(argv[i]+2)); break;
         case 'e' : TargetError                    = atof(argv[i]+2);       printf("Setting TargetError to %g\n",atof(argv[i]+2)); break;
         case 'C' : CleaningFlag=true;  printf("Cleaning mesh before simplification\n"); break;
+        case 'j' : ThreadNum              = atoi(argv[i]+2);       printf("Parallel decimation with %i threads\n",atoi(argv[i]+2)); break;
+        case 'I' : IndexedHeapFlag=true;  printf("Using indexed heap\n"); break;
+        case 'M' : MemoryBudgetMB         = atoi(argv[i]+2);       printf("Out-of-core simplification within %i MB\n",atoi(argv[i]+2)); break;
+        case 'R' : ProgressiveFile        = argv[i]+2;             printf("Saving the progressive mesh in %s\n",argv[i]+2); break;
 
         default  :  printf("Unknown option '%s'\n", argv[i]);
           exit(0);
@@ -161,6 +170,30 @@ int main(int argc ,char**argv)
       i++;
     }
 
+  if(MemoryBudgetMB>0)
+  {
+    if(CleaningFlag || ThreadNum>=0 || IndexedHeapFlag || ProgressiveFile)
+      printf("Out-of-core simplification: ignoring%s%s%s%s\n",CleaningFlag?" -C":"",ThreadNum>=0?" -j":"",
+             IndexedHeapFlag?" -I":"",ProgressiveFile?" -R":"");
+    vcg::tri::StreamDecimation<MyMesh,MyTriEdgeCollapse> sd;
+    sd.p.MemoryBudget = size_t(MemoryBudgetMB)<<20;
+    sd.p.TargetFaceNum = FinalSize;
+    sd.p.TargetError = TargetError;
+    sd.p.QParam = qparams;
+    int t0=clock();
+    if(!sd.Process(argv[1],argv[2])) exit(-1);
+    printf("\nCompleted in %5.3f sec\n",float(clock()-t0)/CLOCKS_PER_SEC);
+    return 0;
+  }
+
+  int err=vcg::tri::io::Importer<MyMesh>::Open(mesh,argv[1]);
+  if(err)
+  {
+    printf("Unable to open mesh %s : '%s'\n",argv[1],vcg::tri::io::Importer<MyMesh>::ErrorMsg(err));
+    exit(-1);
+  }
+  printf("mesh loaded %d %d \n",mesh.vn,mesh.fn);
+
   if(CleaningFlag){
       int dup = tri::Clean<MyMesh>::RemoveDuplicateVertex(mesh);
       int unref =  tri::Clean<MyMesh>::RemoveUnreferencedVertex(mesh);
@@ -174,6 +207,13 @@ int main(int argc ,char**argv)
 
   // decimator initialization
   vcg::LocalOptimization<MyMesh> DeciSession(mesh,&qparams);
+  DeciSession.UseIndexedHeap = IndexedHeapFlag;
+  tri::ProgressiveMesh<MyMesh> pm;
+  if(ProgressiveFile)
+  {
+    pm.Start(mesh);
+    DeciSession.Recorder = &pm;
+  }
 
   int t1=clock();
   DeciSession.Init<MyTriEdgeCollapse>();
@@ -185,13 +225,31 @@ int main(int argc ,char**argv)
   DeciSession.SetTargetOperations(100000);
   if(TargetError< std::numeric_limits<float>::max() ) DeciSession.SetTargetMetric(TargetError);
 
-  while(DeciSession.DoOptimization() && mesh.fn>FinalSize && DeciSession.currMetric < TargetError)
-    printf("Current Mesh size %7i heap sz %9i err %9g \n",mesh.fn, int(DeciSession.h.size()),DeciSession.currMetric);
+#ifdef _OPENMP
+  if(ThreadNum>0) omp_set_num_threads(ThreadNum);
+#else
+  if(ThreadNum>=0) printf("Compiled without OpenMP: parallel decimation runs on a single thread\n");
+#endif
+  if(ThreadNum>=0)
+  {
+    while(DeciSession.DoOptimizationParallel() && mesh.fn>FinalSize && DeciSession.currMetric < TargetError)
+      printf("Current Mesh size %7i heap sz %9i err %9g \n",mesh.fn, int(DeciSession.h.size()),DeciSession.currMetric);
+  }
+  else
+  {
+    while(DeciSession.DoOptimization() && mesh.fn>FinalSize && DeciSession.currMetric < TargetError)
+      printf("Current Mesh size %7i heap sz %9i err %9g \n",mesh.fn, int(DeciSession.h.size()),DeciSession.currMetric);
+  }
 
   int t3=clock();
   printf("mesh  %d %d Error %g \n",mesh.vn,mesh.fn,DeciSession.currMetric);
   printf("\nCompleted in (%5.3f+%5.3f) sec\n",float(t2-t1)/CLOCKS_PER_SEC,float(t3-t2)/CLOCKS_PER_SEC);
   vcg::tri::io::ExporterPLY<MyMesh>::Save(mesh,argv[2]);
+  if(ProgressiveFile)
+  {
+    if(pm.Save(ProgressiveFile)) printf("Saved %i vertex splits in %s\n",pm.SplitNum(),ProgressiveFile);
+    else printf("Unable to save the progressive mesh %s\n",ProgressiveFile);
+  }
     return 0;
 
 }
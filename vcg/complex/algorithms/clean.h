@@ -34,6 +34,7 @@
 #include <vcg/complex/algorithms/update/normal.h>
 #include <vcg/space/triangle3.h>
 #include <vcg/complex/append.h>
+#include <vcg/math/disjoint_set.h>
 
 namespace vcg {
 namespace tri{
@@ -189,6 +190,96 @@ public:
 
 	typedef GridStaticPtr<FaceType, ScalarType > TriMeshGrid;
 
+	/* how two faces are connected when labelling the components */
+	enum ComponentLinkType { FFLink, ManifoldFFLink, VertexLink };
+
+	/* union-find labelling of the face components, see ConnectedComponentsLabel */
+	static int LabelFaceComponents(MeshType &m, std::vector<int> &label, ComponentLinkType linkType)
+	{
+		const int faceNum = int(m.face.size());
+		const int vertNum = int(m.vert.size());
+		label.assign(faceNum,-1);
+		if(m.fn==0) return 0;
+
+		// faces are the nodes [0,faceNum), with VertexLink vertices are the nodes [faceNum,faceNum+vertNum)
+		ConcurrentDisjointSet ds(linkType==VertexLink ? faceNum+vertNum : faceNum);
+		const FacePointer fBase = &m.face[0];
+#pragma omp parallel for schedule(dynamic, 4096)
+		for(int i=0;i<faceNum;++i)
+		{
+			FaceType &f = m.face[i];
+			if(f.IsD()) continue;
+			for(int j=0;j<f.VN();++j)
+			{
+				if(linkType==VertexLink)
+					ds.Union(i,faceNum+int(tri::Index(m,f.V(j))));
+				else if(!face::IsBorder(f,j) && (linkType==FFLink || face::IsManifold(f,j)))
+				{
+					// every FF relation is followed: in a non-manifold fan FFp is a one-directional cycle in any order
+					const int k = int(f.FFp(j)-fBase);
+					if(k!=i && !m.face[k].IsD())
+						ds.Union(i,k);
+				}
+			}
+		}
+
+		// the representative of each set is its smallest element, so roots are met in order of first face
+		std::vector<int> root(faceNum);
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			root[i] = m.face[i].IsD() ? -1 : ds.FindSet(i);
+		int ccNum=0;
+		for(int i=0;i<faceNum;++i)
+			if(root[i]==i) label[i]=ccNum++;
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			if(root[i]>=0 && root[i]!=i) label[i]=label[root[i]];
+		return ccNum;
+	}
+
+	/* faces of each component: the faces of component c, in index order, are ccFace[ccOff[c]..ccOff[c+1]) */
+	static void ComponentFaceLists(const std::vector<int> &label, int ccNum, std::vector<int> &ccOff, std::vector<int> &ccFace)
+	{
+		ccOff.assign(ccNum+1,0);
+		for(size_t i=0;i<label.size();++i)
+			if(label[i]>=0) ++ccOff[label[i]+1];
+		for(int c=0;c<ccNum;++c)
+			ccOff[c+1]+=ccOff[c];
+		ccFace.resize(ccOff[ccNum]);
+		std::vector<int> pos(ccOff.begin(),ccOff.end()-1);
+		for(size_t i=0;i<label.size();++i)
+			if(label[i]>=0) ccFace[pos[label[i]]++]=int(i);
+	}
+
+	/* delete all the faces of the components flagged in toDelete */
+	static int DeleteComponents(MeshType &m, const std::vector<int> &label, const std::vector<char> &toDelete)
+	{
+		int deleted=0;
+		for(size_t i=0;i<m.face.size();++i)
+			if(label[i]>=0 && toDelete[label[i]])
+			{
+				tri::Allocator<MeshType>::DeleteFace(m,m.face[i]);
+				++deleted;
+			}
+		return deleted;
+	}
+
+	/* bounding box diagonal of each component */
+	static void ComponentDiagonals(MeshType &m, const std::vector<int> &ccOff, const std::vector<int> &ccFace, std::vector<ScalarType> &diag)
+	{
+		const int ccNum = int(ccOff.size())-1;
+		diag.resize(ccNum);
+#pragma omp parallel for schedule(dynamic, 256)
+		for(int c=0;c<ccNum;++c)
+		{
+			Box3<ScalarType> bb;
+			for(int k=ccOff[c];k<ccOff[c+1];++k)
+				for(int j=0;j<m.face[ccFace[k]].VN();++j)
+					bb.Add(m.face[ccFace[k]].cP(j));
+			diag[c]=bb.Diag();
+		}
+	}
+
 	/* classe di confronto per l'algoritmo di eliminazione vertici duplicati*/
 	class RemoveDuplicateVert_Compare{
 	public:
@@ -199,73 +290,164 @@ public:
 	};
 
 
+	/* hash of a position; positions that compare equal (including -0 and +0) get the same hash */
+	static size_t PositionHash(const CoordType &p)
+	{
+		size_t h = 0;
+		for(int i=0;i<3;++i)
+		{
+			ScalarType c = p[i];
+			if(c == ScalarType(0)) c = ScalarType(0);
+			size_t bits = 0;
+			memcpy(&bits,&c,std::min(sizeof(c),sizeof(bits)));
+			h = (h ^ bits) * size_t(0x9E3779B97F4A7C15ull);
+			h ^= h >> 29;
+		}
+		return h;
+	}
+
+	/* a vertex as seen by RemoveDuplicateVertex: position, hash of the position, index and deleted flag
+	   are copied so that sorting and scanning the buckets does not touch the vertex vector */
+	struct WeldEntry
+	{
+		size_t key;
+		CoordType p;
+		int i;
+		bool d;
+		bool operator < (const WeldEntry &e) const { return (key!=e.key) ? (key<e.key) : (i<e.i); }
+	};
+
 	/** This function removes all duplicate vertices of the mesh by looking only at their spatial positions.
 	*  Note that it does not update any topology relation that could be affected by this like the VT or TT relation.
 	*  the reason this function is usually performed BEFORE building any topology information.
+	*
+	*  Vertices are distributed in buckets by a hash of their position and each bucket is sorted independently
+	*  (in parallel when OpenMP is available); the duplicates are resolved with a flat remap array.
+	*  Among the vertices sharing a position the one with the lowest index is kept.
 	*/
 	static int RemoveDuplicateVertex( MeshType & m, bool RemoveDegenerateFlag=true)    // V1.0
 	{
 		if(m.vert.size()==0 || m.vn==0) return 0;
 
-		std::map<VertexPointer, VertexPointer> mp;
-		size_t i,j;
-		VertexIterator vi;
-		int deleted=0;
-		int k=0;
-		size_t num_vert = m.vert.size();
-		std::vector<VertexPointer> perm(num_vert);
-		for(vi=m.vert.begin(); vi!=m.vert.end(); ++vi, ++k)
-			perm[k] = &(*vi);
-
-		RemoveDuplicateVert_Compare c_obj;
+		const int vertNum = int(m.vert.size());
+		const int bucketNum = int(std::max<size_t>(1, std::min<size_t>(65536, vertNum/1024)));
+		const int chunkNum  = int(std::max<size_t>(1, std::min<size_t>(64, vertNum/65536)));
+		const int chunkSize = (vertNum + chunkNum - 1) / chunkNum;
 
-		std::sort(perm.begin(),perm.end(),c_obj);
+		std::vector<int> bucket(vertNum);
+		std::vector<int> remap(vertNum);
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+		{
+			bucket[i] = int(PositionHash(m.vert[i].cP()) % size_t(bucketNum));
+			remap[i] = i;
+		}
 
-		j = 0;
-		i = j;
-		mp[perm[i]] = perm[j];
-		++i;
-		for(;i!=num_vert;)
+		// stable counting sort of the vertexes by bucket, done by chunks;
+		// cnt[c*bucketNum+b] becomes the scatter position of chunk c in bucket b
+		std::vector<size_t> cnt(size_t(chunkNum)*bucketNum,0);
+#pragma omp parallel for schedule(static)
+		for(int c=0;c<chunkNum;++c)
+		{
+			const int iEnd = std::min(vertNum, (c+1)*chunkSize);
+			for(int i=c*chunkSize;i<iEnd;++i)
+				++cnt[size_t(c)*bucketNum+bucket[i]];
+		}
+		std::vector<size_t> bucketOff(bucketNum+1,0);
+		size_t sum=0;
+		for(int b=0;b<bucketNum;++b)
 		{
-			if( (! (*perm[i]).IsD()) &&
-			    (! (*perm[j]).IsD()) &&
-			    (*perm[i]).P() == (*perm[j]).cP() )
+			bucketOff[b]=sum;
+			for(int c=0;c<chunkNum;++c)
 			{
-				VertexPointer t = perm[i];
-				mp[perm[i]] = perm[j];
-				++i;
-				Allocator<MeshType>::DeleteVertex(m,*t);
-				deleted++;
+				const size_t t = cnt[size_t(c)*bucketNum+b];
+				cnt[size_t(c)*bucketNum+b] = sum;
+				sum += t;
 			}
-			else
+		}
+		bucketOff[bucketNum]=sum;
+
+		std::vector<WeldEntry> we(vertNum);
+#pragma omp parallel for schedule(static)
+		for(int c=0;c<chunkNum;++c)
+		{
+			const int iEnd = std::min(vertNum, (c+1)*chunkSize);
+			for(int i=c*chunkSize;i<iEnd;++i)
 			{
-				j = i;
-				++i;
+				WeldEntry &e = we[cnt[size_t(c)*bucketNum+bucket[i]]++];
+				e.p = m.vert[i].cP();
+				e.key = PositionHash(e.p);
+				e.i = i;
+				e.d = m.vert[i].IsD();
 			}
 		}
 
-		for(FaceIterator fi = m.face.begin(); fi!=m.face.end(); ++fi)
-			if( !(*fi).IsD() )
-				for(k = 0; k < (*fi).VN(); ++k)
-					if( mp.find( (typename MeshType::VertexPointer)(*fi).V(k) ) != mp.end() )
+		// inside each bucket sort by hash and index; a run of equal hashes is reordered by position
+		// (only on hash collisions) so that coincident vertices are contiguous and in index order.
+		// As in the plain sorted scan, a deleted vertex in the middle of a run of coincident
+		// vertices starts a new run.
+		int deleted=0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : deleted)
+		for(int b=0;b<bucketNum;++b)
+		{
+			typedef typename std::vector<WeldEntry>::iterator WeldIterator;
+			const WeldIterator be = we.begin()+bucketOff[b+1];
+			std::sort(we.begin()+bucketOff[b],be);
+			WeldIterator rb = we.begin()+bucketOff[b];
+			while(rb!=be)
+			{
+				WeldIterator re = rb+1;
+				bool samePos = true;
+				for(;re!=be && re->key==rb->key;++re)
+					samePos = samePos && (re->p == rb->p);
+				if(!samePos)
+					std::stable_sort(rb,re,[](const WeldEntry &e0, const WeldEntry &e1){ return e0.p < e1.p; });
+
+				WeldIterator j = rb;
+				for(WeldIterator pi=rb+1;pi!=re;++pi)
+				{
+					if( !pi->d && !j->d && pi->p == j->p )
 					{
-						(*fi).V(k) = &*mp[ (*fi).V(k) ];
+						remap[pi->i] = j->i;
+						++deleted;
 					}
+					else j = pi;
+				}
+				rb = re;
+			}
+		}
 
+		for(int i=0;i<vertNum;++i)
+			if(remap[i]!=i)
+				tri::Allocator<MeshType>::DeleteVertex(m,m.vert[i]);
 
-		for(EdgeIterator ei = m.edge.begin(); ei!=m.edge.end(); ++ei)
-			if( !(*ei).IsD() )
-				for(k = 0; k < 2; ++k)
-					if( mp.find( (typename MeshType::VertexPointer)(*ei).V(k) ) != mp.end() )
-					{
-						(*ei).V(k) = &*mp[ (*ei).V(k) ];
-					}
-
-		for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-			if (!(*ti).IsD())
-				for (k = 0; k < 4; ++k)
-					if (mp.find((typename MeshType::VertexPointer)(*ti).V(k)) != mp.end())
-						(*ti).V(k) = &*mp[ (*ti).V(k) ];
+		if(deleted>0)
+		{
+			VertexPointer vBase = &m.vert[0];
+			const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+			for(int i=0;i<faceNum;++i)
+				if( !m.face[i].IsD() )
+					for(int k = 0; k < m.face[i].VN(); ++k)
+						if( m.face[i].V(k)!=0 )
+							m.face[i].V(k) = vBase + remap[m.face[i].V(k) - vBase];
+
+			const int edgeNum = int(m.edge.size());
+#pragma omp parallel for schedule(static)
+			for(int i=0;i<edgeNum;++i)
+				if( !m.edge[i].IsD() )
+					for(int k = 0; k < 2; ++k)
+						if( m.edge[i].V(k)!=0 )
+							m.edge[i].V(k) = vBase + remap[m.edge[i].V(k) - vBase];
+
+			const int tetraNum = int(m.tetra.size());
+#pragma omp parallel for schedule(static)
+			for(int i=0;i<tetraNum;++i)
+				if( !m.tetra[i].IsD() )
+					for(int k = 0; k < 4; ++k)
+						if( m.tetra[i].V(k)!=0 )
+							m.tetra[i].V(k) = vBase + remap[m.tetra[i].V(k) - vBase];
+		}
 
 		if(RemoveDegenerateFlag) RemoveDegenerateFace(m);
 		if(RemoveDegenerateFlag && m.en>0) {
@@ -674,85 +856,92 @@ public:
 		return int(ToSplitVec.size());
 	}
 
-	/// \brief This function expand current selection to cover the whole connected component.
+	/// \brief Split the mesh into its manifold connected components, so that they do not share any vertex.
+	/// Faces are in the same component if they are connected through manifold edges (as labelled by the
+	/// union-find of ConnectedComponentsLabel); vertices used by more than one component are duplicated.
+	/// The border vertices of the result are moved toward the barycenter of their faces by moveThreshold.
+	/// The mesh is left compact, without unreferenced vertices and with an empty selection; topology must be recomputed.
+	/// \returns the number of components
 	static size_t SplitManifoldComponents(MeshType &m, const ScalarType moveThreshold = 0)
 	{
-		typedef typename MeshType::FacePointer FacePointer;
-		typedef typename MeshType::FaceIterator FaceIterator;
 		// it also assumes that the FF adjacency is well computed.
 		RequireFFAdjacency(m);
 
-		UpdateFlags<MeshType>::FaceClearV(m);
-		UpdateFlags<MeshType>::FaceClearS(m);
-
-		MeshType tmpMesh;
-		tmpMesh.vert.EnableVFAdjacency();
-		tmpMesh.face.EnableVFAdjacency();
-
-		if (m.face.IsWedgeTexCoordEnabled())
-			tmpMesh.face.EnableWedgeTexCoord();
-
-		size_t selCnt=0;
-
-		for(FaceIterator fi = m.face.begin(); fi != m.face.end(); ++fi)
-			if( !(*fi).IsD() && !(*fi).IsV() && !(*fi).IsS())
-			{
-				UpdateFlags<MeshType>::FaceClearS(m);
-
-				std::deque<FacePointer> visitStack;
-				visitStack.push_back(&*fi);
-
-				(*fi).SetS();
-				(*fi).SetV();
-
-				while(!visitStack.empty())
+		std::vector<int> label;
+		const int ccNum = LabelFaceComponents(m,label,ManifoldFFLink);
+		const int faceNum = int(m.face.size());
+		const int vertNum = int(m.vert.size());
+
+		// each vertex is kept by the lowest component using it
+		std::vector< std::atomic<int> > owner(vertNum);
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+			owner[i].store(std::numeric_limits<int>::max(),std::memory_order_relaxed);
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			if(label[i]>=0)
+				for(int j=0;j<m.face[i].VN();++j)
 				{
-					FacePointer fp = visitStack.front();
-					visitStack.pop_front();
+					std::atomic<int> &o = owner[tri::Index(m,m.face[i].V(j))];
+					int cur = o.load(std::memory_order_relaxed);
+					while(label[i]<cur && !o.compare_exchange_weak(cur,label[i],std::memory_order_relaxed)) {}
+				}
 
-					for(int i=0;i<fp->VN();++i) {
-						FacePointer ff = fp->FFp(i);
+		// every other (vertex, component) pair gets its own copy of the vertex
+		std::vector< std::pair<int,int> > splitVec;
+		for(int i=0;i<faceNum;++i)
+			if(label[i]>=0)
+				for(int j=0;j<m.face[i].VN();++j)
+				{
+					const int vi = int(tri::Index(m,m.face[i].V(j)));
+					if(owner[vi].load(std::memory_order_relaxed)!=label[i])
+						splitVec.push_back(std::make_pair(vi,label[i]));
+				}
+		std::sort(splitVec.begin(),splitVec.end());
+		splitVec.erase(std::unique(splitVec.begin(),splitVec.end()),splitVec.end());
 
-						if(face::IsManifold(*fp, i) && !ff->IsS() && !ff->IsV())
+		if(!splitVec.empty())
+		{
+			tri::Allocator<MeshType>::AddVertices(m,splitVec.size());
+			for(size_t k=0;k<splitVec.size();++k)
+				m.vert[vertNum+k].ImportData(m.vert[splitVec[k].first]);
+#pragma omp parallel for schedule(static)
+			for(int i=0;i<faceNum;++i)
+				if(label[i]>=0)
+					for(int j=0;j<m.face[i].VN();++j)
+					{
+						const int vi = int(tri::Index(m,m.face[i].V(j)));
+						if(vi<vertNum && owner[vi].load(std::memory_order_relaxed)!=label[i])
 						{
-							ff->SetS();
-							ff->SetV();
-							visitStack.push_back(ff);
+							const size_t k = std::lower_bound(splitVec.begin(),splitVec.end(),std::make_pair(vi,label[i]))-splitVec.begin();
+							m.face[i].V(j) = &m.vert[vertNum+k];
 						}
 					}
-				}
-
-				Append<MeshType, MeshType>::Mesh(tmpMesh, m, true);
-				++selCnt;
-			}
+		}
 
-		vcg::tri::UpdateTopology<MeshType>::VertexFace(tmpMesh);
-		vcg::tri::UpdateFlags<MeshType>::VertexBorderFromNone(tmpMesh);
-		for (size_t i = 0; i < size_t(tmpMesh.VN()); ++i)
+		if(moveThreshold!=0)
 		{
-			VertexType & v = tmpMesh.vert[i];
-
-			if (v.IsB())
-			{
-				std::vector<FacePointer> faceVec;
-				std::vector<int> idxVec;
-
-				vcg::face::VFStarVF(&v, faceVec, idxVec);
-
-				CoordType delta(0, 0, 0);
-				for (auto fp : faceVec)
-				{
-					delta += vcg::Barycenter(*fp) - v.cP();
-				}
-				delta /= faceVec.size();
-
-				v.P() += delta * moveThreshold;
-			}
+			UpdateFlags<MeshType>::VertexBorderFromNone(m);
+			std::vector<CoordType> delta(m.vert.size(),CoordType(0,0,0));
+			std::vector<int> cnt(m.vert.size(),0);
+			for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+				if(!(*fi).IsD())
+					for(int j=0;j<(*fi).VN();++j)
+						if((*fi).V(j)->IsB())
+						{
+							const size_t vi = tri::Index(m,(*fi).V(j));
+							delta[vi] += Barycenter(*fi)-(*fi).V(j)->cP();
+							++cnt[vi];
+						}
+			for(size_t i=0;i<m.vert.size();++i)
+				if(cnt[i]>0)
+					m.vert[i].P() += delta[i]/ScalarType(cnt[i]) * moveThreshold;
 		}
 
-		UpdateSelection<MeshType>::Clear(tmpMesh);
-		Append<MeshType, MeshType>::MeshCopy(m, tmpMesh);
-		return selCnt;
+		UpdateSelection<MeshType>::Clear(m);
+		RemoveUnreferencedVertex(m);
+		Allocator<MeshType>::CompactEveryVector(m);
+		return size_t(ccNum);
 	}
 
 
@@ -1240,37 +1429,42 @@ public:
 	{
 		tri::RequireFFAdjacency(m);
 		CCV.clear();
-		tri::UpdateFlags<MeshType>::FaceClearV(m);
-		std::stack<FacePointer> sf;
-		FacePointer fpt=&*(m.face.begin());
-		for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-		{
-			if(!((*fi).IsD()) && !(*fi).IsV())
-			{
-				(*fi).SetV();
-				CCV.push_back(std::make_pair(0,&*fi));
-				sf.push(&*fi);
-				while (!sf.empty())
-				{
-					fpt=sf.top();
-					++CCV.back().first;
-					sf.pop();
-					for(int j=0; j<fpt->VN(); ++j)
-					{
-						if( !face::IsBorder(*fpt,j) )
-						{
-							FacePointer l = fpt->FFp(j);
-							if( !(*l).IsV() )
-							{
-								(*l).SetV();
-								sf.push(l);
-							}
-						}
-					}
-				}
-			}
-		}
-		return int(CCV.size());
+		std::vector<int> label, ccOff, ccFace;
+		const int ccNum = ConnectedComponentsLabel(m,label);
+		ComponentFaceLists(label,ccNum,ccOff,ccFace);
+		CCV.resize(ccNum);
+		for(int c=0;c<ccNum;++c)
+			CCV[c] = std::make_pair(ccOff[c+1]-ccOff[c],&m.face[ccFace[ccOff[c]]]);
+		return ccNum;
+	}
+
+	/** Label the connected components of the mesh with a parallel lock free union-find (vcg::ConcurrentDisjointSet).
+	 *  Two faces belong to the same component if they are FF adjacent or, when byVertex is true,
+	 *  if they share a vertex (in that case the FF adjacency is not needed).
+	 *  label[i] is the component of the i-th face, -1 for deleted faces. Components are numbered in the
+	 *  order of their first face, so they come in the same order as in ConnectedComponents().
+	 *  \returns the number of connected components
+	 */
+	static int ConnectedComponentsLabel(MeshType &m, std::vector<int> &label, bool byVertex=false)
+	{
+		if(!byVertex) tri::RequireFFAdjacency(m);
+		return LabelFaceComponents(m,label,byVertex ? VertexLink : FFLink);
+	}
+
+	/** As above, but the component index of each face is written in the per-face int attribute
+	 *  with the given name (it is added if it does not exist).
+	 */
+	static int ConnectedComponentsLabel(MeshType &m, const std::string &attrName, bool byVertex=false)
+	{
+		std::vector<int> label;
+		const int ccNum = ConnectedComponentsLabel(m,label,byVertex);
+		typename MeshType::template PerFaceAttributeHandle<int> ccId =
+				tri::Allocator<MeshType>::template GetPerFaceAttribute<int>(m,attrName);
+		const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			ccId[i] = label[i];
+		return ccNum;
 	}
 
 	static int edgeMeshConnectedComponents(MeshType & poly,  std::vector<std::pair<int, typename MeshType::EdgePointer> > &eCC)
@@ -1915,25 +2109,20 @@ public:
 
 	static std::pair<int,int>  RemoveSmallConnectedComponentsSize(MeshType &m, int maxCCSize)
 	{
-		std::vector< std::pair<int, typename MeshType::FacePointer> > CCV;
-		int TotalCC=ConnectedComponents(m, CCV);
-		int DeletedCC=0;
+		tri::RequireFFAdjacency(m);
+		std::vector<int> label, ccOff, ccFace;
+		const int TotalCC=ConnectedComponentsLabel(m,label);
+		ComponentFaceLists(label,TotalCC,ccOff,ccFace);
 
-		ConnectedComponentIterator<MeshType> ci;
-		for(unsigned int i=0;i<CCV.size();++i)
-		{
-			std::vector<typename MeshType::FacePointer> FPV;
-			if(CCV[i].first<maxCCSize)
+		int DeletedCC=0;
+		std::vector<char> toDelete(TotalCC,0);
+		for(int c=0;c<TotalCC;++c)
+			if(ccOff[c+1]-ccOff[c]<maxCCSize)
 			{
+				toDelete[c]=1;
 				DeletedCC++;
-				for(ci.start(m,CCV[i].second);!ci.completed();++ci)
-					FPV.push_back(*ci);
-
-				typename std::vector<typename MeshType::FacePointer>::iterator fpvi;
-				for(fpvi=FPV.begin(); fpvi!=FPV.end(); ++fpvi)
-					Allocator<MeshType>::DeleteFace(m,(**fpvi));
 			}
-		}
+		DeleteComponents(m,label,toDelete);
 		return std::make_pair(TotalCC,DeletedCC);
 	}
 
@@ -1942,29 +2131,22 @@ public:
 	// it returns a pair with the number of connected components and the number of deleted ones.
 	static std::pair<int,int> RemoveSmallConnectedComponentsDiameter(MeshType &m, ScalarType maxDiameter)
 	{
-		std::vector< std::pair<int, typename MeshType::FacePointer> > CCV;
-		int TotalCC=ConnectedComponents(m, CCV);
+		tri::RequireFFAdjacency(m);
+		std::vector<int> label, ccOff, ccFace;
+		const int TotalCC=ConnectedComponentsLabel(m,label);
+		ComponentFaceLists(label,TotalCC,ccOff,ccFace);
+		std::vector<ScalarType> diag;
+		ComponentDiagonals(m,ccOff,ccFace,diag);
+
 		int DeletedCC=0;
-		tri::ConnectedComponentIterator<MeshType> ci;
-		for(unsigned int i=0;i<CCV.size();++i)
-		{
-			Box3<ScalarType> bb;
-			std::vector<typename MeshType::FacePointer> FPV;
-			for(ci.start(m,CCV[i].second);!ci.completed();++ci)
-			{
-				FPV.push_back(*ci);
-				bb.Add((*ci)->P(0));
-				bb.Add((*ci)->P(1));
-				bb.Add((*ci)->P(2));
-			}
-			if(bb.Diag()<maxDiameter)
+		std::vector<char> toDelete(TotalCC,0);
+		for(int c=0;c<TotalCC;++c)
+			if(diag[c]<maxDiameter)
 			{
+				toDelete[c]=1;
 				DeletedCC++;
-				typename std::vector<typename MeshType::FacePointer>::iterator fpvi;
-				for(fpvi=FPV.begin(); fpvi!=FPV.end(); ++fpvi)
-					tri::Allocator<MeshType>::DeleteFace(m,(**fpvi));
 			}
-		}
+		DeleteComponents(m,label,toDelete);
 		return std::make_pair(TotalCC,DeletedCC);
 	}
 
@@ -1972,29 +2154,22 @@ public:
 	// it returns a pair with the number of connected components and the number of deleted ones.
 	static std::pair<int,int> RemoveHugeConnectedComponentsDiameter(MeshType &m, ScalarType minDiameter)
 	{
-		std::vector< std::pair<int, typename MeshType::FacePointer> > CCV;
-		int TotalCC=ConnectedComponents(m, CCV);
+		tri::RequireFFAdjacency(m);
+		std::vector<int> label, ccOff, ccFace;
+		const int TotalCC=ConnectedComponentsLabel(m,label);
+		ComponentFaceLists(label,TotalCC,ccOff,ccFace);
+		std::vector<ScalarType> diag;
+		ComponentDiagonals(m,ccOff,ccFace,diag);
+
 		int DeletedCC=0;
-		tri::ConnectedComponentIterator<MeshType> ci;
-		for(unsigned int i=0;i<CCV.size();++i)
-		{
-			Box3f bb;
-			std::vector<typename MeshType::FacePointer> FPV;
-			for(ci.start(m,CCV[i].second);!ci.completed();++ci)
-			{
-				FPV.push_back(*ci);
-				bb.Add((*ci)->P(0));
-				bb.Add((*ci)->P(1));
-				bb.Add((*ci)->P(2));
-			}
-			if(bb.Diag()>minDiameter)
+		std::vector<char> toDelete(TotalCC,0);
+		for(int c=0;c<TotalCC;++c)
+			if(diag[c]>minDiameter)
 			{
+				toDelete[c]=1;
 				DeletedCC++;
-				typename std::vector<typename MeshType::FacePointer>::iterator fpvi;
-				for(fpvi=FPV.begin(); fpvi!=FPV.end(); ++fpvi)
-					tri::Allocator<MeshType>::DeleteFace(m,(**fpvi));
 			}
-		}
+		DeleteComponents(m,label,toDelete);
 		return std::make_pair(TotalCC,DeletedCC);
 	}
 
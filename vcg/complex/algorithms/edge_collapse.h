@@ -320,6 +320,7 @@ public:
       }
 
       Allocator<TriMeshType>::DeleteVertex(m,*(c.V(0)));
+      Allocator<TriMeshType>::MarkDirtyVertex(m,*(c.V(1)));
       c.V(1)->P()=p;
       return n_face_del;
   }
@@ -408,6 +408,213 @@ wrapping function.
     return farthest;
   }
 
+  /* Auxiliary class for the distance updates proposed by the relaxation of a frontier vertex */
+  struct DistUpdate{
+    DistUpdate(){}
+    DistUpdate(int _v, ScalarType _d, int _from):v(_v),d(_d),from(_from){}
+
+    int v;
+    ScalarType d;
+    int from;
+  };
+
+/*
+Bucket based (delta-stepping) label correcting visit, shared by ParallelVisit and PerVertexDeltaSteppingCompute.
+dist, source and parent are indexed by vertex index and must be already initialized for the seeds.
+The vertices whose distance falls in [k*delta,(k+1)*delta) are relaxed all together, in parallel, by
+relax(curr,updates), that only reads the current distances and appends the proposed improvements;
+the updates are then applied serially in frontier order (so the result does not depend on the number of threads)
+and the bucket is relaxed again until it is stable. Vertices not closer than threshold are not expanded.
+The visit stops after the bucket containing target (if any) has been settled.
+Returns the vertex indexes in the order they have been expanded for the first time.
+*/
+  template <class RelaxFunctor>
+  static void DeltaStepping(MeshType & m,
+                            const std::vector<int> &seedVec,
+                            ScalarType delta,
+                            ScalarType threshold,
+                            RelaxFunctor &relax,
+                            std::vector<ScalarType> &dist,
+                            std::vector<int> &source,
+                            std::vector<int> &parent,
+                            std::vector<int> &expandedVec,
+                            int target=-1)
+  {
+    assert(delta>0);
+    const int vn = int(m.vert.size());
+    std::vector<char> expanded(vn,0);
+    std::vector<ScalarType> expandedDist(vn);
+    std::vector<std::vector<int> > buckets;
+    std::vector<int> frontier;
+    std::vector<std::vector<DistUpdate> > updates;
+
+    for(size_t i=0;i<seedVec.size();++i)
+    {
+      const size_t b = size_t(dist[seedVec[i]]/delta);
+      if(b>=buckets.size()) buckets.resize(b+1);
+      buckets[b].push_back(seedVec[i]);
+    }
+
+    for(size_t k=0;k<buckets.size();++k)
+    {
+      while(!buckets[k].empty())
+      {
+        // collect the frontier skipping stale entries and vertices already expanded with their current distance
+        frontier.clear();
+        for(size_t i=0;i<buckets[k].size();++i)
+        {
+          const int vi = buckets[k][i];
+          if(size_t(dist[vi]/delta)>k || !(dist[vi]<threshold)) continue;
+          if(expanded[vi] && expandedDist[vi]==dist[vi]) continue;
+          if(!expanded[vi]) expandedVec.push_back(vi);
+          expanded[vi]=1;
+          expandedDist[vi]=dist[vi];
+          frontier.push_back(vi);
+        }
+        buckets[k].clear();
+
+        const int frontierNum = int(frontier.size());
+        if(int(updates.size())<frontierNum) updates.resize(frontierNum);
+#pragma omp parallel for schedule(dynamic,64)
+        for(int i=0;i<frontierNum;++i)
+        {
+          updates[i].clear();
+          relax(frontier[i],updates[i]);
+        }
+
+        for(int i=0;i<frontierNum;++i)
+          for(size_t j=0;j<updates[i].size();++j)
+          {
+            const DistUpdate &u = updates[i][j];
+            if(!(u.d < dist[u.v])) continue;
+            dist[u.v] = u.d;
+            source[u.v] = source[u.from];
+            parent[u.v] = u.from;
+            const size_t b = std::max(k,size_t(u.d/delta));
+            if(b>=buckets.size()) buckets.resize(b+1);
+            buckets[b].push_back(u.v);
+          }
+      }
+      if(target>=0 && size_t(dist[target]/delta)<=k) break;
+    }
+  }
+
+  /* The average length of the mesh edges according to the given distance functor; it is the default bucket width of the delta-stepping visits */
+  template <class DistanceFunctor>
+  static ScalarType AverageEdgeDistance(MeshType & m, DistanceFunctor &distFunc)
+  {
+    double sum=0;
+    size_t cnt=0;
+    for(size_t i=0;i<m.face.size();++i)
+      if(!m.face[i].IsD())
+        for(int j=0;j<m.face[i].VN();++j)
+        {
+          sum+=distFunc(m.face[i].V0(j),m.face[i].V1(j));
+          ++cnt;
+        }
+    if(cnt==0 || !(sum>0)) return 1;
+    return ScalarType(sum/cnt);
+  }
+
+/*
+Parallel version of Visit(). The frontier is processed by buckets of width delta (by default the average edge length):
+all the vertices of a bucket are relaxed in parallel with the same distance estimation of Visit().
+The approximated distances are of the same quality of the serial visit but, since the relaxation order differs,
+not bitwise identical to it. The result does not depend on the number of threads.
+*/
+  template <class DistanceFunctor>
+  static  VertexPointer ParallelVisit(
+      MeshType & m,
+      std::vector<VertDist> & seedVec,
+      DistanceFunctor &distFunc,
+      ScalarType distance_threshold  = std::numeric_limits<ScalarType>::max(),
+      typename MeshType::template PerVertexAttributeHandle<VertexPointer> * vertSource = NULL,
+      typename MeshType::template PerVertexAttributeHandle<VertexPointer> * vertParent = NULL,
+      std::vector<VertexPointer> *InInterval=NULL,
+      ScalarType delta = 0)
+  {
+    tri::RequireVFAdjacency(m);
+    tri::RequirePerVertexQuality(m);
+
+    assert(!seedVec.empty());
+    if(delta<=0) delta = AverageEdgeDistance(m,distFunc);
+
+    const int vn = int(m.vert.size());
+    std::vector<ScalarType> dist(vn,std::numeric_limits<ScalarType>::max());
+    std::vector<int> source(vn,-1), parent(vn,-1), seedInd, expandedVec;
+    for(size_t i=0;i<seedVec.size();++i)
+    {
+      const int si = int(tri::Index(m,seedVec[i].v));
+      dist[si] = seedVec[i].d;
+      source[si] = si;
+      parent[si] = si;
+      seedInd.push_back(si);
+    }
+
+    auto relax = [&](int ci, std::vector<DistUpdate> &upd)
+    {
+      VertexPointer curr = &m.vert[ci];
+      const ScalarType d_curr = dist[ci];
+      for(face::VFIterator<FaceType>  vfi(curr) ; vfi.f!=0; ++vfi )
+      {
+        for(int k=0;k<2;++k)
+        {
+          VertexPointer pw,pw1;
+          if(k==0) {
+            pw = vfi.f->V1(vfi.z);
+            pw1= vfi.f->V2(vfi.z);
+          }
+          else {
+            pw = vfi.f->V2(vfi.z);
+            pw1= vfi.f->V1(vfi.z);
+          }
+          const int pwi = int(tri::Index(m,pw));
+          const int pw1i = int(tri::Index(m,pw1));
+          const ScalarType & d_pw1 = dist[pw1i];
+          const ScalarType inter  = distFunc(curr,pw1);
+          const ScalarType tol = (inter + d_curr + d_pw1)*.0001f;
+          ScalarType curr_d;
+          if (	(source[pw1i] != source[ci])||// not the same source
+                  (inter + d_curr < d_pw1  +tol   ) ||
+                  (inter + d_pw1  < d_curr +tol  ) ||
+                  (d_curr + d_pw1  < inter +tol  )   // triangular inequality
+                  )
+            curr_d = d_curr + distFunc(pw,curr);
+          else
+            curr_d = Distance(distFunc,pw,pw1,curr,d_pw1,d_curr);
+
+          if(dist[pwi] > curr_d)
+            upd.push_back(DistUpdate(pwi,curr_d,ci));
+        }
+      }
+    };
+    DeltaStepping(m,seedInd,delta,distance_threshold,relax,dist,source,parent,expandedVec);
+
+    VertexPointer farthest=0;
+    ScalarType max_distance=0;
+    for(size_t i=0;i<expandedVec.size();++i)
+    {
+      const int vi = expandedVec[i];
+      if(InInterval!=NULL) InInterval->push_back(&m.vert[vi]);
+      if(vertSource!=NULL) (*vertSource)[vi] = &m.vert[source[vi]];
+      if(vertParent!=NULL) (*vertParent)[vi] = &m.vert[parent[vi]];
+      if(dist[vi] > max_distance) { max_distance = dist[vi]; farthest = &m.vert[vi]; }
+    }
+
+    // Copy found distance onto the Quality
+    if (InInterval==NULL)
+    {
+      for(int i=0;i<vn;++i) if(!m.vert[i].IsD())
+        m.vert[i].Q() = dist[i];
+    }
+    else
+    {
+      for(size_t i=0;i<InInterval->size();i++)
+        (*InInterval)[i]->Q() = dist[tri::Index(m,(*InInterval)[i])];
+    }
+    return farthest;
+  }
+
 public:
   /*! \brief Given a set of source vertices compute the approximate geodesic distance to all the other vertices
 
@@ -466,6 +673,32 @@ It requires per vertex Quality (e.g. vertex::Quality component)
     return true;
   }
 
+  /*! \brief Parallel (delta-stepping) version of Compute().
+
+Same parameters and output of Compute(); the frontier is processed by buckets of distance width \p delta
+(by default the average edge length according to \p distFunc) whose vertices are relaxed in parallel.
+The distances are approximated as in Compute() but, since the visiting order differs, they are not bitwise identical to it.
+            */
+  template <class DistanceFunctor>
+  static bool ParallelCompute( MeshType & m,
+                               const std::vector<VertexPointer> & seedVec,
+                               DistanceFunctor &distFunc,
+                               ScalarType maxDistanceThr  = std::numeric_limits<ScalarType>::max(),
+                               std::vector<VertexPointer> *withinDistanceVec=NULL,
+                               typename MeshType::template PerVertexAttributeHandle<VertexPointer> * sourceSeed = NULL,
+                               typename MeshType::template PerVertexAttributeHandle<VertexPointer> * parentSeed = NULL,
+                               ScalarType delta = 0
+                               )
+  {
+    if(seedVec.empty())	return false;
+    std::vector<VertDist> vdSeedVec;
+    typename std::vector<VertexPointer>::const_iterator fi;
+    for( fi  = seedVec.begin(); fi != seedVec.end() ; ++fi)
+        vdSeedVec.push_back(VertDist(*fi,0.0));
+    ParallelVisit(m, vdSeedVec, distFunc, maxDistanceThr, sourceSeed, parentSeed, withinDistanceVec, delta);
+    return true;
+  }
+
   /* \brief Assigns to each vertex of the mesh its distance to the closest vertex on the boundary
 
 It is just a simple wrapper of the basic Compute()
@@ -636,6 +869,81 @@ It is just a simple wrapper of the basic Compute()
     }
   }
 
+  /*! \brief Parallel (delta-stepping) version of PerVertexDijkstraCompute().
+
+Same parameters and output of PerVertexDijkstraCompute() (distances along the mesh edges in the vertex quality,
+reached vertices marked); the vertices are visited by buckets of distance width \p delta (by default the average edge length)
+and the vertices of each bucket are relaxed in parallel. The distances are the same of the serial version;
+when two paths have exactly the same length the chosen source and parent may differ.
+  */
+  template <class DistanceFunctor>
+  static void PerVertexDeltaSteppingCompute(MeshType &m, const std::vector<VertexPointer> &seedVec,
+                                            DistanceFunctor &distFunc,
+                                            ScalarType maxDistanceThr  = std::numeric_limits<ScalarType>::max(),
+                                            std::vector<VertexPointer> *InInterval=NULL,
+                                            typename MeshType::template PerVertexAttributeHandle<VertexPointer> * sourceHandle= NULL,
+                                            typename MeshType::template PerVertexAttributeHandle<VertexPointer> * parentHandle=NULL,
+                                            bool avoid_selected=false,
+                                            VertexPointer target=NULL,
+                                            ScalarType delta = 0)
+  {
+    tri::RequireVFAdjacency(m);
+    tri::RequirePerVertexMark(m);
+    tri::RequirePerVertexQuality(m);
+
+    if(delta<=0) delta = AverageEdgeDistance(m,distFunc);
+
+    const int vn = int(m.vert.size());
+    std::vector<ScalarType> dist(vn,std::numeric_limits<ScalarType>::max());
+    std::vector<int> source(vn,-1), parent(vn,-1), seedInd, expandedVec;
+    for(size_t i=0;i<seedVec.size();++i)
+    {
+      const int si = int(tri::Index(m,seedVec[i]));
+      assert(source[si]==-1);
+      dist[si] = 0;
+      source[si] = si;
+      parent[si] = si;
+      seedInd.push_back(si);
+    }
+
+    auto relax = [&](int ci, std::vector<DistUpdate> &upd)
+    {
+      VertexPointer curr = &m.vert[ci];
+      std::vector<VertexPointer> vertVec;
+      face::VVStarVF<FaceType>(curr,vertVec);
+      for(size_t i=0;i<vertVec.size();++i)
+      {
+        VertexPointer nextV = vertVec[i];
+        if ((avoid_selected)&&(nextV->IsS()))continue;
+        const int ni = int(tri::Index(m,nextV));
+        ScalarType nextDist = dist[ci] + distFunc(curr,nextV);
+        if( (nextDist < maxDistanceThr) && nextDist < dist[ni] )
+          upd.push_back(DistUpdate(ni,nextDist,ci));
+      }
+    };
+    DeltaStepping(m,seedInd,delta,std::numeric_limits<ScalarType>::max(),relax,dist,source,parent,expandedVec,
+                  target==NULL ? -1 : int(tri::Index(m,target)));
+
+    // the expanded vertices first (in visiting order), then the ones reached but not expanded (when stopped at target)
+    tri::UnMarkAll(m);
+    for(size_t i=0;i<expandedVec.size();++i)
+    {
+      tri::Mark(m,&m.vert[expandedVec[i]]);
+      if(InInterval!=NULL) InInterval->push_back(&m.vert[expandedVec[i]]);
+    }
+    for(int i=0;i<vn;++i)
+    {
+      if(source[i]<0) continue;
+      VertexPointer vp = &m.vert[i];
+      if(InInterval!=NULL && !tri::IsMarked(m,vp))
+        InInterval->push_back(vp);
+      tri::Mark(m,vp);
+      vp->Q() = dist[i];
+      if (sourceHandle!=NULL) (*sourceHandle)[vp] = &m.vert[source[i]];
+      if (parentHandle!=NULL) (*parentHandle)[vp] = &m.vert[parent[i]];
+    }
+  }
+
 
 };// end class
 }// end namespace tri
@@ -27,9 +27,11 @@
 
 #include <vcg/complex/algorithms/update/quality.h>
 #include <vcg/complex/algorithms/stat.h>
+#include <vcg/complex/algorithms/mesh_operator_cache.h>
 
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace vcg{
 namespace tri{
@@ -136,6 +138,47 @@ public:
         cotanOperator.makeCompressed();
     }
 
+    /** @brief Returns the factorizations of the heat flow and of the Poisson systems, (M - t Lc) and Lc,
+     * where Lc is the cotangent operator of buildCotanLowerTriMatrix and M the mass matrix of buildMassMatrix.
+     * The operators and the factorizations are taken from the MeshOperatorCache attached to the mesh, if any.
+     * Also stores the face areas in the face quality, as required by computeFaceGradient.
+    */
+    static std::pair<std::shared_ptr<Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>>,
+                     std::shared_ptr<Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>>>
+    getFactorizations(MeshType &mesh, float m){
+        typedef MeshOperatorCache<MeshType> OperatorCache;
+        typedef typename OperatorCache::template Types<double>::SpMat SpMat;
+
+        OperatorCache localCache;
+        OperatorCache *opCache = OperatorCache::Attached(mesh);
+        if (opCache == nullptr) opCache = &localCache;
+        opCache->Validate(mesh);
+
+        vcg::tri::UpdateQuality<MeshType>::FaceArea(mesh);
+        double averageEdgeLength = computeAverageEdgeLength(mesh);
+        double timestep = m * averageEdgeLength * averageEdgeLength;
+
+        typename OperatorCache::Key massKey    = OperatorCache::MakeKey(OperatorCache::GeodesicHeatMass);
+        typename OperatorCache::Key cotanKey   = OperatorCache::MakeKey(OperatorCache::GeodesicHeatCotangent);
+        typename OperatorCache::Key heatKey    = OperatorCache::MakeKey(OperatorCache::GeodesicHeatFlow);
+        typename OperatorCache::Key poissonKey = OperatorCache::MakeKey(OperatorCache::GeodesicHeatPoisson);
+        heatKey.push_back(timestep);
+
+        auto buildMass  = [&](SpMat &M){ buildMassMatrix(mesh, M); };
+        auto buildCotan = [&](SpMat &L){ buildCotanLowerTriMatrix(mesh, L); };
+
+        std::shared_ptr<Eigen::SimplicialLDLT<SpMat>> heat =
+                opCache->template GetFactorization<double>(mesh, heatKey, true, [&](SpMat &A){
+            A = opCache->template GetOperator<double>(mesh, massKey, true, buildMass)
+                - timestep * opCache->template GetOperator<double>(mesh, cotanKey, true, buildCotan);
+        });
+        std::shared_ptr<Eigen::SimplicialLDLT<SpMat>> poisson =
+                opCache->template GetFactorization<double>(mesh, poissonKey, true, [&](SpMat &A){
+            A = opCache->template GetOperator<double>(mesh, cotanKey, true, buildCotan);
+        });
+        return std::make_pair(heat, poisson);
+    }
+
     /** @brief given a mesh returns the average weight length
      * @param mesh the mesh
      * @return double the average edge length
@@ -267,7 +310,8 @@ public:
      * Approximated geodesic distance is stored in the vector quality field.
      * If the underlying factorization fails or the linear system cannot be solved false is returned.
      *
-     * THIS METHOD IS NOT APPROPRIATE FOR MULTIPLE CALLS ON DIFFERENT SOURCE POINTS.
+     * THIS METHOD IS NOT APPROPRIATE FOR MULTIPLE CALLS ON DIFFERENT SOURCE POINTS
+     * unless a MeshOperatorCache is attached to the mesh (that keeps the factorizations until it is invalidated).
      * If multiple calls are required its best to first build the factorizations with
      * GeodesicHeat::BuildCache(mesh, m) then call ComputeFromCache(mesh, source, cache)
      * this will avoid recomputing the underlying factorizations for each set of source points.
@@ -294,31 +338,18 @@ public:
             sourcePoints(vcg::tri::Index(mesh, vp)) = 1;
         }
 
-        Eigen::SparseMatrix<double> massMatrix;
-        Eigen::SparseMatrix<double> cotanMatrix;
-        double averageEdgeLength;
-
-        buildMassMatrix(mesh, massMatrix);
-        buildCotanLowerTriMatrix(mesh, cotanMatrix);
-        averageEdgeLength = computeAverageEdgeLength(mesh);
-
-        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver1;
-        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver2;
-
         // core of the heat method
-        double timestep = m * averageEdgeLength * averageEdgeLength;
-        solver1.compute(massMatrix - timestep * cotanMatrix);
-        if (solver1.info() != Eigen::Success) return false;
-        solver2.compute(cotanMatrix);
-        if (solver2.info() != Eigen::Success) return false;
+        GeodesicHeatCache cache = getFactorizations(mesh, m);
+        if (std::get<0>(cache)->info() != Eigen::Success) return false;
+        if (std::get<1>(cache)->info() != Eigen::Success) return false;
 
-        Eigen::VectorXd heatflow = solver1.solve(sourcePoints); // (VN)
-        if (solver1.info() != Eigen::Success) return false;
+        Eigen::VectorXd heatflow = std::get<0>(cache)->solve(sourcePoints); // (VN)
+        if (std::get<0>(cache)->info() != Eigen::Success) return false;
         Eigen::MatrixX3d heatGradient = computeFaceGradient(mesh, heatflow); // (FN, 3)
         Eigen::MatrixX3d unitVectorField = normalizeVectorField(-heatGradient); // (FN, 3)
         Eigen::VectorXd divergence = computeVertexDivergence(mesh, unitVectorField); // (VN)
-        Eigen::VectorXd geodesicDistance = solver2.solve(divergence); // (VN)
-        if (solver2.info() != Eigen::Success) return false;
+        Eigen::VectorXd geodesicDistance = std::get<1>(cache)->solve(divergence); // (VN)
+        if (std::get<1>(cache)->info() != Eigen::Success) return false;
 
         // shift to impose dist(source) = 0
         geodesicDistance.array() -= geodesicDistance.minCoeff();
@@ -345,6 +376,8 @@ public:
      *
      * This method returns the cache to use in ComputeFromCache.
      * Note that when the mesh changes this cache should be rebuilt.
+     * The factorizations are shared with the MeshOperatorCache attached to the mesh, if any,
+     * so that rebuilding them on an unchanged mesh is cheap.
      *
      * If the factorization fails no error is thrown (errors can be caught during ComputeFromCache).
      */
@@ -361,25 +394,8 @@ public:
         vcg::tri::UpdateTopology<MeshType>::FaceFace(mesh);
         vcg::tri::UpdateNormal<MeshType>::PerFaceNormalized(mesh);
 
-        GeodesicHeatCache cache = std::make_pair(
-            std::make_shared<Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>>(),
-            std::make_shared<Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>>()
-        );
-
-        Eigen::SparseMatrix<double> massMatrix;
-        Eigen::SparseMatrix<double> cotanMatrix;
-        double averageEdgeLength;
-
-        buildMassMatrix(mesh, massMatrix);
-        buildCotanLowerTriMatrix(mesh, cotanMatrix);
-        averageEdgeLength = computeAverageEdgeLength(mesh);
-
         // compute factorizations
-        double timestep = m * averageEdgeLength * averageEdgeLength;
-        std::get<0>(cache)->compute(massMatrix - timestep * cotanMatrix);
-        std::get<1>(cache)->compute(cotanMatrix);
-
-        return cache;
+        return getFactorizations(mesh, m);
     }
 
     /**
@@ -421,6 +437,105 @@ public:
         return true;
     }
 
+    /**
+     * @brief Computes the approximated geodesic distances from many independent sets of sources at once.
+     *
+     * @param mesh the mesh
+     * @param sourceSets the sets of source points, one distance field is computed for each set
+     * @param cache an (up to date) GeodesicHeatCache of the mesh
+     * @param distances the (VN, N) matrix of distances, column j holds the field of sourceSets[j]
+     * @return true if computation was successful
+     *
+     * All the heat flows and all the Poisson problems are solved as multi-column right hand sides
+     * against the cached factorizations; the per face gradients and the per vertex divergences
+     * (whose geometric coefficients are computed once) are evaluated in parallel over the fields.
+     * As for ComputeFromCache, we assume that face normals and quality have not changed after BuildCache was called.
+     */
+    static bool ComputeFromCache(MeshType &mesh, const std::vector<std::vector<VertexPointer> > &sourceSets,
+                                 GeodesicHeatCache &cache, Eigen::MatrixXd &distances){
+        const int vn = mesh.VN();
+        const int fn = mesh.FN();
+        const int setNum = int(sourceSets.size());
+        if (setNum == 0) return false;
+
+        Eigen::MatrixXd sourcePoints = Eigen::MatrixXd::Zero(vn, setNum);
+        for (int j = 0; j < setNum; ++j){
+            if (sourceSets[j].empty()) return false;
+            for (VertexPointer vp : sourceSets[j])
+                sourcePoints(vcg::tri::Index(mesh, vp), j) = 1;
+        }
+
+        Eigen::MatrixXd heatflow = std::get<0>(cache)->solve(sourcePoints); // (VN, N)
+        if (std::get<0>(cache)->info() != Eigen::Success) return false;
+
+        // per face gradient of the three hat functions and per corner divergence weights
+        // (the same quantities of computeFaceGradient and computeVertexDivergence, computed once for all the fields)
+        Eigen::MatrixXd grad(fn, 9), divW(fn, 9);
+        Eigen::MatrixXi fv(fn, 3);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < fn; ++i){
+            FacePointer fp = &mesh.face[i];
+            vcg::Point3f p[3] = { fp->V(0)->P(), fp->V(1)->P(), fp->V(2)->P() };
+            Eigen::Vector3d n = toEigen(fp->N());
+            n /= n.norm();
+            double faceArea = fp->Q();
+            for (int k = 0; k < 3; ++k){
+                fv(i, k) = int(vcg::tri::Index(mesh, fp->V(k)));
+                Eigen::Vector3d eo = toEigen(p[(k+2)%3] - p[(k+1)%3]); // edge opposite to corner k
+                Eigen::Vector3d el = toEigen(p[(k+2)%3] - p[k]);
+                Eigen::Vector3d er = toEigen(p[(k+1)%3] - p[k]);
+                grad.block<1,3>(i, 3*k) = n.cross(eo).transpose() / (2 * faceArea);
+                double cotl = cotan(-el, -eo);
+                double cotr = cotan(-er, eo);
+                divW.block<1,3>(i, 3*k) = ((cotl * er + cotr * el) / 2).transpose();
+            }
+        }
+
+        Eigen::MatrixXd divergence = Eigen::MatrixXd::Zero(vn, setNum);
+#pragma omp parallel for schedule(dynamic)
+        for (int j = 0; j < setNum; ++j){
+            for (int i = 0; i < fn; ++i){
+                Eigen::Vector3d x = Eigen::Vector3d::Zero();
+                for (int k = 0; k < 3; ++k)
+                    x -= grad.block<1,3>(i, 3*k).transpose() * heatflow(fv(i, k), j);
+                x /= x.norm();
+                for (int k = 0; k < 3; ++k)
+                    divergence(fv(i, k), j) += divW.block<1,3>(i, 3*k).dot(x);
+            }
+        }
+
+        distances = std::get<1>(cache)->solve(divergence); // (VN, N)
+        if (std::get<1>(cache)->info() != Eigen::Success) return false;
+
+        // shift to impose dist(source) = 0
+        for (int j = 0; j < setNum; ++j)
+            distances.col(j).array() -= distances.col(j).minCoeff();
+        return true;
+    }
+
+    /**
+     * @brief Batched version of ComputeFromCache that stores each distance field in a per vertex attribute.
+     *
+     * @param mesh the mesh
+     * @param sourceSets the sets of source points
+     * @param cache an (up to date) GeodesicHeatCache of the mesh
+     * @param attributePrefix the field of sourceSets[j] is stored in the ScalarType per vertex attribute named attributePrefix+j
+     * (created if missing)
+     * @return true if computation was successful
+     */
+    static bool ComputeFromCache(MeshType &mesh, const std::vector<std::vector<VertexPointer> > &sourceSets,
+                                 GeodesicHeatCache &cache, const std::string &attributePrefix){
+        Eigen::MatrixXd distances;
+        if (!ComputeFromCache(mesh, sourceSets, cache, distances)) return false;
+        for (int j = 0; j < int(sourceSets.size()); ++j){
+            typename MeshType::template PerVertexAttributeHandle<ScalarType> h =
+                    vcg::tri::Allocator<MeshType>::template GetPerVertexAttribute<ScalarType>(mesh, attributePrefix + std::to_string(j));
+            for (int i = 0; i < mesh.VN(); ++i)
+                h[i] = ScalarType(distances(i, j));
+        }
+        return true;
+    }
+
     private:
     static inline Eigen::Vector3d toEigen(const vcg::Point3f& p){
         return Eigen::Vector3d(p.X(), p.Y(), p.Z());
@@ -25,6 +25,7 @@
 
 #include <vcg/complex/complex.h>
 #include <Eigen/Sparse>
+#include <vcg/complex/algorithms/mesh_operator_cache.h>
 
 namespace vcg {
 namespace tri {
@@ -38,7 +39,7 @@ public:
     typedef typename MeshType::CoordType  CoordType;
     typedef typename MeshType::ScalarType ScalarType;
 
-    typedef double CoeffScalar;
+    typedef double CoeffScalar; // coefficients of the Laplacian and of the factorization (also when cached)
 
     typedef typename std::pair<VertexType *, Scalar> Constraint;
     typedef typename std::vector<Constraint>         ConstraintVec;
@@ -53,12 +54,15 @@ public:
      * @param field the accessor to use to write the computed per-vertex values (must have the [ ] operator).
      * @return true if the algorithm succeeds, false otherwise.
      * @note the algorithm has unexpected behavior if the mesh contains unreferenced vertices.
+     * @note if a MeshOperatorCache is attached to the mesh the Laplacian and the factorization are reused
+     * by the following calls with the same constrained vertices (only the constraint values may change),
+     * as long as the mesh is not changed in between (a change is detected, and the stale data rebuilt).
      */
     template <typename ACCESSOR>
     static bool ComputeScalarField(MeshType & m, const ConstraintVec & constraints, ACCESSOR field, bool biharmonic = false)
     {
-        typedef Eigen::SparseMatrix<CoeffScalar> SpMat;  // sparse matrix type
-        typedef Eigen::Triplet<CoeffScalar>      Triple; // triplet type to fill the matrix
+        typedef MeshOperatorCache<MeshType>                               OperatorCache;
+        typedef typename OperatorCache::template Types<CoeffScalar>::SpMat SpMat;
 
         RequirePerVertexFlags(m);
         RequireCompactness(m);
@@ -71,57 +75,12 @@ public:
 
         int n  = m.VN();
 
-        // Generate coefficients
-        std::vector<Triple>          coeffs;   // coefficients of the system
-        std::map<size_t,CoeffScalar> sums;     // row sum of the coefficient matrix
-
-        vcg::tri::UpdateFlags<MeshType>::FaceClearV(m);
-        for (size_t i = 0; i < m.face.size(); ++i)
-        {
-            FaceType & f = m.face[i];
-            assert(!f.IsV());
-
-            f.SetV();
-
-            // Generate coefficients for each edge
-            for (int edge = 0; edge < 3; ++edge)
-            {
-                CoeffScalar weight;
-                WeightInfo res = CotangentWeightIfNotVisited(f, edge, weight);
-
-                if (res == EdgeAlreadyVisited) continue;
-                assert(res == Success);
-
-                // Add the weight to the coefficients vector for both the vertices of the considered edge
-                size_t v0_idx = vcg::tri::Index(m, f.V0(edge));
-                size_t v1_idx = vcg::tri::Index(m, f.V1(edge));
-
-                coeffs.push_back(Triple(v0_idx, v1_idx, -weight));
-                coeffs.push_back(Triple(v1_idx, v0_idx, -weight));
-
-                // Add the weight to the row sum
-                sums[v0_idx] += weight;
-                sums[v1_idx] += weight;
-            }
-        }
-
-        // Setup the system matrix
-        SpMat laplaceMat;        // the system to be solved
-        laplaceMat.resize(n, n); // eigen initializes it to zero
-        laplaceMat.reserve(coeffs.size());
-        for (std::map<size_t,CoeffScalar>::const_iterator it = sums.begin(); it != sums.end(); ++it)
-        {
-            coeffs.push_back(Triple(it->first, it->first, it->second));
-        }
-        laplaceMat.setFromTriplets(coeffs.begin(), coeffs.end());
-
-        if (biharmonic)
-        {
-            SpMat lap_t = laplaceMat;
-            lap_t.transpose();
-            laplaceMat = lap_t * laplaceMat;
-        }
-
+        // The Laplacian and the factorization are taken from the operator cache attached to the mesh, if any,
+        // so that fields sharing the same constrained vertices are solved with a single factorization
+        OperatorCache localCache;
+        OperatorCache *cache = OperatorCache::Attached(m);
+        if (cache == nullptr) cache = &localCache;
+        cache->Validate(m);
 
         // Setting the constraints
         const CoeffScalar alpha = pow(10.0, 8.0); // penalty factor alpha
@@ -130,21 +89,38 @@ public:
         Eigen::Matrix<CoeffScalar, Eigen::Dynamic, 1> b, x; // Unknown and known terms vectors
         b.setZero(n);
 
+        typename OperatorCache::Key key = OperatorCache::MakeKey(OperatorCache::HarmonicSystem);
+        key.push_back(biharmonic ? 1 : 0);
+        key.push_back(alpha);
         for (ConstraintIt it=constraints.begin(); it!=constraints.end(); it++)
         {
             size_t v_idx = vcg::tri::Index(m, it->first);
             b(v_idx) = alpha * it->second;
-            laplaceMat.coeffRef(v_idx, v_idx) += alpha;
+            key.push_back(CoeffScalar(v_idx));
         }
 
-        // Perform matrix decomposition
-        Eigen::SimplicialLDLT<SpMat> solver;
-        solver.compute(laplaceMat);
+        // Perform matrix decomposition (or reuse it)
+        std::shared_ptr<typename OperatorCache::template Types<CoeffScalar>::Factorization> solver =
+                cache->template GetFactorization<CoeffScalar>(m, key, true, [&](SpMat &laplaceMat)
+        {
+            laplaceMat = CotangentLaplacian(m, *cache);
+            if (biharmonic)
+            {
+                SpMat lap_t = laplaceMat;
+                lap_t.transpose();
+                laplaceMat = lap_t * laplaceMat;
+            }
+            for (ConstraintIt it=constraints.begin(); it!=constraints.end(); it++)
+            {
+                size_t v_idx = vcg::tri::Index(m, it->first);
+                laplaceMat.coeffRef(v_idx, v_idx) += alpha;
+            }
+        });
         // TODO eventually use another solver (e.g. CHOLMOD for dynamic setups)
-        if(solver.info() != Eigen::Success)
+        if(solver->info() != Eigen::Success)
         {
             // decomposition failed
-            switch (solver.info())
+            switch (solver->info())
             {
             // possible errors
             case Eigen::NumericalIssue :
@@ -155,8 +131,8 @@ public:
         }
 
         // Solve the system: laplacianMat x = b
-        x = solver.solve(b);
-        if(solver.info() != Eigen::Success)
+        x = solver->solve(b);
+        if(solver->info() != Eigen::Success)
         {
             return false;
         }
@@ -170,6 +146,66 @@ public:
         return true;
     }
 
+    /**
+     * @brief CotangentLaplacian the symmetric positive semidefinite cotangent Laplacian of the mesh,
+     * L(i,j) = -(cot a + cot b)/2 for each edge and L(i,i) = - Sum_j L(i,j), with coefficients of type CoeffScalar.
+     * It is taken from the cache, where it is assembled on the first request.
+     * @note the mesh must be compact and have the face-face topology updated
+     */
+    static const Eigen::SparseMatrix<CoeffScalar> &CotangentLaplacian(MeshType & m, MeshOperatorCache<MeshType> & cache)
+    {
+        typedef Eigen::SparseMatrix<CoeffScalar> SpMat;  // sparse matrix type
+        typedef Eigen::Triplet<CoeffScalar>      Triple; // triplet type to fill the matrix
+
+        typedef MeshOperatorCache<MeshType> OperatorCache;
+        typename OperatorCache::Key key = OperatorCache::MakeKey(OperatorCache::HarmonicLaplacian);
+        return cache.template GetOperator<CoeffScalar>(m, key, true, [&](SpMat &laplaceMat)
+        {
+            // Generate coefficients
+            std::vector<Triple>          coeffs;   // coefficients of the system
+            std::map<size_t,CoeffScalar> sums;     // row sum of the coefficient matrix
+
+            vcg::tri::UpdateFlags<MeshType>::FaceClearV(m);
+            for (size_t i = 0; i < m.face.size(); ++i)
+            {
+                FaceType & f = m.face[i];
+                assert(!f.IsV());
+
+                f.SetV();
+
+                // Generate coefficients for each edge
+                for (int edge = 0; edge < 3; ++edge)
+                {
+                    CoeffScalar weight;
+                    WeightInfo res = CotangentWeightIfNotVisited(f, edge, weight);
+
+                    if (res == EdgeAlreadyVisited) continue;
+                    assert(res == Success);
+
+                    // Add the weight to the coefficients vector for both the vertices of the considered edge
+                    size_t v0_idx = vcg::tri::Index(m, f.V0(edge));
+                    size_t v1_idx = vcg::tri::Index(m, f.V1(edge));
+
+                    coeffs.push_back(Triple(v0_idx, v1_idx, -weight));
+                    coeffs.push_back(Triple(v1_idx, v0_idx, -weight));
+
+                    // Add the weight to the row sum
+                    sums[v0_idx] += weight;
+                    sums[v1_idx] += weight;
+                }
+            }
+
+            // Setup the system matrix
+            laplaceMat.resize(m.VN(), m.VN()); // eigen initializes it to zero
+            laplaceMat.reserve(coeffs.size());
+            for (typename std::map<size_t,CoeffScalar>::const_iterator it = sums.begin(); it != sums.end(); ++it)
+            {
+                coeffs.push_back(Triple(it->first, it->first, it->second));
+            }
+            laplaceMat.setFromTriplets(coeffs.begin(), coeffs.end());
+        });
+    }
+
     enum WeightInfo
     {
         Success            = 0,
@@ -531,6 +531,7 @@ template<class EAR>
     {
       std::vector< Info > vinfo;
       GetInfo(m, Selected,vinfo);
+      ReserveHoleFaces(m,vinfo,sizeHole);
 
       typename std::vector<Info >::iterator ith;
       int indCb=0;
@@ -560,6 +561,7 @@ template<class EAR>
     {
       std::vector<Info > vinfo;
       GetInfo(m, Selected,vinfo);
+      ReserveHoleFaces(m,vinfo,maxSizeHole);
       typename std::vector<Info>::iterator ith;
 
       // collect the face pointer that has to be updated by the various addfaces
@@ -605,6 +607,24 @@ template<class EAR>
 
 
 
+/// Reserve at once the room for the faces needed to close all the holes smaller than maxSizeHole,
+/// so that the AddFaces done for each single hole never reallocate the face vector
+/// (and never trigger a pass over the whole mesh to fix the face pointers).
+    static void ReserveHoleFaces(MESH &m, std::vector<Info> &vinfo, const int maxSizeHole)
+    {
+      size_t newFaceNum=0;
+      typename std::vector<Info>::iterator ith;
+      for(ith = vinfo.begin(); ith!= vinfo.end(); ++ith)
+        if((*ith).size < maxSizeHole && (*ith).size > 2)
+          newFaceNum += (*ith).size-2;
+
+      typename tri::Allocator<MESH>::template PointerUpdater<FacePointer> pu;
+      tri::Allocator<MESH>::ReserveFaces(m, m.face.size()+newFaceNum, pu);
+      if(pu.NeedUpdate())
+        for(ith = vinfo.begin(); ith!= vinfo.end(); ++ith)
+          pu.Update((*ith).p.f);
+    }
+
     static void GetInfo(MESH &m, bool Selected ,std::vector<Info >& VHI)
         {
       tri::UpdateFlags<MESH>::FaceClearV(m);
@@ -25,6 +25,7 @@
 
 #include <Eigen/Sparse>
 #include <vcg/complex/algorithms/mesh_to_matrix.h>
+#include <vcg/complex/algorithms/mesh_operator_cache.h>
 #include <vcg/complex/algorithms/update/quality.h>
 #include <vcg/complex/algorithms/smooth.h>
 
@@ -179,8 +180,7 @@ private:
                                               const Parameter &SParam,
                                               std::vector<std::pair<int,int> > &IndexC,
                                               std::vector<ScalarType> &WeightC,
-                                              std::vector<int> &IndexRhs,
-                                              std::vector<ScalarType> &ValueRhs)
+                                              std::vector<CoordType> &ValueRhs)
     {
         ScalarType penalty;
         int baseIndex=mesh.vert.size();
@@ -204,187 +204,151 @@ private:
                 ScalarType currW=SParam.ConstrainedF[i].BarycentricW[j];
 
                 //get the index of the current vertex
-                int FaceVert=vcg::tri::Index(mesh,mesh.face[FaceN].V(j));
+                int IndexV=vcg::tri::Index(mesh,mesh.face[FaceN].V(j));
 
-                //then add the constraints componentwise
-                for (int k=0;k<3;k++)
-                {
-                    //multiply times 3 per component
-                    int IndexV=(FaceVert*3)+k;
-
-                    //get the index of the current constraint
-                    int ComponentConstraint=(IndexConstraint*3)+k;
-                    IndexC.push_back(std::pair<int,int>(ComponentConstraint,IndexV));
-
-                    WeightC.push_back(currW*penalty);
-
-                    IndexC.push_back(std::pair<int,int>(IndexV,ComponentConstraint));
-                    WeightC.push_back(currW*penalty);
-
-                    //this to avoid the 1 on diagonal last entry of mass matrix
-                    IndexC.push_back(std::pair<int,int>(ComponentConstraint,ComponentConstraint));
-                    WeightC.push_back(-1);
-                }
-            }
+                //the same entries hold for each component
+                IndexC.push_back(std::pair<int,int>(IndexConstraint,IndexV));
+                WeightC.push_back(currW*penalty);
 
-            for (int j=0;j<3;j++)
-            {
-                //get the index of the current constraint
-                int ComponentConstraint=(IndexConstraint*3)+j;
-
-                //get per component value
-                ScalarType ComponentV=SParam.ConstrainedF[i].TargetPos.V(j);
+                IndexC.push_back(std::pair<int,int>(IndexV,IndexConstraint));
+                WeightC.push_back(currW*penalty);
 
-                //add the diagonal value
-                IndexRhs.push_back(ComponentConstraint);
-                ValueRhs.push_back(ComponentV*penalty);
+                //this to avoid the 1 on diagonal last entry of mass matrix
+                IndexC.push_back(std::pair<int,int>(IndexConstraint,IndexConstraint));
+                WeightC.push_back(-1);
             }
 
+            //the per component value
+            ValueRhs.push_back(SParam.ConstrainedF[i].TargetPos*penalty);
         }
     }
 
 public:
 
-
+    /**
+     * @brief Compute solves (M + B + lambda L^d) X = M X0 for the new vertex positions (or quality).
+     * Each entry of the system couples the same coordinate of different vertices, so instead of the 3n x 3n system
+     * a single n x n one is factorized and solved for the three coordinates at once.
+     * If a tri::MeshOperatorCache is attached to the mesh the Laplacian, the vertex areas and the factorization are reused
+     * by the following calls: with the uniform Laplacian and no mass matrix nothing is recomputed, otherwise
+     * (since the smoothing moves the vertices, and invalidates the geometry of the cache) only the numeric factorization is redone.
+     */
     static void Compute(MeshType &mesh, Parameter &SParam)
     {
+        typedef tri::MeshOperatorCache<MeshType> OperatorCache;
+        typedef typename OperatorCache::template Types<ScalarType>::SpMat SpMat;
+        typedef Eigen::Triplet<ScalarType> Triple;
+
         //calculate the size of the system
-        int matr_size=mesh.vert.size()+SParam.ConstrainedF.size();
+        const int vert_num=mesh.vert.size();
+        const int matr_size=vert_num+SParam.ConstrainedF.size();
 
-        //the laplacian and the mass matrix
-        Eigen::SparseMatrix<ScalarType> L,M,B;
+        OperatorCache localCache;
+        OperatorCache *cache=OperatorCache::Attached(mesh);
+        if (cache==nullptr) cache=&localCache;
+        cache->Validate(mesh);
 
         //initialize the mass matrix
         std::vector<std::pair<int,int> > IndexM;
         std::vector<ScalarType> ValuesM;
 
-        //add the entries for mass matrix
+        //add the entries for mass matrix (the vertex areas are taken from the cache)
         if (SParam.useMassMatrix)
-            vcg::tri::MeshToMatrix<MeshType>::MassMatrixEntry(mesh,IndexM,ValuesM,!SParam.SmoothQ);
+            vcg::tri::MeshToMatrix<MeshType>::MassMatrixEntry(mesh,cache->VertexDoubleArea(mesh),IndexM,ValuesM,false);
 
         //then add entries for lagrange mult due to barycentric constraints
         for (size_t i=0;i<SParam.ConstrainedF.size();i++)
         {
-            int baseIndex=(mesh.vert.size()+i)*3;
-
-            if (SParam.SmoothQ)
-                baseIndex=(mesh.vert.size()+i);
-
-            if (SParam.SmoothQ)
-            {
-                IndexM.push_back(std::pair<int,int>(baseIndex,baseIndex));
-                ValuesM.push_back(1);
-            }
-            else
-            {
-                for (int j=0;j<3;j++)
-                {
-                    IndexM.push_back(std::pair<int,int>(baseIndex+j,baseIndex+j));
-                    ValuesM.push_back(1);
-                }
-            }
+            IndexM.push_back(std::pair<int,int>(vert_num+i,vert_num+i));
+            ValuesM.push_back(1);
         }
         //add the hard constraints
-        CollectHardConstraints(mesh,SParam,IndexM,ValuesM,SParam.SmoothQ);
+        const size_t firstHard=IndexM.size();
+        CollectHardConstraints(mesh,SParam,IndexM,ValuesM,true);
 
-        //initialize sparse mass matrix
-        if (!SParam.SmoothQ)
-            InitSparse(IndexM,ValuesM,matr_size*3,matr_size*3,M);
-        else
-            InitSparse(IndexM,ValuesM,matr_size,matr_size,M);
+        //the mass matrix is diagonal
+        std::vector<ScalarType> MDiag(matr_size,0);
+        for (size_t i=0;i<IndexM.size();i++)
+            MDiag[IndexM[i].first]+=ValuesM[i];
 
         //initialize the barycentric matrix
         std::vector<std::pair<int,int> > IndexB;
         std::vector<ScalarType> ValuesB;
-
-        std::vector<int> IndexRhs;
-        std::vector<ScalarType> ValuesRhs;
-
-        //then also collect hard constraints
+        std::vector<CoordType> ValuesRhs;
         if (!SParam.SmoothQ)
+            CollectBarycentricConstraints(mesh,SParam,IndexB,ValuesB,ValuesRhs);
+
+        //the key identifying the system matrix in the cache
+        typename OperatorCache::Key key=OperatorCache::MakeKey(OperatorCache::ImplicitSmoothSystem);
+        key.push_back(SParam.lambda);
+        key.push_back(SParam.degree);
+        key.push_back(SParam.useCotWeight ? 1 : 0);
+        key.push_back(SParam.useCotWeight ? 0 : SParam.lapWeight);
+        key.push_back(SParam.useMassMatrix ? 1 : 0);
+        key.push_back(matr_size);
+        for (size_t i=firstHard;i<IndexM.size();i++)
+            key.push_back(IndexM[i].first);
+        key.push_back(-1);
+        for (size_t i=0;i<IndexB.size();i++)
         {
-            CollectBarycentricConstraints(mesh,SParam,IndexB,ValuesB,IndexRhs,ValuesRhs);
-            //initialize sparse constraint matrix
-            InitSparse(IndexB,ValuesB,matr_size*3,matr_size*3,B);
+            key.push_back(IndexB[i].first);
+            key.push_back(IndexB[i].second);
+            key.push_back(ValuesB[i]);
         }
-        else
-            InitSparse(IndexB,ValuesB,matr_size,matr_size,B);
-
-        //get the entries for laplacian matrix
-        std::vector<std::pair<int,int> > IndexL;
-        std::vector<ScalarType> ValuesL;
-        vcg::tri::MeshToMatrix<MeshType>::GetLaplacianMatrix(mesh,IndexL,ValuesL,SParam.useCotWeight,SParam.lapWeight,!SParam.SmoothQ);
-
-        //initialize sparse laplacian matrix
-        if (!SParam.SmoothQ)
-            InitSparse(IndexL,ValuesL,matr_size*3,matr_size*3,L);
-        else
-            InitSparse(IndexL,ValuesL,matr_size,matr_size,L);
-
-        for (int i=0;i<(SParam.degree-1);i++)L=L*L;
 
-        //then solve the system
-        Eigen::SparseMatrix<ScalarType> S = (M + B + SParam.lambda*L);
-
-        //SimplicialLDLT
-        Eigen::SimplicialCholesky<Eigen::SparseMatrix<ScalarType > > solver(S);
-        assert(solver.info() == Eigen::Success);
-
-        MatrixXm V;
-        if (!SParam.SmoothQ)
-            V=MatrixXm(matr_size*3,1);
-        else
-            V=MatrixXm(matr_size,1);
-
-        //set the first part of the matrix with vertex values
-        if (!SParam.SmoothQ)
+        std::shared_ptr<typename OperatorCache::template Types<ScalarType>::Factorization> solver =
+                cache->template GetFactorization<ScalarType>(mesh,key,SParam.useCotWeight || SParam.useMassMatrix,[&](SpMat &S)
         {
-            for (size_t i=0;i<mesh.vert.size();i++)
-            {
-                int index=i*3;
-                V(index,0)=mesh.vert[i].P().X();
-                V(index+1,0)=mesh.vert[i].P().Y();
-                V(index+2,0)=mesh.vert[i].P().Z();
-            }
-        }
-        else
+            //the laplacian matrix
+            SpMat L=vcg::tri::MeshToMatrix<MeshType>::GetLaplacianOperator(*cache,mesh,SParam.useCotWeight,SParam.lapWeight);
+            for (int i=0;i<(SParam.degree-1);i++)L=L*L;
+
+            //then assemble S = M + B + lambda L
+            std::vector<Triple> IJV;
+            IJV.reserve(L.nonZeros()+matr_size+IndexB.size());
+            for (int k=0;k<L.outerSize();++k)
+                for (typename SpMat::InnerIterator it(L,k);it;++it)
+                    IJV.push_back(Triple(it.row(),it.col(),SParam.lambda*it.value()));
+            for (int i=0;i<matr_size;i++)
+                IJV.push_back(Triple(i,i,MDiag[i]));
+            for (size_t i=0;i<IndexB.size();i++)
+                IJV.push_back(Triple(IndexB[i].first,IndexB[i].second,ValuesB[i]));
+            S.resize(matr_size,matr_size);
+            S.setFromTriplets(IJV.begin(),IJV.end());
+        });
+        assert(solver->info() == Eigen::Success);
+
+        //the right hand side M*V, one column per component
+        const int cols=SParam.SmoothQ ? 1 : 3;
+        MatrixXm V(matr_size,cols);
+        for (int i=0;i<vert_num;i++)
         {
-            for (size_t i=0;i<mesh.vert.size();i++)
-            {
-                int index=i;
-                V(index,0)=mesh.vert[i].Q();
-            }
+            if (!SParam.SmoothQ)
+                for (int j=0;j<3;j++)
+                    V(i,j)=MDiag[i]*mesh.vert[i].P()[j];
+            else
+                V(i,0)=MDiag[i]*mesh.vert[i].Q();
         }
 
-        //then set the second part by considering RHS gien by barycentric constraint
-        for (size_t i=0;i<IndexRhs.size();i++)
-        {
-            int index=IndexRhs[i];
-            ScalarType val=ValuesRhs[i];
-            V(index,0)=val;
-        }
+        //then set the second part by considering RHS given by barycentric constraint
+        for (int i=vert_num;i<matr_size;i++)
+            for (int j=0;j<cols;j++)
+                V(i,j)=(ValuesRhs.empty()) ? 0 : MDiag[i]*ValuesRhs[i-vert_num][j];
 
         //solve the system
-        V = solver.solve(M*V).eval();
+        V = solver->solve(V).eval();
 
         //then copy back values
-        if (!SParam.SmoothQ)
-        {
-            for (size_t i=0;i<mesh.vert.size();i++)
-            {
-                int index=i*3;
-                mesh.vert[i].P().X()=V(index,0);
-                mesh.vert[i].P().Y()=V(index+1,0);
-                mesh.vert[i].P().Z()=V(index+2,0);
-            }
-        }else
+        for (int i=0;i<vert_num;i++)
         {
-            for (size_t i=0;i<mesh.vert.size();i++)
-            {
-                int index=i;
-                mesh.vert[i].Q()=V(index,0);
-            }
+            if (!SParam.SmoothQ)
+                for (int j=0;j<3;j++)
+                    mesh.vert[i].P()[j]=V(i,j);
+            else
+                mesh.vert[i].Q()=V(i,0);
         }
+        if (!SParam.SmoothQ)
+            cache->InvalidateGeometry();
     }
 };
 
@@ -24,6 +24,7 @@
 #ifndef __VCGLIB_LOCALOPTIMIZATION
 #define __VCGLIB_LOCALOPTIMIZATION
 #include <vcg/complex/complex.h>
+#include <vcg/complex/algorithms/local_optimization/progressive_mesh.h>
 #include <time.h>
 namespace vcg{
 // Base class for Parameters
@@ -44,7 +45,9 @@ class LocalModification
 {
  public:
         typedef typename LocalOptimization<MeshType>::HeapType HeapType;
+        typedef typename LocalOptimization<MeshType>::HeapKeyType HeapKeyType;
         typedef typename MeshType::ScalarType ScalarType;
+        typedef typename MeshType::VertexPointer VertexPointer;
 
   inline LocalModification(){}
   virtual ~LocalModification(){}
@@ -80,6 +83,27 @@ class LocalModification
   virtual const char *Info(MeshType &) {return 0;}
 	/// Update the heap as a consequence of this operation
   virtual void UpdateHeap(HeapType&, BaseParameterClass *pp)=0;
+
+  /// Region of the mesh involved by the operation, used by LocalOptimization::DoOptimizationParallel().
+  /// writeSet gets the vertices changed by Execute() and UpdateHeap() (a face can be changed only if one of its vertices is there),
+  /// readSet all the vertices of the faces they visit (the ones of writeSet can be omitted). Two operations whose write set does not
+  /// intersect the read set of the other one can be processed concurrently; in particular UpdateHeap() must be safe to be called in parallel for them.
+  /// It must not change the mesh, since it is called concurrently for many operations.
+  /// Return false (default) if the operation does not support concurrent processing.
+  virtual bool ParallelRegion(std::vector<VertexPointer> &/*writeSet*/, std::vector<VertexPointer> &/*readSet*/) { return false; }
+
+  /// Key of the operation in the indexed heap (see LocalOptimization::UseIndexedHeap), e.g. the edge of an edge collapse.
+  /// The indexed heap keeps only the last operation inserted for each key, so an operation must supersede any older one with the same key.
+  /// Return false (default) if the operation does not support the indexed heap.
+  virtual bool HeapKey(HeapKeyType &/*key*/, BaseParameterClass * /*pp*/) const { return false; }
+
+  /// Keys of the operations that become impossible after Execute() (e.g. the collapses of the edges of the removed vertex),
+  /// that are dropped from the indexed heap. It is called just before Execute().
+  virtual void ObsoleteKeys(std::vector<HeapKeyType> &/*keys*/, BaseParameterClass * /*pp*/) {}
+
+  /// Record in pm the operation, so that it can be undone (see LocalOptimization::Recorder). It is called just before Execute().
+  /// Return false (default) if the operation cannot be recorded.
+  virtual bool Record(tri::ProgressiveMesh<MeshType> &/*pm*/, BaseParameterClass * /*pp*/) { return false; }
 };	//end class local modification
 
 
@@ -94,11 +118,12 @@ template<class MeshType>
 class LocalOptimization
 {
 public:
-  LocalOptimization(MeshType &mm, BaseParameterClass *_pp): m(mm){ ClearTermination();HeapSimplexRatio=5; pp=_pp;}
+  LocalOptimization(MeshType &mm, BaseParameterClass *_pp): m(mm){ ClearTermination();HeapSimplexRatio=5; ParallelBatchRatio=0.002f; UseIndexedHeap=false; Recorder=0; pp=_pp;}
 
 	struct  HeapElem;
 	typedef typename MeshType::ScalarType ScalarType;
 	typedef typename std::vector<HeapElem> HeapType;	
+  typedef typename std::pair<typename MeshType::VertexPointer,typename MeshType::VertexPointer> HeapKeyType;
   typedef  LocalModification <MeshType>  LocModType;
 
 	/// termination conditions	
@@ -128,6 +153,23 @@ public:
 
   float HeapSimplexRatio; 
 
+  // The number of operations popped at each round of DoOptimizationParallel(), as a fraction of the simplices of the current mesh (at least 64).
+  // Larger batches give more parallelism but a processing order that is farther from the serial one.
+
+  float ParallelBatchRatio;
+
+  // If true (it must be set before Init()) the heap is an indexed binary heap holding at most one operation
+  // for each key (see LocalModification::HeapKey()): a new operation replaces the previous one with the same key
+  // and the operations made impossible by a modification are removed, so the heap size stays proportional to the
+  // mesh size and no ClearHeap() is needed. It is silently disabled if the operations do not provide a key.
+
+  bool UseIndexedHeap;
+
+  // If not null, every operation executed is recorded in it (see tri::ProgressiveMesh), e.g. to save the
+  // simplification as a progressive mesh. The recorder is invalidated if an operation does not support recording.
+
+  tri::ProgressiveMesh<MeshType> *Recorder;
+
 	void SetTerminationFlag		(int v){tf |= v;}
 	void ClearTerminationFlag	(int v){tf &= ~v;}
 	bool IsTerminationFlag		(int v){return ((tf & v)!=0);}
@@ -210,11 +252,10 @@ public:
 		nPerformedOps =0;
 		while( !GoalReached() && !h.empty())
 			{
-        if(h.size()> m.SimplexNumber()*HeapSimplexRatio )  ClearHeap();
-				std::pop_heap(h.begin(),h.end());
-        LocModType  *locMod   = h.back().locModPtr;
-				currMetric=h.back().pri;
-        h.pop_back();
+        if(!UseIndexedHeap && h.size()> m.SimplexNumber()*HeapSimplexRatio )  ClearHeap();
+        HeapElem he = PopHeap();
+        LocModType  *locMod   = he.locModPtr;
+				currMetric=he.pri;
         				
         if( locMod->IsUpToDate() )
 				{	
@@ -222,8 +263,7 @@ public:
           if (locMod->IsFeasible(this->pp))
 					{
 						nPerformedOps++;
-            locMod->Execute(m,this->pp);
-            locMod->UpdateHeap(h,this->pp);
+            ExecuteAndUpdate(locMod);
 						}
 				}
 				delete locMod;
@@ -231,6 +271,152 @@ public:
 		return !(h.empty());
   }
  
+  /// Parallel version of DoOptimization().
+  /// At each round a block of the cheapest operations is popped from the heap and their regions
+  /// (see LocalModification::ParallelRegion()) are computed concurrently; then, in heap order, each operation
+  /// is taken if its region does not overlap the one of an operation already taken, otherwise it is put back in the heap.
+  /// The operations taken are executed in heap order, then their UpdateHeap() are run concurrently, each one
+  /// on its own small heap, and the new operations are merged into the main heap in batch order.
+  /// Being independent, the operations of a batch have the same priority they would have in the serial processing;
+  /// the result differs from DoOptimization() only because the operations created during a round are considered
+  /// from the next one, so the difference shrinks with ParallelBatchRatio. It does not depend on the number of threads.
+  /// Operations that do not support concurrent processing are simply processed one at a time.
+  /// Note that the time budget (LOTime) is measured with clock(), i.e. as processor time summed over all the threads.
+  bool DoOptimizationParallel()
+  {
+    assert ( ( ( tf & LOnSimplices	)==0) ||  ( nTargetSimplices!= -1));
+    assert ( ( ( tf & LOnVertices	)==0) ||  ( nTargetVertices	!= -1));
+    assert ( ( ( tf & LOnOps		)==0) ||  ( nTargetOps		!= -1));
+    assert ( ( ( tf & LOMetric		)==0) ||  ( targetMetric	!= -1));
+    assert ( ( ( tf & LOTime		)==0) ||  ( timeBudget		!= -1));
+
+    typedef typename MeshType::VertexPointer VertexPointer;
+    start=clock();
+    nPerformedOps =0;
+    std::vector<int> lockW, lockR; // per vertex, last round whose taken operations write/read it
+    int stamp=0;
+    std::vector<HeapElem> cand, batch, deferred;
+    std::vector<std::vector<VertexPointer> > candW, candR;
+    std::vector<char> candPar;
+    std::vector<HeapType> newOps;
+    while( !GoalReached() && !h.empty())
+    {
+      if(!UseIndexedHeap && h.size()> m.SimplexNumber()*HeapSimplexRatio )  ClearHeap();
+      if(lockW.size()!=m.vert.size() || stamp==std::numeric_limits<int>::max())
+      {
+        lockW.assign(m.vert.size(),0);
+        lockR.assign(m.vert.size(),0);
+        stamp=0;
+      }
+      ++stamp;
+      const size_t blockSize = std::max(size_t(64),size_t(m.SimplexNumber()*ParallelBatchRatio));
+      const VertexPointer vBase = m.vert.empty() ? 0 : &m.vert[0];
+
+      // Pop the candidates of this round
+      cand.clear();
+      while(cand.size()<blockSize && !h.empty() && !GoalReached())
+      {
+        HeapElem he = PopHeap();
+        currMetric=he.pri;
+        if( he.locModPtr->IsUpToDate() && he.locModPtr->IsFeasible(this->pp))
+          cand.push_back(he);
+        else
+          delete he.locModPtr;
+      }
+      const int candNum = int(cand.size());
+      if(candW.size()<cand.size())
+      {
+        candW.resize(cand.size());
+        candR.resize(cand.size());
+      }
+      candPar.resize(cand.size());
+#pragma omp parallel for schedule(dynamic,64)
+      for(int i=0;i<candNum;++i)
+      {
+        candW[i].clear();
+        candR[i].clear();
+        candPar[i] = cand[i].locModPtr->ParallelRegion(candW[i],candR[i]);
+      }
+
+      // Greedy selection of independent operations, in heap order
+      bool serialOp=false;
+      batch.clear();
+      deferred.clear();
+      for(int i=0;i<candNum;++i)
+      {
+        if(!candPar[i])
+        {
+          if(batch.empty()) { batch.push_back(cand[i]); serialOp=true; }
+          else deferred.push_back(cand[i]);
+          deferred.insert(deferred.end(),cand.begin()+i+1,cand.end());
+          break;
+        }
+        const std::vector<VertexPointer> &ws=candW[i];
+        const std::vector<VertexPointer> &rs=candR[i];
+        bool independent=true;
+        for(size_t j=0;j<ws.size() && independent;++j)
+          if(lockR[ws[j]-vBase]==stamp) independent=false;
+        for(size_t j=0;j<rs.size() && independent;++j)
+          if(lockW[rs[j]-vBase]==stamp) independent=false;
+        if(!independent)
+        {
+          deferred.push_back(cand[i]);
+          continue;
+        }
+        for(size_t j=0;j<ws.size();++j) { lockW[ws[j]-vBase]=stamp; lockR[ws[j]-vBase]=stamp; }
+        for(size_t j=0;j<rs.size();++j) lockR[rs[j]-vBase]=stamp;
+        batch.push_back(cand[i]);
+      }
+
+      if(serialOp)
+      {
+        nPerformedOps++;
+        for(size_t i=0;i<deferred.size();++i)
+          PushHeap(deferred[i]);
+        ExecuteAndUpdate(batch[0].locModPtr);
+        delete batch[0].locModPtr;
+      }
+      else
+      {
+        // Execution, in heap order, stopping as soon as the goal is reached
+        size_t executed=0;
+        for(;executed<batch.size();++executed)
+        {
+          if(executed>0)
+          {
+            currMetric=batch[executed-1].pri;
+            if(GoalReached()) break;
+          }
+          nPerformedOps++;
+          if(UseIndexedHeap) RemoveObsoleteKeys(batch[executed].locModPtr);
+          RecordAndExecute(batch[executed].locModPtr);
+        }
+        if(executed>0) currMetric=batch[executed-1].pri;
+        deferred.insert(deferred.end(),batch.begin()+executed,batch.end());
+
+        // The deferred operations go back first, so that in the indexed heap they are replaced by the new ones with the same key
+        for(size_t i=0;i<deferred.size();++i)
+          PushHeap(deferred[i]);
+
+        // Concurrent update of the heap
+        if(newOps.size()<executed) newOps.resize(executed);
+        const int opNum = int(executed);
+#pragma omp parallel for schedule(dynamic,16)
+        for(int i=0;i<opNum;++i)
+          batch[i].locModPtr->UpdateHeap(newOps[i],this->pp);
+
+        for(size_t i=0;i<executed;++i)
+        {
+          for(size_t j=0;j<newOps[i].size();++j)
+            PushHeap(newOps[i][j]);
+          newOps[i].clear();
+          delete batch[i].locModPtr;
+        }
+      }
+    }
+    return !(h.empty());
+  }
+
 // It removes from the heap all the operations that are no more 'uptodate' 
 // (e.g. collapses that have some recently modified vertices)
 // This function  is called from time to time by the doOptimization (e.g. when the heap is larger than fn*3)
@@ -255,7 +441,8 @@ public:
       ++hi;
     }
 //    printf("\nReduced heap from %7i to %7i (fn %7i) in %7.2f \n",sz,h.size(),m.fn,float(clock()-t0)/CLOCKS_PER_SEC);
-    make_heap(h.begin(),h.end());
+    if(UseIndexedHeap) BuildIndex();
+    else make_heap(h.begin(),h.end());
   }
   
 	///initialize for all vertex the temporary mark must call only at the start of decimation
@@ -269,7 +456,8 @@ public:
     HeapSimplexRatio = LocalModificationType::HeapSimplexRatio(pp);
 		
     LocalModificationType::Init(m,h,pp);
-    std::make_heap(h.begin(),h.end());
+    if(UseIndexedHeap) BuildIndex();
+    else std::make_heap(h.begin(),h.end());
     if(!h.empty()) currMetric=h.front().pri;
 	}
 
@@ -298,6 +486,234 @@ public:
 		return false;
 	}
 
+protected:
+  // Indexed heap: h is kept as a binary heap (same ordering of std::push_heap) and each element has a slot,
+  // that stores its key and its current position in h. The slots are found from the keys by mean of
+  // a small list for each vertex (the first one of the key), that is much more cache friendly than a hash table.
+  typedef typename MeshType::VertexPointer VertexPointer;
+  typedef std::vector<std::pair<VertexPointer,int> > KeySlotList;
+  std::vector<int> hSlot;                // slot of each element of h
+  std::vector<size_t> slotPos;           // position in h of each slot
+  std::vector<HeapKeyType> slotKey;      // key of each slot
+  std::vector<int> freeSlots;
+  std::vector<KeySlotList> keySlot;      // for each vertex, the second vertex and the slot of its keys
+  HeapType hNew;
+  std::vector<HeapKeyType> obsoleteKeys;
+
+  KeySlotList &KeyList(VertexPointer v)
+  {
+    const size_t vi=size_t(v-&*m.vert.begin());
+    if(vi>=keySlot.size()) keySlot.resize(m.vert.size());
+    return keySlot[vi];
+  }
+
+  /// Slot of a key, -1 if it is not in the heap
+  int FindKey(const HeapKeyType &k)
+  {
+    const KeySlotList &kl=KeyList(k.first);
+    for(size_t i=0;i<kl.size();++i)
+      if(kl[i].first==k.second) return kl[i].second;
+    return -1;
+  }
+
+  /// Remove a key from the index and return its slot, -1 if it is not in the heap
+  int EraseKey(const HeapKeyType &k)
+  {
+    KeySlotList &kl=KeyList(k.first);
+    for(size_t i=0;i<kl.size();++i)
+      if(kl[i].first==k.second)
+      {
+        const int slot=kl[i].second;
+        kl[i]=kl.back();
+        kl.pop_back();
+        return slot;
+      }
+    return -1;
+  }
+
+  /// Perform the operation, recording it if required
+  void RecordAndExecute(LocModType *locMod)
+  {
+    if(Recorder && !locMod->Record(*Recorder,this->pp))
+      Recorder->Invalidate();
+    locMod->Execute(m,this->pp);
+  }
+
+  /// Perform the operation and put in the heap the operations created by its UpdateHeap()
+  void ExecuteAndUpdate(LocModType *locMod)
+  {
+    if(!UseIndexedHeap)
+    {
+      RecordAndExecute(locMod);
+      locMod->UpdateHeap(h,this->pp);
+      return;
+    }
+    RemoveObsoleteKeys(locMod);
+    RecordAndExecute(locMod);
+    hNew.clear();
+    locMod->UpdateHeap(hNew,this->pp);
+    for(size_t i=0;i<hNew.size();++i)
+      PushHeap(hNew[i]);
+  }
+
+  HeapElem PopHeap()
+  {
+    if(!UseIndexedHeap)
+    {
+      std::pop_heap(h.begin(),h.end());
+      HeapElem he=h.back();
+      h.pop_back();
+      return he;
+    }
+    HeapElem he=h.front();
+    const int slot=hSlot.front();
+    EraseKey(slotKey[slot]);
+    freeSlots.push_back(slot);
+    RemoveAt(0);
+    return he;
+  }
+
+  /// Insert an operation in the heap; in the indexed heap it replaces (and deletes) the one with the same key.
+  void PushHeap(const HeapElem &he)
+  {
+    if(!UseIndexedHeap)
+    {
+      h.push_back(he);
+      std::push_heap(h.begin(),h.end());
+      return;
+    }
+    HeapKeyType k;
+    const bool hasKey = he.locModPtr->HeapKey(k,this->pp);
+    assert(hasKey); (void)hasKey;
+    int slot=FindKey(k);
+    if(slot>=0)
+    {
+      const size_t i=slotPos[slot];
+      delete h[i].locModPtr;
+      h[i]=he;
+      SiftDown(SiftUp(i));
+      return;
+    }
+    if(freeSlots.empty())
+    {
+      slot=int(slotKey.size());
+      slotKey.push_back(k);
+      slotPos.push_back(0);
+    }
+    else
+    {
+      slot=freeSlots.back();
+      freeSlots.pop_back();
+      slotKey[slot]=k;
+    }
+    KeyList(k.first).push_back(std::make_pair(k.second,slot));
+    h.push_back(he);
+    hSlot.push_back(slot);
+    SiftUp(h.size()-1);
+  }
+
+  /// Remove from the indexed heap the operations that the execution of locMod makes impossible
+  void RemoveObsoleteKeys(LocModType *locMod)
+  {
+    obsoleteKeys.clear();
+    locMod->ObsoleteKeys(obsoleteKeys,this->pp);
+    for(size_t i=0;i<obsoleteKeys.size();++i)
+    {
+      const int slot=EraseKey(obsoleteKeys[i]);
+      if(slot<0) continue;
+      const size_t pos=slotPos[slot];
+      delete h[pos].locModPtr;
+      freeSlots.push_back(slot);
+      RemoveAt(pos);
+    }
+  }
+
+  /// Build the index of the heap from scratch, keeping only the last operation for each key.
+  /// If an operation has no key the indexed heap is disabled.
+  void BuildIndex()
+  {
+    slotKey.clear(); slotPos.clear(); freeSlots.clear(); hSlot.clear();
+    keySlot.clear();
+    keySlot.resize(m.vert.size());
+    HeapKeyType k;
+    for(size_t i=0;i<h.size();++i)
+      if(!h[i].locModPtr->HeapKey(k,this->pp))
+      {
+        UseIndexedHeap=false;
+        keySlot.clear();
+        std::make_heap(h.begin(),h.end());
+        return;
+      }
+    size_t n=0;
+    for(size_t i=0;i<h.size();++i)
+    {
+      h[i].locModPtr->HeapKey(k,this->pp);
+      const int slot=FindKey(k);
+      if(slot<0)
+      {
+        h[n]=h[i];
+        hSlot.push_back(int(n));
+        slotKey.push_back(k);
+        slotPos.push_back(n);
+        KeyList(k.first).push_back(std::make_pair(k.second,int(n)));
+        ++n;
+      }
+      else
+      {
+        delete h[slotPos[slot]].locModPtr;
+        h[slotPos[slot]]=h[i];
+      }
+    }
+    h.resize(n);
+    for(size_t i=n/2;i-->0;)
+      SiftDown(i);
+  }
+
+  void RemoveAt(size_t i)
+  {
+    const size_t last=h.size()-1;
+    if(i!=last)
+    {
+      h[i]=h[last];
+      hSlot[i]=hSlot[last];
+    }
+    h.pop_back();
+    hSlot.pop_back();
+    if(i<h.size()) SiftDown(SiftUp(i));
+  }
+
+  size_t SiftUp(size_t i)
+  {
+    const HeapElem he=h[i];
+    const int slot=hSlot[i];
+    while(i>0)
+    {
+      const size_t p=(i-1)/2;
+      if(!(h[p]<he)) break;
+      h[i]=h[p]; hSlot[i]=hSlot[p]; slotPos[hSlot[i]]=i;
+      i=p;
+    }
+    h[i]=he; hSlot[i]=slot; slotPos[slot]=i;
+    return i;
+  }
+
+  void SiftDown(size_t i)
+  {
+    const size_t n=h.size();
+    const HeapElem he=h[i];
+    const int slot=hSlot[i];
+    for(;;)
+    {
+      size_t c=2*i+1;
+      if(c>=n) break;
+      if(c+1<n && h[c]<h[c+1]) ++c;
+      if(!(he<h[c])) break;
+      h[i]=h[c]; hSlot[i]=hSlot[c]; slotPos[hSlot[i]]=i;
+      i=c;
+    }
+    h[i]=he; hSlot[i]=slot; slotPos[slot]=i;
+  }
+
 };//end class decimation
 
 }//end namespace
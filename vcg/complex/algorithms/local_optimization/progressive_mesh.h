@@ -0,0 +1,340 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+
+#ifndef __VCG_PROGRESSIVE_MESH
+#define __VCG_PROGRESSIVE_MESH
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <vcg/complex/complex.h>
+
+namespace vcg{
+namespace tri{
+
+/** \addtogroup trimesh */
+/*@{*/
+/// Records the edge collapses performed by a LocalOptimization and saves them as a progressive mesh:
+/// the simplified (base) mesh followed by the vertex splits that undo the collapses, from the last one to the first one.
+/**
+  Set LocalOptimization::Recorder to a ProgressiveMesh started on the mesh before decimating it and call Save()
+  when done, before the mesh containers are compacted or reallocated (elements are identified by their index).
+  Each vertex split is a compact record: the position of the split vertex, the position of the new one,
+  the faces that get back the new vertex and the faces to be added. The file can be read incrementally
+  with ProgressiveMeshReader to get the mesh at any face budget between the base one and the original one.
+
+  The vertices are stored in the file in the order in which they appear while refining (the base vertices first,
+  then one for each split) and the same holds for the faces. Positions are stored as float.
+*/
+template <class MeshType>
+class ProgressiveMesh
+{
+public:
+  typedef typename MeshType::VertexType     VertexType;
+  typedef typename MeshType::VertexPointer  VertexPointer;
+  typedef typename MeshType::FaceType       FaceType;
+  typedef typename MeshType::FacePointer    FacePointer;
+
+  ProgressiveMesh() : mp(0), valid(false) {}
+
+  /// Start recording the modifications of m; the previous records are discarded
+  void Start(MeshType &m)
+  {
+    mp=&m;
+    valid=true;
+    coll.clear();
+    data.clear();
+  }
+
+  /// False if an operation that cannot be recorded has been executed (or if Start() has not been called)
+  bool IsValid() const { return valid; }
+  void Invalidate() { valid=false; }
+
+  int SplitNum() const { return int(coll.size()); }
+
+  /// Record the collapse of v0 onto v1: v0 is removed, v1 survives and the faces incident on both are deleted.
+  /// It must be called just before the collapse is performed.
+  void AddCollapse(VertexPointer v0, VertexPointer v1)
+  {
+    if(!valid) return;
+    Collapse c;
+    c.vs = (unsigned int)(tri::Index(*mp,v1));
+    c.vt = (unsigned int)(tri::Index(*mp,v0));
+    for(int i=0;i<3;++i)
+    {
+      c.ps[i]=float(v1->cP()[i]);
+      c.pt[i]=float(v0->cP()[i]);
+    }
+    c.data=data.size();
+    c.removedNum=0;
+    c.changedNum=0;
+    // removed faces first: face index and vertex indices
+    for(face::VFIterator<FaceType> x(v0); !x.End(); ++x)
+      if(x.V1()==v1 || x.V2()==v1)
+      {
+        data.push_back((unsigned int)(tri::Index(*mp,x.F())));
+        for(int j=0;j<3;++j)
+          data.push_back((unsigned int)(tri::Index(*mp,x.F()->V(j))));
+        ++c.removedNum;
+      }
+    // then the faces that are moved from v0 to v1, with the index of v0 in the face
+    for(face::VFIterator<FaceType> x(v0); !x.End(); ++x)
+      if(x.V1()!=v1 && x.V2()!=v1)
+      {
+        data.push_back((unsigned int)(tri::Index(*mp,x.F())*4 + x.I()));
+        ++c.changedNum;
+      }
+    if(c.removedNum>0xffff || c.changedNum>0xffff || mp->face.size()>=(size_t(1)<<30))
+      valid=false;
+    coll.push_back(c);
+  }
+
+  /// Save the current mesh as base mesh and the recorded collapses as vertex splits. Return false in case of error.
+  bool Save(const char *filename) const
+  {
+    if(!valid) return false;
+    const MeshType &m=*mp;
+    const unsigned int none=~0u;
+    std::vector<unsigned int> vMap(m.vert.size(),none), fMap(m.face.size(),none);
+    unsigned int vn=0, fn=0;
+    for(size_t i=0;i<m.vert.size();++i)
+      if(!m.vert[i].IsD()) vMap[i]=vn++;
+    for(size_t i=0;i<m.face.size();++i)
+      if(!m.face[i].IsD()) fMap[i]=fn++;
+    const unsigned int baseVn=vn, baseFn=fn;
+    for(size_t k=coll.size();k-->0;)
+    {
+      vMap[coll[k].vt]=vn++;
+      for(int j=0;j<coll[k].removedNum;++j)
+        fMap[data[coll[k].data+4*j]]=fn++;
+    }
+
+    FILE *fp=fopen(filename,"wb");
+    if(!fp) return false;
+    Header h;
+    memcpy(h.magic,"VCGPM01",8);
+    h.endianTag=0x01020304;
+    h.baseVn=baseVn; h.baseFn=baseFn; h.splitNum=(unsigned int)(coll.size());
+    h.totalVn=vn; h.totalFn=fn;
+    bool ok = fwrite(&h,sizeof(Header),1,fp)==1;
+
+    for(size_t i=0;i<m.vert.size() && ok;++i)
+      if(!m.vert[i].IsD())
+      {
+        const float p[3]={float(m.vert[i].cP()[0]),float(m.vert[i].cP()[1]),float(m.vert[i].cP()[2])};
+        ok = fwrite(p,sizeof(float),3,fp)==3;
+      }
+    for(size_t i=0;i<m.face.size() && ok;++i)
+      if(!m.face[i].IsD())
+      {
+        unsigned int f[3];
+        for(int j=0;j<3;++j) f[j]=vMap[tri::Index(m,m.face[i].cV(j))];
+        ok = fwrite(f,sizeof(unsigned int),3,fp)==3;
+      }
+
+    std::vector<unsigned int> rec;
+    for(size_t k=coll.size();k-->0 && ok;)
+    {
+      const Collapse &c=coll[k];
+      SplitHeader sh;
+      sh.vs=vMap[c.vs];
+      for(int i=0;i<3;++i) { sh.ps[i]=c.ps[i]; sh.pt[i]=c.pt[i]; }
+      sh.removedNum=(unsigned short)(c.removedNum);
+      sh.changedNum=(unsigned short)(c.changedNum);
+      rec.clear();
+      const unsigned int *d=&data[c.data];
+      for(int j=0;j<c.removedNum;++j,d+=4)
+        for(int i=1;i<4;++i) rec.push_back(vMap[d[i]]);
+      for(int j=0;j<c.changedNum;++j,++d)
+        rec.push_back(fMap[d[0]/4]*4 + d[0]%4);
+      ok = fwrite(&sh,sizeof(SplitHeader),1,fp)==1 &&
+           (rec.empty() || fwrite(&rec[0],sizeof(unsigned int),rec.size(),fp)==rec.size());
+    }
+    fclose(fp);
+    return ok;
+  }
+
+  /// File header, written in the native byte order (endianTag tells it)
+  struct Header
+  {
+    char magic[8];
+    unsigned int endianTag;
+    unsigned int baseVn, baseFn;
+    unsigned int splitNum;
+    unsigned int totalVn, totalFn;
+  };
+  /// A vertex split record; it is followed by removedNum vertex triples (the faces to be added)
+  /// and by changedNum face references (face index * 4 + index in the face of the new vertex)
+  struct SplitHeader
+  {
+    unsigned int vs;
+    float ps[3];
+    float pt[3];
+    unsigned short removedNum;
+    unsigned short changedNum;
+  };
+
+private:
+  struct Collapse
+  {
+    unsigned int vs, vt;
+    float ps[3], pt[3];
+    size_t data;
+    int removedNum, changedNum;
+  };
+
+  MeshType *mp;
+  bool valid;
+  std::vector<Collapse> coll;
+  std::vector<unsigned int> data;
+};
+
+/// Incremental reader of a progressive mesh saved by ProgressiveMesh::Save().
+/**
+  Open() loads the base mesh, then each call of Refine() applies the following vertex splits until the
+  required number of faces is reached, so a mesh can be refined progressively while the file is read
+  (e.g. downloaded). The mesh must only have the vertex references of the faces; it is not changed elsewhere
+  between the calls and its containers are reserved for the full mesh, so no reallocation happens.
+
+\code
+tri::ProgressiveMeshReader<MyMesh> pmr;
+pmr.Open(m,"bunny.pm");
+pmr.Refine(m,10000);
+\endcode
+*/
+template <class MeshType>
+class ProgressiveMeshReader
+{
+public:
+  typedef typename MeshType::CoordType      CoordType;
+  typedef typename MeshType::ScalarType     ScalarType;
+  typedef typename MeshType::VertexIterator VertexIterator;
+  typedef typename MeshType::FaceIterator   FaceIterator;
+  typedef typename ProgressiveMesh<MeshType>::Header      Header;
+  typedef typename ProgressiveMesh<MeshType>::SplitHeader SplitHeader;
+
+  ProgressiveMeshReader() : fp(0), splitRead(0) {}
+  ~ProgressiveMeshReader() { Close(); }
+
+  /// Load in m the base mesh of the progressive mesh filename. Return false in case of error.
+  bool Open(MeshType &m, const char *filename)
+  {
+    Close();
+    m.Clear();
+    fp=fopen(filename,"rb");
+    if(!fp) return false;
+    if(fread(&h,sizeof(Header),1,fp)!=1 || strncmp(h.magic,"VCGPM01",8)!=0 || h.endianTag!=0x01020304 ||
+       h.baseVn>h.totalVn || h.baseFn>h.totalFn || h.totalVn-h.baseVn!=h.splitNum)
+    {
+      Close();
+      return false;
+    }
+    splitRead=0;
+    m.vert.reserve(h.totalVn);
+    m.face.reserve(h.totalFn);
+    if(h.baseVn>0)
+    {
+      VertexIterator vi=Allocator<MeshType>::AddVertices(m,h.baseVn);
+      for(unsigned int i=0;i<h.baseVn;++i,++vi)
+      {
+        float p[3];
+        if(fread(p,sizeof(float),3,fp)!=3) { Close(); return false; }
+        (*vi).P()=CoordType(ScalarType(p[0]),ScalarType(p[1]),ScalarType(p[2]));
+      }
+    }
+    if(h.baseFn>0)
+    {
+      FaceIterator fi=Allocator<MeshType>::AddFaces(m,h.baseFn);
+      for(unsigned int i=0;i<h.baseFn;++i,++fi)
+      {
+        unsigned int f[3];
+        if(fread(f,sizeof(unsigned int),3,fp)!=3 || f[0]>=h.baseVn || f[1]>=h.baseVn || f[2]>=h.baseVn) { Close(); return false; }
+        for(int j=0;j<3;++j) (*fi).V(j)=&m.vert[f[j]];
+      }
+    }
+    return true;
+  }
+
+  /// Apply the vertex splits until the mesh has at least targetFaceNum faces or the file ends.
+  /// Return the number of splits applied, -1 in case of error.
+  int Refine(MeshType &m, int targetFaceNum)
+  {
+    if(!fp) return -1;
+    int cnt=0;
+    std::vector<unsigned int> rec;
+    while(m.fn<targetFaceNum && splitRead<h.splitNum)
+    {
+      SplitHeader sh;
+      if(fread(&sh,sizeof(SplitHeader),1,fp)!=1) return -1;
+      rec.resize(3*sh.removedNum+sh.changedNum);
+      if(!rec.empty() && fread(&rec[0],sizeof(unsigned int),rec.size(),fp)!=rec.size()) return -1;
+      // each split adds one vertex; the sizes cannot exceed the reserved ones
+      if(sh.vs>=m.vert.size() || m.vert.size()>=h.totalVn || m.face.size()+sh.removedNum>h.totalFn) return -1;
+
+      VertexIterator vt=Allocator<MeshType>::AddVertices(m,1);
+      (*vt).P()=CoordType(ScalarType(sh.pt[0]),ScalarType(sh.pt[1]),ScalarType(sh.pt[2]));
+      m.vert[sh.vs].P()=CoordType(ScalarType(sh.ps[0]),ScalarType(sh.ps[1]),ScalarType(sh.ps[2]));
+      for(int j=0;j<sh.changedNum;++j)
+      {
+        const unsigned int fc=rec[3*sh.removedNum+j];
+        if(fc/4>=m.face.size() || fc%4>=3) return -1;
+        m.face[fc/4].V(fc%4)=&*vt;
+      }
+      if(sh.removedNum>0)
+      {
+        FaceIterator fi=Allocator<MeshType>::AddFaces(m,sh.removedNum);
+        for(int j=0;j<sh.removedNum;++j,++fi)
+          for(int k=0;k<3;++k)
+          {
+            if(rec[3*j+k]>=m.vert.size()) return -1;
+            (*fi).V(k)=&m.vert[rec[3*j+k]];
+          }
+      }
+      ++splitRead;
+      ++cnt;
+    }
+    return cnt;
+  }
+
+  void Close()
+  {
+    if(fp) fclose(fp);
+    fp=0;
+  }
+
+  bool IsOpen() const { return fp!=0; }
+  /// Number of splits not applied yet
+  int SplitLeft() const { return fp ? int(h.splitNum-splitRead) : 0; }
+  int FullVertexNum() const { return fp ? int(h.totalVn) : 0; }
+  int FullFaceNum() const { return fp ? int(h.totalFn) : 0; }
+
+private:
+  FILE *fp;
+  Header h;
+  unsigned int splitRead;
+};
+/*@}*/
+
+} // end namespace tri
+} // end namespace vcg
+#endif
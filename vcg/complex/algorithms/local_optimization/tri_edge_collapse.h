@@ -73,6 +73,7 @@ protected:
   typedef	typename TriMeshType::VertexType::ScalarType ScalarType;
   typedef typename LocalOptimization<TriMeshType>::HeapElem HeapElem;
   typedef typename LocalOptimization<TriMeshType>::HeapType HeapType;
+  typedef typename LocalOptimization<TriMeshType>::HeapKeyType HeapKeyType;
 
   TriMeshType *mt;
   ///the pair to collapse
@@ -81,6 +82,17 @@ protected:
   ///mark for up_dating
   static int& GlobalMark(){ static int im=0; return im;}
 
+  /// Increment the global mark and return its new value. The increment is atomic because
+  /// UpdateHeap() can be called concurrently by LocalOptimization::DoOptimizationParallel().
+  static int NextGlobalMark()
+  {
+    int &gm = GlobalMark();
+    int mark;
+#pragma omp atomic capture
+    mark = ++gm;
+    return mark;
+  }
+
   ///mark for up_dating
   int localMark;
 
@@ -131,6 +143,42 @@ public:
 
   static bool IsSymmetric(BaseParameterClass *) { return true;}
 
+  /// Key for the indexed heap of LocalOptimization: the edge, as an unordered pair of vertices when the collapse is symmetric.
+  static HeapKeyType EdgeKey(VertexType *v0, VertexType *v1, BaseParameterClass *pp)
+  {
+    if(MYTYPE::IsSymmetric(pp) && v1<v0) std::swap(v0,v1);
+    return HeapKeyType(v0,v1);
+  }
+
+  bool HeapKey(HeapKeyType &key, BaseParameterClass *pp) const
+  {
+    key = EdgeKey(pos.cV(0),pos.cV(1),pp);
+    return true;
+  }
+
+  /// The collapse removes pos.V(0): the collapses of all its edges (in both directions) become impossible.
+  void ObsoleteKeys(std::vector<HeapKeyType> &keys, BaseParameterClass *pp)
+  {
+    VertexType *v0=pos.V(0);
+    for(vcg::face::VFIterator<FaceType> vfi(v0); !vfi.End(); ++vfi)
+    {
+      keys.push_back(EdgeKey(v0,vfi.V1(),pp));
+      keys.push_back(EdgeKey(v0,vfi.V2(),pp));
+      if(!MYTYPE::IsSymmetric(pp))
+      {
+        keys.push_back(EdgeKey(vfi.V1(),v0,pp));
+        keys.push_back(EdgeKey(vfi.V2(),v0,pp));
+      }
+    }
+  }
+
+  /// The collapse is recorded as the vertex split that restores pos.V(0).
+  bool Record(ProgressiveMesh<TriMeshType> &pm, BaseParameterClass *)
+  {
+    pm.AddCollapse(pos.V(0),pos.V(1));
+    return true;
+  }
+
   // This function is called after an action to re-add in the heap elements whose priority could have been changed.
   // in the plain case we just put again in the heap all the edges around the vertex resulting from the previous collapse: v[1].
   // if the collapse is not symmetric you should add also backward edges (because v0->v1 collapse could be different from v1->v0)
@@ -29,6 +29,9 @@
 #include<vcg/complex/algorithms/local_optimization/tri_edge_collapse.h>
 #include<vcg/complex/algorithms/local_optimization.h>
 #include<vcg/complex/algorithms/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 namespace vcg{
@@ -106,6 +109,7 @@ public:
   bool      ScaleIndependent=true;
   bool      UseArea =true;
   bool      UseVertexWeight=false;  
+  bool      PresetQuadric=false;  // The per vertex quadrics are already set (e.g. carried over from a previous simplification) and Init() does not compute them.
 
   TriEdgeCollapseQuadricParameter() {}
 };
@@ -165,8 +169,8 @@ public:
     {
       if((QH::Qd(this->pos.V(0)).Apply(newPos) + QH::Qd(this->pos.V(1)).Apply(newPos)) > 2.0*pp->QuadricEpsilon)              
       {
-        QuadricType q=QH::Qd(this->pos.V(0));
-        q+=QH::Qd(this->pos.V(1));
+        QuadricType q;
+        q.SetSum(QH::Qd(this->pos.V(0)),QH::Qd(this->pos.V(1)));
         
         Point3<QuadricType::ScalarType> x;
         if(pp->SVDPlacement)
@@ -239,7 +243,8 @@ public:
             }
     }
     
-    InitQuadric(m,pp);
+    if(!pp->PresetQuadric)
+      InitQuadric(m,pp);
     
     // Initialize the heap with all the possible collapses
     if(IsSymmetric(pp))
@@ -378,8 +383,8 @@ public:
           newArea += DoubleArea(*x.F());
     }         
     
-    QuadricType qq=QH::Qd(v[0]);
-    qq+=QH::Qd(v[1]);
+    QuadricType qq;
+    qq.SetSum(QH::Qd(v[0]),QH::Qd(v[1]));
 
     double QuadErr = pp->ScaleFactor*qq.Apply(Point3d::Construct(v[1]->P()));
     
@@ -498,10 +503,15 @@ public:
   
   
   inline void AddCollapseToHeap(HeapType & h_ret, VertexType *v0, VertexType *v1, BaseParameterClass *_pp)
+  {
+    AddCollapseToHeap(h_ret,v0,v1,_pp,this->GlobalMark());
+  }
+
+  inline void AddCollapseToHeap(HeapType & h_ret, VertexType *v0, VertexType *v1, BaseParameterClass *_pp, int mark)
   {
     QParameter *pp=(QParameter *)_pp;    
     ScalarType maxAdmitErr = std::numeric_limits<ScalarType>::max();
-    h_ret.push_back(HeapElem(new MYTYPE(VertexPair(v0,v1), this->GlobalMark(),_pp)));
+    h_ret.push_back(HeapElem(new MYTYPE(VertexPair(v0,v1), mark,_pp)));
     if(h_ret.back().pri > maxAdmitErr) {
       delete h_ret.back().locModPtr;
       h_ret.pop_back(); 
@@ -510,7 +520,7 @@ public:
       std::push_heap(h_ret.begin(),h_ret.end());
     
     if(!IsSymmetric(pp)){
-      h_ret.push_back(HeapElem(new MYTYPE(VertexPair(v1,v0), this->GlobalMark(),_pp)));
+      h_ret.push_back(HeapElem(new MYTYPE(VertexPair(v1,v0), mark,_pp)));
       if(h_ret.back().pri > maxAdmitErr) {
         delete h_ret.back().locModPtr;
         h_ret.pop_back(); 
@@ -522,18 +532,18 @@ public:
   
   inline  void UpdateHeap(HeapType & h_ret, BaseParameterClass *_pp)
   {
-    this->GlobalMark()++;
+    const int mark = this->NextGlobalMark();
     VertexType *v[2];
     v[0]= this->pos.V(0);
     v[1]= this->pos.V(1);
-    v[1]->IMark() = this->GlobalMark();
+    v[1]->IMark() = mark;
 
     // First loop around the surviving vertex to unmark the Visit flags
     for(VFIterator vfi(v[1]); !vfi.End(); ++vfi ) {
       vfi.V1()->ClearV();
       vfi.V2()->ClearV();
-      vfi.V1()->IMark() = this->GlobalMark();
-      vfi.V2()->IMark() = this->GlobalMark();      
+      vfi.V1()->IMark() = mark;
+      vfi.V2()->IMark() = mark;
     }
 
     // Second Loop
@@ -541,61 +551,164 @@ public:
       if( !(vfi.V1()->IsV()) && vfi.V1()->IsRW())
       {
         vfi.V1()->SetV();
-        AddCollapseToHeap(h_ret,vfi.V0(),vfi.V1(),_pp);
+        AddCollapseToHeap(h_ret,vfi.V0(),vfi.V1(),_pp,mark);
       }
       if(  !(vfi.V2()->IsV()) && vfi.V2()->IsRW())
       {
         vfi.V2()->SetV();
-        AddCollapseToHeap(h_ret,vfi.V2(),vfi.V0(),_pp);
+        AddCollapseToHeap(h_ret,vfi.V2(),vfi.V0(),_pp,mark);
       }
       if(vfi.V1()->IsRW() && vfi.V2()->IsRW() )
-        AddCollapseToHeap(h_ret,vfi.V1(),vfi.V2(),_pp);
+        AddCollapseToHeap(h_ret,vfi.V1(),vfi.V2(),_pp,mark);
     } // end second loop around surviving vertex.
   }
 
-  static void InitQuadric(TriMeshType &m,BaseParameterClass *_pp)
+  /// Region for LocalOptimization::DoOptimizationParallel(): the collapse changes the faces around the two
+  /// vertices of the edge and UpdateHeap() evaluates the collapses of the edges of the resulting one-ring,
+  /// so the write set is the one-ring of the edge and the read set the one-ring of the write set.
+  bool ParallelRegion(std::vector<typename TriMeshType::VertexPointer> &writeSet, std::vector<typename TriMeshType::VertexPointer> &readSet)
   {
-    QParameter *pp=(QParameter *)_pp;
-    QH::Init();
-    for(VertexIterator pv=m.vert.begin();pv!=m.vert.end();++pv)
-      if( ! (*pv).IsD() && (*pv).IsW())
-        QH::Qd(*pv).SetZero();    
+    for(int i=0;i<2;++i)
+    {
+      writeSet.push_back(this->pos.V(i));
+      for(VFIterator x(this->pos.V(i)); !x.End(); ++x )
+      {
+        writeSet.push_back(x.V1());
+        writeSet.push_back(x.V2());
+      }
+    }
+    std::sort(writeSet.begin(),writeSet.end());
+    writeSet.erase(std::unique(writeSet.begin(),writeSet.end()),writeSet.end());
+    for(size_t i=0;i<writeSet.size();++i)
+      for(VFIterator x(writeSet[i]); !x.End(); ++x )
+      {
+        readSet.push_back(x.V1());
+        readSet.push_back(x.V2());
+      }
+    return true;
+  }
+
+  static void FacePlane(const FaceType &f, QParameter *pp, Plane3<ScalarType,false> &facePlane)
+  {
+    facePlane.SetDirection( ( f.cV(1)->cP() - f.cV(0)->cP() ) ^  ( f.cV(2)->cP() - f.cV(0)->cP() ));
+    if(!pp->UseArea)
+      facePlane.Normalize();
+    facePlane.SetOffset( facePlane.Direction().dot(f.cV(0)->cP()));                   
+  }
+  
+  static void EdgeQuadric(const FaceType &f, int j, const Plane3<ScalarType,false> &facePlane, QParameter *pp, QuadricType &bq)
+  {
+    Plane3<ScalarType,false> borderPlane; 
+    // Border quadric record the squared distance from the plane orthogonal to the face and passing 
+    // through the edge. 
+    borderPlane.SetDirection(facePlane.Direction() ^ (( f.cV1(j)->cP() - f.cV(j)->cP() ).normalized()));
+    if(  f.IsB(j) ) borderPlane.SetDirection(borderPlane.Direction()* (ScalarType)(pp->BoundaryQuadricWeight ));        // amplify border planes
+    else            borderPlane.SetDirection(borderPlane.Direction()* (ScalarType)(pp->QualityQuadricWeight ));   // and consider much less quadric for quality
+    borderPlane.SetOffset(borderPlane.Direction().dot(f.cV(j)->cP()));
+    bq.ByPlane(borderPlane);
+  }
+  
+  static void InitQuadricParallel(TriMeshType &m, QParameter *pp)
+  {
+    const int fn = int(m.face.size());
+    std::vector<Plane3<ScalarType,false> > facePlane(fn);
+    std::vector<char> faceUsed(fn);
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<fn;++i)
+    {
+      const FaceType &f = m.face[i];
+      faceUsed[i] = !f.IsD() && f.IsR() && f.cV(0)->IsR() && f.cV(1)->IsR() && f.cV(2)->IsR();
+      if(faceUsed[i]) FacePlane(f,pp,facePlane[i]);
+    }
     
-    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-      if( !(*fi).IsD() && (*fi).IsR() )
-        if((*fi).V(0)->IsR() &&(*fi).V(1)->IsR() &&(*fi).V(2)->IsR())
+    const int vn = int(m.vert.size());
+#pragma omp parallel
+    {
+      std::vector<std::pair<int,int> > ring; // (face index, index of the vertex in the face)
+#pragma omp for schedule(static)
+      for(int i=0;i<vn;++i)
+      {
+        VertexType &v = m.vert[i];
+        if(v.IsD() || !v.IsW()) continue;
+        ring.clear();
+        for(VFIterator x(&v); !x.End(); ++x)
+          ring.push_back(std::make_pair(int(tri::Index(m,x.F())),x.I()));
+        std::sort(ring.begin(),ring.end());
+        
+        QuadricType &qv = QH::Qd(v);
+        qv.SetZero();
+        for(size_t k=0;k<ring.size();++k)
         {
-          Plane3<ScalarType,false> facePlane;
-          facePlane.SetDirection( ( (*fi).V(1)->cP() - (*fi).V(0)->cP() ) ^  ( (*fi).V(2)->cP() - (*fi).V(0)->cP() ));
-          if(!pp->UseArea)
-            facePlane.Normalize();
-          facePlane.SetOffset( facePlane.Direction().dot((*fi).V(0)->cP()));                   
-
+          const int fi = ring[k].first;
+          if(!faceUsed[fi]) continue;
+          const FaceType &f = m.face[fi];
           QuadricType q;
-          q.ByPlane(facePlane);          
-          
-          // The basic < add face quadric to each vertex > loop
-          for(int j=0;j<3;++j)
-            if( (*fi).V(j)->IsW() )
-              QH::Qd((*fi).V(j)) += q;
+          q.ByPlane(facePlane[fi]);
+          qv += q;
           
-          for(int j=0;j<3;++j)
-            if( (*fi).IsB(j) || pp->QualityQuadric )
+          // the two edges of the face incident on v, in the order of the serial loop
+          const int z = ring[k].second;
+          const int ej[2] = { std::min(z,(z+2)%3), std::max(z,(z+2)%3) };
+          for(int h=0;h<2;++h)
+            if( f.IsB(ej[h]) || pp->QualityQuadric )
             {
-              Plane3<ScalarType,false> borderPlane; 
               QuadricType bq;
-              // Border quadric record the squared distance from the plane orthogonal to the face and passing 
-              // through the edge. 
-              borderPlane.SetDirection(facePlane.Direction() ^ (( (*fi).V1(j)->cP() - (*fi).V(j)->cP() ).normalized()));
-              if(  (*fi).IsB(j) ) borderPlane.SetDirection(borderPlane.Direction()* (ScalarType)(pp->BoundaryQuadricWeight ));        // amplify border planes
-              else                borderPlane.SetDirection(borderPlane.Direction()* (ScalarType)(pp->QualityQuadricWeight ));   // and consider much less quadric for quality
-              borderPlane.SetOffset(borderPlane.Direction().dot((*fi).V(j)->cP()));
-              bq.ByPlane(borderPlane);
-              
-              if( (*fi).V (j)->IsW() )	QH::Qd((*fi).V (j)) += bq;
-              if( (*fi).V1(j)->IsW() )	QH::Qd((*fi).V1(j)) += bq;
+              EdgeQuadric(f,ej[h],facePlane[fi],pp,bq);
+              qv += bq;
             }
         }
+      }
+    }
+  }
+  
+  /// Compute the per vertex quadrics of the writable vertices.
+  /// With more than one thread the face planes are computed in parallel and then each vertex gathers
+  /// the quadrics of its incident faces in face index order, so that the sums are the same of the
+  /// serial loop over the faces used with a single thread.
+  static void InitQuadric(TriMeshType &m,BaseParameterClass *_pp)
+  {
+    QParameter *pp=(QParameter *)_pp;
+    QH::Init();
+    
+    int threadNum=1;
+#ifdef _OPENMP
+    threadNum=omp_get_max_threads();
+#endif
+    if(threadNum>1 && HasVFAdjacency(m))
+    {
+      InitQuadricParallel(m,pp);
+    }
+    else
+    {
+      for(VertexIterator pv=m.vert.begin();pv!=m.vert.end();++pv)
+        if( ! (*pv).IsD() && (*pv).IsW())
+          QH::Qd(*pv).SetZero();    
+      
+      for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+        if( !(*fi).IsD() && (*fi).IsR() )
+          if((*fi).V(0)->IsR() &&(*fi).V(1)->IsR() &&(*fi).V(2)->IsR())
+          {
+            Plane3<ScalarType,false> facePlane;
+            FacePlane(*fi,pp,facePlane);
+            
+            QuadricType q;
+            q.ByPlane(facePlane);          
+            
+            // The basic < add face quadric to each vertex > loop
+            for(int j=0;j<3;++j)
+              if( (*fi).V(j)->IsW() )
+                QH::Qd((*fi).V(j)) += q;
+            
+            for(int j=0;j<3;++j)
+              if( (*fi).IsB(j) || pp->QualityQuadric )
+              {
+                QuadricType bq;
+                EdgeQuadric(*fi,j,facePlane,pp,bq);
+                if( (*fi).V (j)->IsW() )	QH::Qd((*fi).V (j)) += bq;
+                if( (*fi).V1(j)->IsW() )	QH::Qd((*fi).V1(j)) += bq;
+              }
+          }
+    }
     
     if(pp->ScaleIndependent)
     {
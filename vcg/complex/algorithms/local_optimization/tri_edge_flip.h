@@ -271,6 +271,8 @@ public:
         FacePointer f2 = _pos.F()->FFp(i);
 
         vcg::face::FlipEdge(*_pos.F(), _pos.E());
+        tri::Allocator<TRIMESH_TYPE>::MarkDirtyFace(m,*f1);
+        tri::Allocator<TRIMESH_TYPE>::MarkDirtyFace(m,*f2);
 
         // avoid texture coordinates swap after flip
         if(tri::HasPerWedgeTexCoord(m)) {
@@ -511,6 +513,8 @@ public:
 
         // do the flip
         vcg::face::FlipEdge(*this->_pos.F(), this->_pos.E());
+        tri::Allocator<TRIMESH_TYPE>::MarkDirtyFace(m,*f1);
+        tri::Allocator<TRIMESH_TYPE>::MarkDirtyFace(m,*f2);
 
         // avoid texture coordinates swap after flip
         if (tri::HasPerWedgeTexCoord(m)) {
@@ -0,0 +1,370 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+#ifndef __VCGLIB_MESH_OPERATOR_CACHE
+#define __VCGLIB_MESH_OPERATOR_CACHE
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <vcg/complex/complex.h>
+
+namespace vcg {
+namespace tri {
+
+/** \brief Cache of the discrete differential operators of a mesh and of the sparse factorizations built on them.
+
+ It keeps a set of sparse operators (e.g. the cotangent Laplacian of Harmonic, the Laplacian of MeshToMatrix,
+ the matrices of GeodesicHeat), the per-vertex areas and a set of LDLT factorizations.
+ Operators and factorizations are identified by a key that encodes what they are, are built by the caller
+ the first time they are requested, and are stored separately for float and double coefficients,
+ so each solver keeps its own precision.
+ Harmonic::ComputeScalarField, GeodesicHeat, ImplicitSmoother::Compute and MeshToMatrix use
+ the cache attached to the mesh with Attach(), so that repeated calls on the same mesh skip
+ assembly and factorization; without an attached cache they behave as before.
+
+ Every access checks the number of elements, and drops everything when it changes. The solvers above also
+ call Validate() once per call, that compares a checksum of the vertex positions and of the face-vertex indices
+ with the one of the previous call: a different connectivity drops everything, different positions rebuild the
+ geometric operators and redo only the numeric factorizations (the symbolic analysis is kept).
+ Who uses GetOperator() and GetFactorization() directly should do the same, or call InvalidateGeometry()
+ after moving the vertices and InvalidateTopology() after changing the connectivity.
+ */
+template <class MeshType>
+class MeshOperatorCache
+{
+public:
+    typedef typename MeshType::ScalarType ScalarType;
+    typedef typename MeshType::FaceType   FaceType;
+    typedef std::vector<double>           Key;
+
+    /// \brief What a key refers to: it is the first element of every key, the following ones are the parameters
+    /// of the operator or of the system. Every caller has its own values, so keys of different callers never collide.
+    enum KeyKind
+    {
+        HarmonicLaplacian = 0,  ///< Harmonic::CotangentLaplacian
+        HarmonicSystem,         ///< Harmonic::ComputeScalarField system
+        ImplicitSmoothSystem,   ///< ImplicitSmoother::Compute system
+        MeshToMatrixLaplacian,  ///< MeshToMatrix::GetLaplacianOperator
+        GeodesicHeatMass,       ///< GeodesicHeat mass matrix
+        GeodesicHeatCotangent,  ///< GeodesicHeat cotangent operator
+        GeodesicHeatFlow,       ///< GeodesicHeat heat flow system
+        GeodesicHeatPoisson     ///< GeodesicHeat Poisson system
+    };
+
+    /// \brief A key of the given kind, to be completed with the parameters.
+    static Key MakeKey(KeyKind kind) { return Key(1, double(kind)); }
+
+    /// \brief The matrix and factorization types for coefficients of type Scalar (float or double).
+    template <class Scalar>
+    struct Types
+    {
+        typedef Eigen::SparseMatrix<Scalar>  SpMat;
+        typedef Eigen::SimplicialLDLT<SpMat> Factorization;
+    };
+
+    MeshOperatorCache() : useCounter(0), assemblyNum(0), factorizationNum(0), maxFactorizationNum(16) { Clear(); }
+
+    /// \brief The cache attached to the mesh, or nullptr.
+    static MeshOperatorCache *Attached(MeshType &m)
+    {
+        if (m.mesh_attr.empty()) return nullptr;
+        typename std::set<PointerToAttribute>::iterator i = m.mesh_attr.FindByName(AttributeName());
+        if (i == m.mesh_attr.end() || (*i)._type != std::type_index(typeid(MeshOperatorCache))) return nullptr;
+        return (MeshOperatorCache *)((*i)._handle->DataBegin());
+    }
+
+    /// \brief Attach a cache to the mesh (if not already present) and return it.
+    static MeshOperatorCache &Attach(MeshType &m)
+    {
+        MeshOperatorCache *c = Attached(m);
+        if (c == nullptr)
+        {
+            Allocator<MeshType>::template AddPerMeshAttribute<MeshOperatorCache>(m, AttributeName());
+            c = Attached(m);
+        }
+        return *c;
+    }
+
+    /// \brief Remove the cache from the mesh, releasing its memory.
+    static void Detach(MeshType &m)
+    {
+        Allocator<MeshType>::DeletePerMeshAttribute(m, AttributeName());
+    }
+
+    static const std::string &AttributeName() { static const std::string name("__MeshOperatorCache"); return name; }
+
+    void Clear()
+    {
+        sizeValid = false;
+        areaValid = false;
+        geometrySumValid = false;
+        topologySumValid = false;
+        floatStore.Clear();
+        doubleStore.Clear();
+    }
+
+    /// \brief Drop everything: to be called after a change of the connectivity that keeps the number of elements.
+    void InvalidateTopology() { Clear(); }
+
+    /// \brief To be called after moving the vertices: the operators that depend on the positions are rebuilt
+    /// and the factorizations of the systems that depend on them are numerically refactorized on the next request.
+    void InvalidateGeometry()
+    {
+        areaValid = false;
+        geometrySumValid = false;
+        floatStore.InvalidateGeometry();
+        doubleStore.InvalidateGeometry();
+    }
+
+    /// \brief Check the mesh against the one of the previous call, and invalidate what is stale.
+    /// It costs a pass over the vertices and the faces, so it is meant to be called once per solver call,
+    /// before the operators and the factorizations are requested.
+    void Validate(const MeshType &m)
+    {
+        Update(m);
+        unsigned long long topologyCur = TopologyChecksum(m);
+        unsigned long long geometryCur = GeometryChecksum(m);
+        if (topologySumValid && topologyCur != topologySum)
+        {
+            Clear();
+            Update(m);
+        }
+        else if (geometrySumValid && geometryCur != geometrySum)
+            InvalidateGeometry();
+        topologySum = topologyCur;
+        geometrySum = geometryCur;
+        topologySumValid = geometrySumValid = true;
+    }
+
+    /// \brief The operator identified by key, built by build(SpMat &) when it is missing or stale.
+    /// geometryDependent tells if it depends on the vertex positions (and must be rebuilt by InvalidateGeometry()).
+    template <class Scalar, class MatrixBuilder>
+    const typename Types<Scalar>::SpMat &GetOperator(MeshType &m, const Key &key, bool geometryDependent, MatrixBuilder build)
+    {
+        Update(m);
+        OperatorEntry<Scalar> &e = GetStore<Scalar>().operators[key];
+        e.geometryDependent = geometryDependent;
+        if (!e.valid)
+        {
+            build(e.A);
+            e.valid = true;
+            ++assemblyNum;
+        }
+        return e.A;
+    }
+
+    /// \brief For each vertex the sum of the double areas of its incident faces (six times its barycentric area).
+    const std::vector<ScalarType> &VertexDoubleArea(MeshType &m)
+    {
+        Update(m);
+        if (!areaValid)
+        {
+            vertDoubleArea.assign(m.vert.size(), 0);
+            for (size_t i = 0; i < m.face.size(); ++i)
+            {
+                const FaceType &f = m.face[i];
+                if (f.IsD()) continue;
+                ScalarType a = DoubleArea(f);
+                for (int j = 0; j < f.VN(); ++j)
+                    vertDoubleArea[tri::Index(m, f.cV(j))] += a;
+            }
+            areaValid = true;
+            ++assemblyNum;
+        }
+        return vertDoubleArea;
+    }
+
+    /// \brief The factorization of the system identified by key.
+    /// The matrix is built by build(SpMat &) only when the factorization is missing or stale; if it depends on
+    /// the vertex positions (geometryDependent) it is numerically refactorized after InvalidateGeometry(), reusing the symbolic analysis.
+    /// Check info() of the returned object before solving.
+    template <class Scalar, class MatrixBuilder>
+    std::shared_ptr<typename Types<Scalar>::Factorization> GetFactorization(MeshType &m, const Key &key, bool geometryDependent, MatrixBuilder build)
+    {
+        typedef typename Types<Scalar>::SpMat         SpMat;
+        typedef typename Types<Scalar>::Factorization Factorization;
+        Update(m);
+        Store<Scalar> &store = GetStore<Scalar>();
+        typename Store<Scalar>::FactorizationMap::iterator fi = store.factorizations.find(key);
+        if (fi == store.factorizations.end())
+        {
+            if (store.factorizations.size() >= maxFactorizationNum) store.EvictLeastRecentlyUsed();
+            fi = store.factorizations.insert(std::make_pair(key, FactorizationEntry<Scalar>())).first;
+        }
+        FactorizationEntry<Scalar> &e = fi->second;
+        e.lastUse = ++useCounter;
+        e.geometryDependent = geometryDependent;
+        if (e.f && e.numericValid)
+            return e.f;
+
+        SpMat A;
+        build(A);
+        if (e.f && e.f->info() == Eigen::Success)
+            e.f->factorize(A);
+        else
+        {
+            e.f = std::make_shared<Factorization>();
+            e.f->compute(A);
+        }
+        e.numericValid = true;
+        ++factorizationNum;
+        return e.f;
+    }
+
+    /// \brief Number of operator assemblies and of (numeric) factorizations done so far, useful to check the reuse.
+    size_t AssemblyNum() const { return assemblyNum; }
+    size_t FactorizationNum() const { return factorizationNum; }
+    size_t FactorizationCacheSize() const { return floatStore.factorizations.size() + doubleStore.factorizations.size(); }
+    void SetMaxFactorizationNum(size_t n) { maxFactorizationNum = std::max<size_t>(n, 1); }
+
+private:
+    template <class Scalar>
+    struct OperatorEntry
+    {
+        typename Types<Scalar>::SpMat A;
+        bool valid;
+        bool geometryDependent;
+        OperatorEntry() : valid(false), geometryDependent(true) {}
+    };
+
+    template <class Scalar>
+    struct FactorizationEntry
+    {
+        std::shared_ptr<typename Types<Scalar>::Factorization> f;
+        bool numericValid;
+        bool geometryDependent;
+        size_t lastUse;
+        FactorizationEntry() : numericValid(false), geometryDependent(true), lastUse(0) {}
+    };
+
+    // the operators and the factorizations with coefficients of type Scalar
+    template <class Scalar>
+    struct Store
+    {
+        typedef std::map<Key, OperatorEntry<Scalar> >      OperatorMap;
+        typedef std::map<Key, FactorizationEntry<Scalar> > FactorizationMap;
+        OperatorMap      operators;
+        FactorizationMap factorizations;
+
+        void Clear()
+        {
+            operators.clear();
+            factorizations.clear();
+        }
+
+        void InvalidateGeometry()
+        {
+            for (typename OperatorMap::iterator oi = operators.begin(); oi != operators.end(); ++oi)
+                if (oi->second.geometryDependent) oi->second.valid = false;
+            for (typename FactorizationMap::iterator fi = factorizations.begin(); fi != factorizations.end(); ++fi)
+                if (fi->second.geometryDependent) fi->second.numericValid = false;
+        }
+
+        void EvictLeastRecentlyUsed()
+        {
+            typename FactorizationMap::iterator oldest = factorizations.begin();
+            for (typename FactorizationMap::iterator fi = factorizations.begin(); fi != factorizations.end(); ++fi)
+                if (fi->second.lastUse < oldest->second.lastUse) oldest = fi;
+            if (oldest != factorizations.end()) factorizations.erase(oldest);
+        }
+    };
+
+    Store<float>  &StoreOf(float *)  { return floatStore; }
+    Store<double> &StoreOf(double *) { return doubleStore; }
+    template <class Scalar>
+    Store<Scalar> &GetStore() { return StoreOf((Scalar *)0); }
+
+    // O(1) safety check: a change in the number of elements is surely a change of connectivity
+    void Update(const MeshType &m)
+    {
+        if (sizeValid && vertNum == m.vert.size() && faceNum == m.face.size() && vn == m.vn && fn == m.fn)
+            return;
+        Clear();
+        sizeValid = true;
+        vertNum = m.vert.size();
+        faceNum = m.face.size();
+        vn = m.vn;
+        fn = m.fn;
+    }
+
+    static void Combine(unsigned long long &h, unsigned long long x)
+    {
+        h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+
+    static unsigned long long GeometryChecksum(const MeshType &m)
+    {
+        unsigned long long h = 0;
+        for (size_t i = 0; i < m.vert.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+            {
+                double c = double(m.vert[i].cP()[k]);
+                unsigned long long bits;
+                std::memcpy(&bits, &c, sizeof(bits));
+                Combine(h, bits);
+            }
+        return h;
+    }
+
+    // the operators are indexed by the vertex indices, so the faces are hashed by them (and not by the pointers)
+    static unsigned long long TopologyChecksum(const MeshType &m)
+    {
+        unsigned long long h = 0;
+        for (size_t i = 0; i < m.vert.size(); ++i)
+            Combine(h, m.vert[i].IsD() ? 1 : 0);
+        for (size_t i = 0; i < m.face.size(); ++i)
+        {
+            const FaceType &f = m.face[i];
+            if (f.IsD()) { Combine(h, ~0ULL); continue; }
+            for (int j = 0; j < f.VN(); ++j)
+                Combine(h, tri::Index(m, f.cV(j)));
+        }
+        return h;
+    }
+
+    bool sizeValid;
+    size_t vertNum, faceNum;
+    int vn, fn;
+    unsigned long long geometrySum, topologySum;
+    bool geometrySumValid, topologySumValid;
+
+    std::vector<ScalarType> vertDoubleArea;
+    bool areaValid;
+
+    Store<float>  floatStore;
+    Store<double> doubleStore;
+    size_t useCounter;
+    size_t assemblyNum, factorizationNum, maxFactorizationNum;
+};
+
+} // end namespace tri
+} // end namespace vcg
+
+#endif // __VCGLIB_MESH_OPERATOR_CACHE
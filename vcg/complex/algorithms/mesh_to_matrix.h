@@ -27,6 +27,7 @@
 #include <vcg/complex/algorithms/update/topology.h>
 #include <vcg/complex/algorithms/update/quality.h>
 #include <vcg/complex/algorithms/harmonic.h>
+#include <vcg/complex/algorithms/mesh_operator_cache.h>
 
 namespace vcg {
 namespace tri {
@@ -274,6 +275,15 @@ public:
     {
         tri::RequireCompactness(m);
 
+        // the per vertex areas are taken from the operator cache attached to the mesh, if any
+        MeshOperatorCache<MeshType> *cache = MeshOperatorCache<MeshType>::Attached(m);
+        if(cache!=nullptr)
+        {
+            cache->Validate(m);
+            MassMatrixEntry(m,cache->VertexDoubleArea(m),index,entry,vertexCoord);
+            return;
+        }
+
         typename MeshType::template PerVertexAttributeHandle<ScalarType> h =
                 tri::Allocator<MeshType>:: template GetPerVertexAttribute<ScalarType>(m, "area");
         for(int i=0;i<m.vn;++i) h[i]=0;
@@ -284,6 +294,17 @@ public:
             for(int j=0;j<fi->VN();++j)
                 h[tri::Index(m,fi->V(j))] += a;
         }
+        MassMatrixEntry(m,h,index,entry,vertexCoord);
+        tri::Allocator<MeshType>::template DeletePerVertexAttribute<ScalarType>(m,h);
+    }
+
+    template< class AreaContainer >
+    static void MassMatrixEntry(const MeshType &m,
+                                AreaContainer &h,
+                                std::vector<std::pair<int,int> > &index,
+                                std::vector<ScalarType> &entry,
+                                bool vertexCoord)
+    {
         ScalarType maxA=0;
         for(int i=0;i<m.vn;++i)
             maxA = std::max(maxA,h[i]);
@@ -307,7 +328,6 @@ public:
                 entry.push_back(h[i]/maxA);
             }
         }
-        tri::Allocator<MeshType>::template DeletePerVertexAttribute<ScalarType>(m,h);
     }
 
 
@@ -379,12 +399,57 @@ public:
                                    ScalarType weight = 1,
                                    bool vertexCoord=true )
     {
+        // with an operator cache attached to the mesh the (already summed) entries of the cached Laplacian are returned
+        MeshOperatorCache<MeshType> *cache = MeshOperatorCache<MeshType>::Attached(mesh);
+        if (cache!=nullptr)
+        {
+            cache->Validate(mesh);
+            typedef Eigen::SparseMatrix<ScalarType> SpMat;
+            const SpMat &L = GetLaplacianOperator(*cache,mesh,cotangent,weight);
+            for (int k=0;k<L.outerSize();++k)
+                for (typename SpMat::InnerIterator it(L,k);it;++it)
+                {
+                    const int nc = vertexCoord ? 3 : 1;
+                    for (int j=0;j<nc;j++)
+                    {
+                        index.push_back(std::pair<int,int>(int(it.row())*nc+j,int(it.col())*nc+j));
+                        entry.push_back(it.value());
+                    }
+                }
+            return;
+        }
+
         //store the index and the scalar for the sparse matrix
         for (size_t i=0;i<mesh.face.size();i++)
             GetLaplacianEntry(mesh,mesh.face[i],index,entry,cotangent,weight,vertexCoord);
     }
 
-
+    /// The vn x vn Laplacian of GetLaplacianMatrix (one coordinate), with the entries of the faces summed up.
+    /// It is taken from the given operator cache, where it is assembled on the first request.
+    static const Eigen::SparseMatrix<ScalarType> &GetLaplacianOperator(MeshOperatorCache<MeshType> &cache,
+                                                                       MeshType &mesh,
+                                                                       bool cotangent,
+                                                                       ScalarType weight = 1)
+    {
+        typedef Eigen::SparseMatrix<ScalarType> SpMat;
+        typedef MeshOperatorCache<MeshType> OperatorCache;
+        typename OperatorCache::Key key=OperatorCache::MakeKey(OperatorCache::MeshToMatrixLaplacian);
+        key.push_back(cotangent ? 1 : 0);
+        key.push_back(cotangent ? 0 : weight);
+        return cache.template GetOperator<ScalarType>(mesh,key,cotangent,[&](SpMat &L)
+        {
+            std::vector<std::pair<int,int> > index;
+            std::vector<ScalarType> entry;
+            for (size_t i=0;i<mesh.face.size();i++)
+                GetLaplacianEntry(mesh,mesh.face[i],index,entry,cotangent,weight,false);
+            std::vector<Eigen::Triplet<ScalarType> > IJV;
+            IJV.reserve(index.size());
+            for (size_t i=0;i<index.size();i++)
+                IJV.push_back(Eigen::Triplet<ScalarType>(index[i].first,index[i].second,entry[i]));
+            L.resize(int(mesh.vert.size()),int(mesh.vert.size()));
+            L.setFromTriplets(IJV.begin(),IJV.end());
+        });
+    }
 
 };
 
@@ -231,6 +231,7 @@ public:
   HausdorffSampler(MeshType* _m, MeshType* _sampleMesh=0, MeshType* _closestMesh=0 ) :markerFunctor(_m)
   {
     m=_m;
+    useQuantiles=false;
     init(_sampleMesh,_closestMesh);
   }
 
@@ -249,6 +250,8 @@ public:
   double          volume;
   double          area_S1;
   Histogramf hist;
+  QuantileSketch<ScalarType> quantiles; /// bounded memory summary of the distances, for percentile queries
+  bool useQuantiles;                    /// if true (default false) the distances are also added to quantiles
   // globals parameters driving the samples.
   int             n_total_samples;
   int             n_samples;
@@ -278,6 +281,7 @@ public:
       markerFunctor.SetMesh(m);
       hist.SetRange(0.0, m->bbox.Diag()/100.0, 100);
     }
+    quantiles.Clear();
     min_dist = std::numeric_limits<double>::max();
     max_dist = 0;
     mean_dist =0;
@@ -305,15 +309,48 @@ public:
     ScalarType dist = dist_upper_bound;
 
     // compute distance between startPt and the mesh S2
-    FaceType   *nearestF=0;
-    VertexType   *nearestV=0;
     vcg::face::PointDistanceBaseFunctor<ScalarType> PDistFunct;
     dist=dist_upper_bound;
     if(useVertexSampling)
-      nearestV =  tri::GetClosestVertex<MeshType,MetroMeshVertexGrid>(*m,unifGridVert,startPt,dist_upper_bound,dist);
+      tri::GetClosestVertex<MeshType,MetroMeshVertexGrid>(*m,unifGridVert,startPt,dist_upper_bound,dist);
     else
-      nearestF =  unifGridFace.GetClosest(PDistFunct,markerFunctor,startPt,dist_upper_bound,dist,closestPt);
+      unifGridFace.GetClosest(PDistFunct,markerFunctor,startPt,dist_upper_bound,dist,closestPt);
+
+    return AccumulateSample(startPt,startN,closestPt,dist);
+  }
 
+  /// \brief Add a batch of samples (with their normals), searching the closest points in parallel.
+  /// The closest point queries do not use the mesh marks, so they can run concurrently;
+  /// the measures are then accumulated in the order of the samples, exactly as calling AddSample on each of them.
+  /// If dist is not null it receives the distance of each sample.
+  void AddSamples(const std::vector<CoordType> &startPt, const std::vector<CoordType> &startN, std::vector<ScalarType> *dist=0)
+  {
+    assert(startPt.size()==startN.size());
+    const int sampleNum = int(startPt.size());
+    std::vector<CoordType> closestPt(sampleNum);
+    std::vector<ScalarType> sampleDist(sampleNum,dist_upper_bound);
+#pragma omp parallel
+    {
+      vcg::face::PointDistanceBaseFunctor<ScalarType> PDistFunct;
+      tri::EmptyTMark<MeshType> emptyMarker;
+#pragma omp for schedule(dynamic,256)
+      for(int i=0;i<sampleNum;++i)
+      {
+        if(useVertexSampling)
+          tri::GetClosestVertex<MeshType,MetroMeshVertexGrid>(*m,unifGridVert,startPt[i],dist_upper_bound,sampleDist[i]);
+        else
+          unifGridFace.GetClosest(PDistFunct,emptyMarker,startPt[i],dist_upper_bound,sampleDist[i],closestPt[i]);
+      }
+    }
+    for(int i=0;i<sampleNum;++i)
+      AccumulateSample(startPt[i],startN[i],closestPt[i],sampleDist[i]);
+    if(dist) dist->swap(sampleDist);
+  }
+
+private:
+  // update the distance measures (and the sample/closest meshes) with a sample whose closest point has been found
+  float AccumulateSample(const CoordType &startPt, const CoordType &startN, const CoordType &closestPt, ScalarType dist)
+  {
     // update distance measures
     if(dist == dist_upper_bound)
       return dist;
@@ -326,6 +363,7 @@ public:
     n_total_samples++;
 
     hist.Add((float)fabs(dist));
+    if(useQuantiles) quantiles.Add(fabs(dist));
     if(samplePtMesh)
     {
       tri::Allocator<MeshType>::AddVertices(*samplePtMesh,1);
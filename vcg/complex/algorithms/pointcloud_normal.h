@@ -46,6 +46,7 @@ public:
   typedef typename MeshType::VertexIterator VertexIterator;
   typedef typename MeshType::ScalarType			ScalarType;
 
+  /// \deprecated no longer used: OrientNormalsMST builds the Riemannian graph in CSR form, see ArcWeight() and BetterArc()
   class WArc
   {
   public:
@@ -57,34 +58,221 @@ public:
     bool operator< (const WArc &a) const {return w<a.w;}
   };
 
+  static ScalarType ArcWeight(const MeshType &m, int i, int j)
+  {
+    return std::abs(m.vert[i].cN()*m.vert[j].cN());
+  }
+
+  // strict total order on the arcs of the Riemannian graph: heavier first, then by the sorted endpoint indices
+  static bool BetterArc(ScalarType w0, int i0, int j0, ScalarType w1, int i1, int j1)
+  {
+    if(w0!=w1) return w0>w1;
+    if(i0>j0) std::swap(i0,j0);
+    if(i1>j1) std::swap(i1,j1);
+    return i0!=i1 ? i0<i1 : j0<j1;
+  }
+
+  static int FindRoot(std::vector<int> &parent, int i)
+  {
+    int r=i;
+    while(parent[r]!=r) r=parent[r];
+    while(parent[i]!=r) { int n=parent[i]; parent[i]=r; i=n; }
+    return r;
+  }
+
+  /// \brief Normal of each vertex as the direction of the plane fitted to its nn nearest neighbours (not farther than maxDist).
+  /// The resulting normals are not consistently oriented. The vertices are processed in parallel, the tree is only read.
   static void ComputeUndirectedNormal(MeshType &m, int nn, ScalarType maxDist, KdTree<ScalarType> &tree,vcg::CallBackPos * cb=0)
   {
 //    tree.setMaxNofNeighbors(nn);
     const ScalarType maxDistSquared = maxDist*maxDist;
-    int cnt=0;
-	int step = std::max(m.vn, int(m.vn / 100));
-    typename KdTree<ScalarType>::PriorityQueue nq;
-    for (VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
+    const int vertNum = int(m.vert.size());
+    const int blockSize = 4096;
+    for(int block=0;block<vertNum;block+=blockSize)
     {
-        tree.doQueryK(vi->cP(),nn,nq);
-        if(cb && (++cnt%step)==0) cb(cnt/step,"Fitting planes");
-
-//        int neighbours = tree.getNofFoundNeighbors();
-        int neighbours = nq.getNofElements();
+      if(cb) cb(int(100.0f * (float)block / (float)vertNum),"Fitting planes");
+      const int blockEnd = std::min(vertNum,block+blockSize);
+#pragma omp parallel
+      {
+        typename KdTree<ScalarType>::PriorityQueue nq;
         std::vector<CoordType> ptVec;
-        for (int i = 0; i < neighbours; i++)
+#pragma omp for schedule(static)
+        for(int vi=block;vi<blockEnd;++vi)
         {
-//            int neightId = tree.getNeighborId(i);
+          tree.doQueryK(m.vert[vi].cP(),nn,nq);
+          int neighbours = nq.getNofElements();
+          ptVec.clear();
+          for (int i = 0; i < neighbours; i++)
+          {
             int neightId = nq.getIndex(i);
             if(nq.getWeight(i) <maxDistSquared)
               ptVec.push_back(m.vert[neightId].cP());
+          }
+          Plane3<ScalarType> plane;
+          FitPlaneToPointSet(ptVec,plane);
+          m.vert[vi].N()=plane.Direction();
+        }
+      }
+    }
+  }
+
+  /// \brief Consistently orient the (undirected) normals of a compact point cloud.
+  ///
+  /// The nn-nearest neighbour graph (symmetrized) is weighted by |n_i . n_j|, arcs with weight lower than 0.3 are
+  /// discarded. A maximum spanning forest of this Riemannian graph is built with the Boruvka algorithm, whose rounds
+  /// select the best arc leaving each component in parallel; ties are broken on the vertex indices so that the forest
+  /// does not depend on the number of threads. Each tree is then visited from its lowest index vertex, whose normal is
+  /// kept, flipping the normals that disagree with their parent.
+  static void OrientNormalsMST(MeshType &m, int nn, KdTree<ScalarType> &tree, vcg::CallBackPos * cb=0)
+  {
+    const int vertNum = int(m.vert.size());
+    if(vertNum==0 || nn<=0) return;
+    if(cb) cb(0,"Building neighbour graph");
+
+    // kNN graph, nn slots per vertex (-1 when empty), then its symmetric CSR version
+    std::vector<int> knn(size_t(vertNum)*nn,-1);
+#pragma omp parallel
+    {
+      typename KdTree<ScalarType>::PriorityQueue nq;
+#pragma omp for schedule(static)
+      for(int i=0;i<vertNum;++i)
+      {
+        tree.doQueryK(m.vert[i].cP(),nn,nq);
+        int neighbours = std::min(nq.getNofElements(),nn);
+        int *row = &knn[size_t(i)*nn];
+        for(int k=0;k<neighbours;++k)
+        {
+          int j = nq.getIndex(k);
+          if(j!=i && j<vertNum && ArcWeight(m,i,j)>=ScalarType(0.3))
+            row[k]=j;
+        }
+      }
+    }
+
+    std::vector<size_t> adjStart(vertNum+1,0);
+    for(size_t e=0;e<knn.size();++e)
+      if(knn[e]>=0) { ++adjStart[e/nn+1]; ++adjStart[knn[e]+1]; }
+    for(int i=0;i<vertNum;++i) adjStart[i+1]+=adjStart[i];
+    std::vector<int> adj(adjStart[vertNum]);
+    std::vector<ScalarType> adjW(adjStart[vertNum]);
+    {
+      std::vector<size_t> fill(adjStart.begin(),adjStart.end()-1);
+      for(size_t e=0;e<knn.size();++e)
+        if(knn[e]>=0)
+        {
+          const int i=int(e/nn), j=knn[e];
+          const ScalarType w=ArcWeight(m,i,j);
+          adjW[fill[i]]=w; adj[fill[i]++]=j;
+          adjW[fill[j]]=w; adj[fill[j]++]=i;
+        }
+    }
+    std::vector<int>().swap(knn);
+
+    // Boruvka rounds
+    if(cb) cb(30,"Building spanning forest");
+    std::vector<int> parent(vertNum), rank(vertNum,0), label(vertNum), best(vertNum), compBest(vertNum,-1);
+    std::vector<ScalarType> bestW(vertNum);
+    std::vector<size_t> adjEnd(adjStart.begin()+1,adjStart.end());
+    for(int i=0;i<vertNum;++i) parent[i]=label[i]=i;
+    std::vector<std::pair<int,int> > forest;
+    bool merged=true;
+    while(merged)
+    {
+      merged=false;
+      // best arc leaving the component of each vertex; the arcs that became internal are dropped for good
+#pragma omp parallel for schedule(dynamic,1024)
+      for(int i=0;i<vertNum;++i)
+      {
+        int b=-1;
+        ScalarType bw=0;
+        size_t end=adjEnd[i];
+        for(size_t a=adjStart[i];a<end;)
+        {
+          const int j=adj[a];
+          if(label[j]==label[i])
+          {
+            --end;
+            adj[a]=adj[end]; adjW[a]=adjW[end];
+            continue;
+          }
+          if(b<0 || BetterArc(adjW[a],i,j,bw,i,b))
+          {
+            b=j; bw=adjW[a];
+          }
+          ++a;
+        }
+        adjEnd[i]=end;
+        best[i]=b;
+        bestW[i]=bw;
+      }
+      // best arc leaving each component
+      std::vector<int> roots;
+      for(int i=0;i<vertNum;++i)
+      {
+        if(best[i]<0) continue;
+        int &cBest=compBest[label[i]];
+        if(cBest<0) roots.push_back(label[i]);
+        if(cBest<0 || BetterArc(bestW[i],i,best[i],bestW[cBest],cBest,best[cBest])) cBest=i;
+      }
+      for(size_t r=0;r<roots.size();++r)
+      {
+        const int i=compBest[roots[r]], j=best[i];
+        compBest[roots[r]]=-1;
+        int ri=FindRoot(parent,i), rj=FindRoot(parent,j);
+        if(ri==rj) continue; // the same arc chosen by both its components
+        if(rank[ri]<rank[rj]) std::swap(ri,rj);
+        parent[rj]=ri;
+        if(rank[ri]==rank[rj]) ++rank[ri];
+        forest.push_back(std::make_pair(i,j));
+        merged=true;
+      }
+      if(merged)
+      {
+        for(int i=0;i<vertNum;++i) FindRoot(parent,i);
+#pragma omp parallel for schedule(static)
+        for(int i=0;i<vertNum;++i) label[i]=parent[i];
+      }
+    }
+
+    // propagate the orientation along the trees of the forest
+    if(cb) cb(80,"Orienting normals");
+    std::vector<int> treeStart(vertNum+1,0), treeAdj(forest.size()*2);
+    for(size_t e=0;e<forest.size();++e) { ++treeStart[forest[e].first+1]; ++treeStart[forest[e].second+1]; }
+    for(int i=0;i<vertNum;++i) treeStart[i+1]+=treeStart[i];
+    {
+      std::vector<int> fill(treeStart.begin(),treeStart.end()-1);
+      for(size_t e=0;e<forest.size();++e)
+      {
+        treeAdj[fill[forest[e].first]++]=forest[e].second;
+        treeAdj[fill[forest[e].second]++]=forest[e].first;
+      }
+    }
+    std::vector<char> visited(vertNum,0);
+    std::vector<int> queue;
+    queue.reserve(vertNum);
+    for(int s=0;s<vertNum;++s)
+    {
+      if(visited[s]) continue;
+      visited[s]=1;
+      queue.clear();
+      queue.push_back(s);
+      for(size_t q=0;q<queue.size();++q)
+      {
+        const int u=queue[q];
+        for(int a=treeStart[u];a<treeStart[u+1];++a)
+        {
+          const int t=treeAdj[a];
+          if(visited[t]) continue;
+          visited[t]=1;
+          if(m.vert[u].cN()*m.vert[t].cN()<0.0)
+            m.vert[t].N()=-m.vert[t].N();
+          queue.push_back(t);
         }
-        Plane3<ScalarType> plane;
-        FitPlaneToPointSet(ptVec,plane);
-        vi->N()=plane.Direction();
+      }
     }
   }
 
+  /// \deprecated no longer used by OrientNormalsMST, kept for the code that built its own heap of WArc
   static void AddNeighboursToHeap( MeshType &m, VertexPointer vp, int nn, KdTree<ScalarType> &tree, std::vector<WArc> &heap)
   {
     typename KdTree<ScalarType>::PriorityQueue nq;
@@ -145,43 +333,17 @@ public:
 
     if(p.useViewPoint) // Simple case use the viewpoint position to determine the right orientation of each point
     {
-      for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
+      const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+      for(int i=0;i<vertNum;++i)
       {
-        if ( vi->N().dot(p.viewPoint- vi->P())<0.0)
-            vi->N()=-(*vi).N();
+        if ( m.vert[i].N().dot(p.viewPoint- m.vert[i].P())<0.0)
+            m.vert[i].N()=-m.vert[i].N();
       }
       return;
     }
 
-    tri::UpdateFlags<MeshType>::VertexClearV(m);
-    std::vector<WArc> heap;
-    VertexIterator vi=m.vert.begin();
-    while(true)
-    {
-      // search an unvisited vertex
-      while(vi!=m.vert.end() && vi->IsV())
-        ++vi;
-
-      if(vi==m.vert.end()) return;
-
-      vi->SetV();
-      AddNeighboursToHeap(m,&*vi,p.coherentAdjNum,tree,heap);
-
-      while(!heap.empty())
-      {
-        std::pop_heap(heap.begin(),heap.end());
-        WArc a = heap.back();
-        heap.pop_back();
-        if(!a.trg->IsV())
-        {
-          a.trg->SetV();
-          if(a.src->cN()*a.trg->cN()<0.0)
-              a.trg->N()=-a.trg->N();
-          AddNeighboursToHeap(m,a.trg,p.coherentAdjNum,tree,heap);
-        }
-      }
-    }
-
+    OrientNormalsMST(m,p.coherentAdjNum,tree,cb);
     return;
   }
 
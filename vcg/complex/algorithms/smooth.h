@@ -126,68 +126,40 @@ class Smooth
 
     static void VertexCoordScaleDependentLaplacian_Fujiwara(MeshType &m, int step, ScalarType delta, bool SmoothSelected = false)
     {
-        SimpleTempData<typename MeshType::VertContainer, ScaleLaplacianInfo> TD(m.vert);
-        ScaleLaplacianInfo lpz;
-        lpz.PntSum = CoordType(0, 0, 0);
-        lpz.LenSum = 0;
-        FaceIterator fi;
+        LaplacianStencil ls;
+        BuildLaplacianStencil(m, ls, StencilFujiwara);
+        std::vector<CoordType> newP;
+        const int vertNum = int(m.vert.size());
         for (int i = 0; i < step; ++i)
         {
-            VertexIterator vi;
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                TD[*vi] = lpz;
-
-            for (fi = m.face.begin(); fi != m.face.end(); ++fi)
-                if (!(*fi).IsD())
-                    for (int j = 0; j < 3; ++j)
-                        if (!(*fi).IsB(j))
-                        {
-                            CoordType edge = (*fi).V1(j)->P() - (*fi).V(j)->P();
-                            ScalarType len = Norm(edge);
-                            edge /= len;
-                            TD[(*fi).V(j)].PntSum += edge;
-                            TD[(*fi).V1(j)].PntSum -= edge;
-                            TD[(*fi).V(j)].LenSum += len;
-                            TD[(*fi).V1(j)].LenSum += len;
-                        }
-
-            for (fi = m.face.begin(); fi != m.face.end(); ++fi)
-                if (!(*fi).IsD())
-                    for (int j = 0; j < 3; ++j)
-                        // se l'edge j e' di bordo si riazzera tutto e si riparte
-                        if ((*fi).IsB(j))
-                        {
-                            TD[(*fi).V(j)].PntSum = CoordType(0, 0, 0);
-                            TD[(*fi).V1(j)].PntSum = CoordType(0, 0, 0);
-                            TD[(*fi).V(j)].LenSum = 0;
-                            TD[(*fi).V1(j)].LenSum = 0;
-                        }
-
-            for (fi = m.face.begin(); fi != m.face.end(); ++fi)
-                if (!(*fi).IsD())
-                    for (int j = 0; j < 3; ++j)
-                        if ((*fi).IsB(j))
-                        {
-                            CoordType edge = (*fi).V1(j)->P() - (*fi).V(j)->P();
-                            ScalarType len = Norm(edge);
-                            edge /= len;
-                            TD[(*fi).V(j)].PntSum += edge;
-                            TD[(*fi).V1(j)].PntSum -= edge;
-                            TD[(*fi).V(j)].LenSum += len;
-                            TD[(*fi).V1(j)].LenSum += len;
-                        }
+            newP.resize(m.vert.size());
             // The fundamental part:
             // We move the new point of a quantity
             //
             //  L(M) = 1/Sum(edgelen) * Sum(Normalized edges)
             //
-
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                if (!(*vi).IsD() && TD[*vi].LenSum > 0)
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < vertNum; ++k)
+            {
+                const VertexType &v = m.vert[k];
+                newP[k] = v.cP();
+                if (v.IsD() || (SmoothSelected && !v.IsS()))
+                    continue;
+                ScaleLaplacianInfo lpz;
+                lpz.PntSum = CoordType(0, 0, 0);
+                lpz.LenSum = 0;
+                for (size_t e = ls.start[k]; e < ls.start[k + 1]; ++e)
                 {
-                    if (!SmoothSelected || (*vi).IsS())
-                        (*vi).P() = (*vi).P() + (TD[*vi].PntSum / TD[*vi].LenSum) * delta;
+                    CoordType edge = m.vert[ls.nb[e]].cP() - v.cP();
+                    ScalarType len = Norm(edge);
+                    edge /= len;
+                    lpz.PntSum += edge;
+                    lpz.LenSum += len;
                 }
+                if (lpz.LenSum > 0)
+                    newP[k] = v.cP() + (lpz.PntSum / lpz.LenSum) * delta;
+            }
+            SetCoords(m, newP);
         }
     };
 
@@ -331,22 +303,190 @@ class Smooth
         }
     }
 
-    static void VertexCoordLaplacian(MeshType &m, int step, bool SmoothSelected = false, bool cotangentWeight = false, vcg::CallBackPos *cb = 0)
+    /// Gather form of the Laplacian accumulations used by the smoothing functions.
+    /// The entries [start[i],start[i+1]) of a vertex i list the vertices (possibly i itself) and the weights
+    /// it accumulates, in the same order of the serial face loops, so that e.g. for AccumulateLaplacianInfo
+    /// sum = Sum w*P(nb) and cnt = Sum w. It is built once per smoothing run (cotangent weights included),
+    /// then each step is a per-vertex gather that reads the old positions and writes a second buffer:
+    /// a Jacobi update with no write races, that can run in parallel and gives deterministic results.
+    class LaplacianStencil
+    {
+      public:
+        std::vector<size_t> start;
+        std::vector<int> nb;
+        std::vector<ScalarType> w;
+    };
+
+    enum StencilType
+    {
+        StencilLaplacian, ///< as AccumulateLaplacianInfo
+        StencilHC,        ///< as VertexCoordLaplacianHC: every edge, border edges twice
+        StencilFujiwara   ///< as VertexCoordScaleDependentLaplacian_Fujiwara: border vertices only see border edges
+    };
+
+    static void BuildLaplacianStencil(MeshType &m, LaplacianStencil &ls, StencilType type = StencilLaplacian, bool cotangentFlag = false)
+    {
+        struct Entry
+        {
+            int v, nb;
+            ScalarType w;
+        };
+        std::vector<Entry> ent;
+        ent.reserve(m.fn * 6 + m.tn * 12);
+        auto push = [&ent](int v, int nb, ScalarType w) { Entry e = {v, nb, w}; ent.push_back(e); };
+        const int vertNum = int(m.vert.size());
+
+        if (type == StencilHC)
+        {
+            for (auto fi = m.face.begin(); fi != m.face.end(); ++fi)
+                if (!(*fi).IsD())
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        const int v0 = int(tri::Index(m, (*fi).V(j))), v1 = int(tri::Index(m, (*fi).V1(j)));
+                        push(v0, v1, 1);
+                        push(v1, v0, 1);
+                        if ((*fi).IsB(j))
+                        {
+                            push(v0, v1, 1);
+                            push(v1, v0, 1);
+                        }
+                    }
+        }
+        else
+        {
+            // on border vertices the accumulation is reset and redone only with the border edges
+            std::vector<char> faceBorder(vertNum, 0), tetraBorder(vertNum, 0);
+            for (auto fi = m.face.begin(); fi != m.face.end(); ++fi)
+                if (!(*fi).IsD())
+                    for (int j = 0; j < 3; ++j)
+                        if ((*fi).IsB(j))
+                            faceBorder[tri::Index(m, (*fi).V0(j))] = faceBorder[tri::Index(m, (*fi).V1(j))] = 1;
+
+            if (type == StencilLaplacian)
+            {
+                ForEachTetra(m, [&](TetraType &t) {
+                    for (int i = 0; i < 4; ++i)
+                        if (t.IsB(i))
+                            for (int k = 0; k < 3; ++k)
+                                tetraBorder[tri::Index(m, t.V(Tetra::VofF(i, k)))] = 1;
+                });
+                ForEachTetra(m, [&](TetraType &t) {
+                    for (int i = 0; i < 6; ++i)
+                    {
+                        const int v0 = int(tri::Index(m, t.V(Tetra::VofE(i, 0))));
+                        const int v1 = int(tri::Index(m, t.V(Tetra::VofE(i, 1))));
+                        float weight = 1.0f;
+                        if (cotangentFlag)
+                        {
+                            VertexPointer vo0 = t.V(Tetra::VofE(5 - i, 0));
+                            VertexPointer vo1 = t.V(Tetra::VofE(5 - i, 1));
+                            ScalarType angle = Tetra::DihedralAngle(t, 5 - i);
+                            ScalarType length = vcg::Distance(vo0->P(), vo1->P());
+                            weight = (length / 6.) * (tan(M_PI / 2. - angle));
+                        }
+                        if (!faceBorder[v0] && !tetraBorder[v0]) push(v0, v1, weight);
+                        if (!faceBorder[v1] && !tetraBorder[v1]) push(v1, v0, weight);
+                    }
+                });
+                for (int i = 0; i < vertNum; ++i)
+                    if (tetraBorder[i] && !faceBorder[i])
+                        push(i, i, 1);
+            }
+
+            for (auto fi = m.face.begin(); fi != m.face.end(); ++fi)
+                if (!(*fi).IsD())
+                    for (int j = 0; j < 3; ++j)
+                        if (!(*fi).IsB(j))
+                        {
+                            float weight = 1.0f;
+                            if (cotangentFlag && type == StencilLaplacian)
+                            {
+                                float angle = Angle(fi->P1(j) - fi->P2(j), fi->P0(j) - fi->P2(j));
+                                weight = tan((M_PI * 0.5) - angle);
+                            }
+                            const int v0 = int(tri::Index(m, (*fi).V0(j))), v1 = int(tri::Index(m, (*fi).V1(j)));
+                            if (!faceBorder[v0]) push(v0, v1, weight);
+                            if (!faceBorder[v1]) push(v1, v0, weight);
+                        }
+
+            if (type == StencilLaplacian)
+                for (int i = 0; i < vertNum; ++i)
+                    if (faceBorder[i])
+                        push(i, i, 1);
+
+            for (auto fi = m.face.begin(); fi != m.face.end(); ++fi)
+                if (!(*fi).IsD())
+                    for (int j = 0; j < 3; ++j)
+                        if ((*fi).IsB(j))
+                        {
+                            const int v0 = int(tri::Index(m, (*fi).V0(j))), v1 = int(tri::Index(m, (*fi).V1(j)));
+                            push(v0, v1, 1);
+                            push(v1, v0, 1);
+                        }
+        }
+
+        // stable counting sort of the entries by vertex
+        ls.start.assign(vertNum + 1, 0);
+        for (size_t i = 0; i < ent.size(); ++i)
+            ++ls.start[ent[i].v + 1];
+        for (int i = 0; i < vertNum; ++i)
+            ls.start[i + 1] += ls.start[i];
+        std::vector<size_t> pos(ls.start.begin(), ls.start.end() - 1);
+        ls.nb.resize(ent.size());
+        ls.w.resize(ent.size());
+        for (size_t i = 0; i < ent.size(); ++i)
+        {
+            const size_t k = pos[ent[i].v]++;
+            ls.nb[k] = ent[i].nb;
+            ls.w[k] = ent[i].w;
+        }
+    }
+
+    /// The LaplacianInfo of the i-th vertex gathered from a StencilLaplacian stencil
+    static LaplacianInfo GatherLaplacianInfo(const MeshType &m, const LaplacianStencil &ls, size_t i)
     {
         LaplacianInfo lpz(CoordType(0, 0, 0), 0);
-        SimpleTempData<typename MeshType::VertContainer, LaplacianInfo> TD(m.vert, lpz);
+        for (size_t e = ls.start[i]; e < ls.start[i + 1]; ++e)
+        {
+            lpz.sum += m.vert[ls.nb[e]].cP() * ls.w[e];
+            lpz.cnt += ls.w[e];
+        }
+        return lpz;
+    }
+
+    /// Copy back the second buffer of a Jacobi step
+    static void SetCoords(MeshType &m, const std::vector<CoordType> &newP)
+    {
+        const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+        for (int k = 0; k < vertNum; ++k)
+            if (!m.vert[k].IsD())
+                m.vert[k].P() = newP[k];
+    }
+
+    /// Note that the cotangent weights are computed once, on the initial positions.
+    static void VertexCoordLaplacian(MeshType &m, int step, bool SmoothSelected = false, bool cotangentWeight = false, vcg::CallBackPos *cb = 0)
+    {
+        LaplacianStencil ls;
+        BuildLaplacianStencil(m, ls, StencilLaplacian, cotangentWeight);
+        std::vector<CoordType> newP(m.vert.size());
+        const int vertNum = int(m.vert.size());
         for (int i = 0; i < step; ++i)
         {
             if (cb)
                 cb(100 * i / step, "Classic Laplacian Smoothing");
-            TD.Init(lpz);
-            AccumulateLaplacianInfo(m, TD, cotangentWeight);
-            for (auto vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                if (!(*vi).IsD() && TD[*vi].cnt > 0)
-                {
-                    if (!SmoothSelected || (*vi).IsS())
-                        (*vi).P() = ((*vi).P() + TD[*vi].sum) / (TD[*vi].cnt + 1);
-                }
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < vertNum; ++k)
+            {
+                const VertexType &v = m.vert[k];
+                newP[k] = v.cP();
+                if (v.IsD() || (SmoothSelected && !v.IsS()))
+                    continue;
+                LaplacianInfo lpz = GatherLaplacianInfo(m, ls, k);
+                if (lpz.cnt > 0)
+                    newP[k] = (v.cP() + lpz.sum) / (lpz.cnt + 1);
+            }
+            SetCoords(m, newP);
         }
     }
 
@@ -446,35 +586,33 @@ So if
 
     static void VertexCoordTaubin(MeshType &m, int step, float lambda, float mu, bool SmoothSelected = false, vcg::CallBackPos *cb = 0)
     {
-        LaplacianInfo lpz(CoordType(0, 0, 0), 0);
-        SimpleTempData<typename MeshType::VertContainer, LaplacianInfo> TD(m.vert, lpz);
-        VertexIterator vi;
+        LaplacianStencil ls;
+        BuildLaplacianStencil(m, ls, StencilLaplacian);
+        std::vector<CoordType> newP(m.vert.size());
+        const int vertNum = int(m.vert.size());
         for (int i = 0; i < step; ++i)
         {
             if (cb)
                 cb(100 * i / step, "Taubin Smoothing");
-            TD.Init(lpz);
-            AccumulateLaplacianInfo(m, TD);
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                if (!(*vi).IsD() && TD[*vi].cnt > 0)
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                const float scale = (pass == 0) ? lambda : mu;
+#pragma omp parallel for schedule(static)
+                for (int k = 0; k < vertNum; ++k)
                 {
-                    if (!SmoothSelected || (*vi).IsS())
+                    const VertexType &v = m.vert[k];
+                    newP[k] = v.cP();
+                    if (v.IsD() || (SmoothSelected && !v.IsS()))
+                        continue;
+                    LaplacianInfo lpz = GatherLaplacianInfo(m, ls, k);
+                    if (lpz.cnt > 0)
                     {
-                        CoordType Delta = TD[*vi].sum / TD[*vi].cnt - (*vi).P();
-                        (*vi).P() = (*vi).P() + Delta * lambda;
-                    }
-                }
-            TD.Init(lpz);
-            AccumulateLaplacianInfo(m, TD);
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                if (!(*vi).IsD() && TD[*vi].cnt > 0)
-                {
-                    if (!SmoothSelected || (*vi).IsS())
-                    {
-                        CoordType Delta = TD[*vi].sum / TD[*vi].cnt - (*vi).P();
-                        (*vi).P() = (*vi).P() + Delta * mu;
+                        CoordType Delta = lpz.sum / lpz.cnt - v.cP();
+                        newP[k] = v.cP() + Delta * scale;
                     }
                 }
+                SetCoords(m, newP);
+            }
         } // end for step
     }
 
@@ -552,64 +690,39 @@ So if
     static void VertexCoordLaplacianHC(MeshType &m, int step, bool SmoothSelected = false)
     {
         ScalarType beta = 0.5;
-        HCSmoothInfo lpz;
-        lpz.sum = CoordType(0, 0, 0);
-        lpz.dif = CoordType(0, 0, 0);
-        lpz.cnt = 0;
+        LaplacianStencil ls;
+        BuildLaplacianStencil(m, ls, StencilHC);
+        std::vector<CoordType> sum(m.vert.size()), newP(m.vert.size());
+        const int vertNum = int(m.vert.size());
         for (int i = 0; i < step; ++i)
         {
-            SimpleTempData<typename MeshType::VertContainer, HCSmoothInfo> TD(m.vert, lpz);
             // First Loop compute the laplacian
-            FaceIterator fi;
-            for (fi = m.face.begin(); fi != m.face.end(); ++fi)
-                if (!(*fi).IsD())
-                {
-                    for (int j = 0; j < 3; ++j)
-                    {
-                        TD[(*fi).V(j)].sum += (*fi).V1(j)->P();
-                        TD[(*fi).V1(j)].sum += (*fi).V(j)->P();
-                        ++TD[(*fi).V(j)].cnt;
-                        ++TD[(*fi).V1(j)].cnt;
-                        // se l'edge j e' di bordo si deve sommare due volte
-                        if ((*fi).IsB(j))
-                        {
-                            TD[(*fi).V(j)].sum += (*fi).V1(j)->P();
-                            TD[(*fi).V1(j)].sum += (*fi).V(j)->P();
-                            ++TD[(*fi).V(j)].cnt;
-                            ++TD[(*fi).V1(j)].cnt;
-                        }
-                    }
-                }
-            VertexIterator vi;
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-                if (!(*vi).IsD())
-                    TD[*vi].sum /= (float)TD[*vi].cnt;
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < vertNum; ++k)
+            {
+                sum[k] = CoordType(0, 0, 0);
+                for (size_t e = ls.start[k]; e < ls.start[k + 1]; ++e)
+                    sum[k] += m.vert[ls.nb[e]].cP();
+                if (!m.vert[k].IsD())
+                    sum[k] /= (float)(ls.start[k + 1] - ls.start[k]);
+            }
 
             // Second Loop compute average difference
-            for (fi = m.face.begin(); fi != m.face.end(); ++fi)
-                if (!(*fi).IsD())
-                {
-                    for (int j = 0; j < 3; ++j)
-                    {
-                        TD[(*fi).V(j)].dif += TD[(*fi).V1(j)].sum - (*fi).V1(j)->P();
-                        TD[(*fi).V1(j)].dif += TD[(*fi).V(j)].sum - (*fi).V(j)->P();
-                        // se l'edge j e' di bordo si deve sommare due volte
-                        if ((*fi).IsB(j))
-                        {
-                            TD[(*fi).V(j)].dif += TD[(*fi).V1(j)].sum - (*fi).V1(j)->P();
-                            TD[(*fi).V1(j)].dif += TD[(*fi).V(j)].sum - (*fi).V(j)->P();
-                        }
-                    }
-                }
-
-            for (vi = m.vert.begin(); vi != m.vert.end(); ++vi)
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < vertNum; ++k)
             {
-				if (TD[*vi].cnt > 0){
-					TD[*vi].dif /= (float)TD[*vi].cnt;
-					if (!SmoothSelected || (*vi).IsS())
-						(*vi).P() = TD[*vi].sum - (TD[*vi].sum - (*vi).P()) * beta + (TD[*vi].dif) * (1.f - beta);
-				}
+                const VertexType &v = m.vert[k];
+                newP[k] = v.cP();
+                const int cnt = int(ls.start[k + 1] - ls.start[k]);
+                if (cnt == 0 || (SmoothSelected && !v.IsS()))
+                    continue;
+                CoordType dif(0, 0, 0);
+                for (size_t e = ls.start[k]; e < ls.start[k + 1]; ++e)
+                    dif += sum[ls.nb[e]] - m.vert[ls.nb[e]].cP();
+                dif /= (float)cnt;
+                newP[k] = sum[k] - (sum[k] - v.cP()) * beta + dif * (1.f - beta);
             }
+            SetCoords(m, newP);
         } // end for step
     };
 
@@ -1355,22 +1468,27 @@ A(...) (2-2nm)   =
             tree = new KdTree<ScalarType>(ww);
         else
             tree = tp;
-        typename KdTree<ScalarType>::PriorityQueue nq;
+        const int vertNum = int(m.vert.size());
 
         //  tree->setMaxNofNeighbors(neighborNum);
         for (int ii = 0; ii < iterNum; ++ii)
         {
-            for (VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
+#pragma omp parallel
             {
-                tree->doQueryK(vi->cP(), neighborNum, nq);
-                int neighbours = nq.getNofElements();
-                for (int i = 0; i < neighbours; i++)
+                typename KdTree<ScalarType>::PriorityQueue nq;
+#pragma omp for schedule(static)
+                for (int vi = 0; vi < vertNum; ++vi)
                 {
-                    int neightId = nq.getIndex(i);
-                    if (m.vert[neightId].cN() * vi->cN() > 0)
-                        TD[vi] += m.vert[neightId].cN();
-                    else
-                        TD[vi] -= m.vert[neightId].cN();
+                    tree->doQueryK(m.vert[vi].cP(), neighborNum, nq);
+                    int neighbours = nq.getNofElements();
+                    for (int i = 0; i < neighbours; i++)
+                    {
+                        int neightId = nq.getIndex(i);
+                        if (m.vert[neightId].cN() * m.vert[vi].cN() > 0)
+                            TD[vi] += m.vert[neightId].cN();
+                        else
+                            TD[vi] -= m.vert[neightId].cN();
+                    }
                 }
             }
             for (VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
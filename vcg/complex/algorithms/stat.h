@@ -76,13 +76,26 @@ public:
 		std::pair<ScalarType, ScalarType> minmax = std::make_pair(std::numeric_limits<ScalarType>::max(),
 		                                                          std::numeric_limits<ScalarType>::lowest());
 
-		ForEachVertex(m, [&minmax] (const VertexType & v)
+		const int vertNum = int(m.vert.size());
+#pragma omp parallel
 		{
-			if( v.Q() < minmax.first)
-				minmax.first  = v.Q();
-			if( v.Q() > minmax.second)
-				minmax.second = v.Q();
-		});
+			std::pair<ScalarType, ScalarType> local = minmax;
+#pragma omp for schedule(static) nowait
+			for(int i=0;i<vertNum;++i)
+			{
+				const VertexType &v = m.vert[i];
+				if(v.IsD()) continue;
+				if( v.cQ() < local.first)
+					local.first  = v.cQ();
+				if( v.cQ() > local.second)
+					local.second = v.cQ();
+			}
+#pragma omp critical
+			{
+				minmax.first  = std::min(minmax.first,  local.first);
+				minmax.second = std::max(minmax.second, local.second);
+			}
+		}
 
 		return minmax;
 	}
@@ -121,12 +134,26 @@ public:
 		std::pair<ScalarType,ScalarType> minmax = std::make_pair(std::numeric_limits<ScalarType>::max(),
 		                                                         std::numeric_limits<ScalarType>::lowest());
 
-		ForEachFace(m, [&minmax] (const FaceType & f) {
-			if (f.cQ() < minmax.first)
-				minmax.first  = f.cQ();
-			if (f.cQ() > minmax.second)
-				minmax.second = f.cQ();
-		});
+		const int faceNum = int(m.face.size());
+#pragma omp parallel
+		{
+			std::pair<ScalarType, ScalarType> local = minmax;
+#pragma omp for schedule(static) nowait
+			for(int i=0;i<faceNum;++i)
+			{
+				const FaceType &f = m.face[i];
+				if(f.IsD()) continue;
+				if (f.cQ() < local.first)
+					local.first  = f.cQ();
+				if (f.cQ() > local.second)
+					local.second = f.cQ();
+			}
+#pragma omp critical
+			{
+				minmax.first  = std::min(minmax.first,  local.first);
+				minmax.second = std::max(minmax.second, local.second);
+			}
+		}
 
 		return minmax;
 	}
@@ -328,33 +355,23 @@ public:
 		return sum;
 	}
 
-  static void ComputePerVertexQualityDistribution(const MeshType & m, Distribution<ScalarType> & h, bool selectionOnly = false)    // V1.0
+  /// Works with any accumulator with the Distribution interface (e.g. QuantileSketch); the vertices are visited in parallel.
+  template <class DistributionType>
+  static void ComputePerVertexQualityDistribution(const MeshType & m, DistributionType & h, bool selectionOnly = false)    // V1.0
   {
     tri::RequirePerVertexQuality(m);
-    h.Clear();    
-    for(ConstVertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-      if(!(*vi).IsD() &&  ((!selectionOnly) || (*vi).IsS()) )
-      {
-          if(!math::IsNAN((*vi).Q()))
-              h.Add((*vi).Q());
-          else
-              assert( "You should never try to compute Histogram with Invalid Floating points numbers (NaN)");
-      }
+    h.Clear();
+    AccumulatePerVertexQuality(m,h,selectionOnly);
   }
 
-  static void ComputePerFaceQualityDistribution( const MeshType & m,  Distribution<typename MeshType::ScalarType> &h,
+  /// Works with any accumulator with the Distribution interface (e.g. QuantileSketch); the faces are visited in parallel.
+  template <class DistributionType>
+  static void ComputePerFaceQualityDistribution( const MeshType & m,  DistributionType &h,
                                                  bool selectionOnly = false)    // V1.0
   {
     tri::RequirePerFaceQuality(m);
-    h.Clear();    
-    for(ConstFaceIterator fi = m.face.begin(); fi != m.face.end(); ++fi)
-      if(!(*fi).IsD() &&  ((!selectionOnly) || (*fi).IsS()) )
-      {
-        if(!math::IsNAN((*fi).Q()))
-            h.Add((*fi).Q());
-        else
-            assert( "You should never try to compute Histogram with Invalid Floating points numbers (NaN)");        
-      }
+    h.Clear();
+    AccumulatePerFaceQuality(m,h,selectionOnly);
   }
 
   static void ComputePerTetraQualityDistribution(MeshType & m, Distribution<ScalarType> & h, bool selectionOnly = false)
@@ -392,11 +409,7 @@ public:
     std::pair<ScalarType, ScalarType> minmax = tri::Stat<MeshType>::ComputePerFaceQualityMinMax(m);
     h.Clear();
     h.SetRange( minmax.first,minmax.second, HistSize );
-    for(ConstFaceIterator fi = m.face.begin(); fi != m.face.end(); ++fi)
-      if(!(*fi).IsD() &&  ((!selectionOnly) || (*fi).IsS()) ){
-        assert(!math::IsNAN((*fi).Q()) && "You should never try to compute Histogram with Invalid Floating points numbers (NaN)");
-        h.Add((*fi).Q());
-      }
+    AccumulatePerFaceQuality(m,h,selectionOnly);
   }
 
   static void ComputePerVertexQualityHistogram( const MeshType & m, Histogram<ScalarType> &h, bool selectionOnly = false, int HistSize=10000 )    // V1.0
@@ -406,12 +419,7 @@ public:
 
     h.Clear();
     h.SetRange( minmax.first,minmax.second, HistSize);
-    for(ConstVertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-      if(!(*vi).IsD() &&  ((!selectionOnly) || (*vi).IsS()) )
-      {
-        assert(!math::IsNAN((*vi).Q()) && "You should never try to compute Histogram with Invalid Floating points numbers (NaN)");
-        h.Add((*vi).Q());
-      }
+    AccumulatePerVertexQuality(m,h,selectionOnly);
     // Sanity check; If some very wrong value has happened in the Q value,
     // the histogram is messed. If a significant percentage (20% )of the values are all in a single bin
     // we should try to solve the problem. No easy solution here.
@@ -432,9 +440,7 @@ public:
 
       h.Clear();
       h.SetRange(newmin, newmax, HistSize*50);
-      for(ConstVertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-        if(!(*vi).IsD() && ((!selectionOnly) || (*vi).IsS()) )
-          h.Add((*vi).Q());
+      AccumulatePerVertexQuality(m,h,selectionOnly);
     }
   }
 
@@ -490,6 +496,297 @@ public:
     return sum/(m.fn*3.0);
   }
 
+
+  /// Metrics that can be requested to ComputeStatistics (or-ed together).
+  enum StatisticsMask {
+    STAT_AREA                       = 0x0001, ///< total surface area
+    STAT_VOLUME                     = 0x0002, ///< signed volume (meaningful for closed watertight meshes)
+    STAT_SHELL_BARYCENTER           = 0x0004, ///< area weighted barycenter of the faces
+    STAT_CLOUD_BARYCENTER           = 0x0008, ///< average of the vertex positions
+    STAT_VERT_QUALITY               = 0x0010, ///< min, max and average of the vertex quality
+    STAT_FACE_QUALITY               = 0x0020, ///< min, max and average of the face quality
+    STAT_VERT_QUALITY_HISTOGRAM     = 0x0040, ///< histogram of the vertex quality over its min-max range
+    STAT_FACE_QUALITY_HISTOGRAM     = 0x0080, ///< histogram of the face quality over its min-max range
+    STAT_VERT_QUALITY_DISTRIBUTION  = 0x0100, ///< distribution (percentiles) of the vertex quality, NaN skipped
+    STAT_FACE_QUALITY_DISTRIBUTION  = 0x0200, ///< distribution (percentiles) of the face quality, NaN skipped
+    STAT_FACE_EDGE_LENGTH           = 0x0400, ///< min, max, average and sum of the face edge lengths (shared edges counted once per face)
+    STAT_FACE_EDGE_LENGTH_HISTOGRAM = 0x0800, ///< histogram of the face edge lengths over [0, max length]
+    STAT_BORDER_LENGTH              = 0x1000, ///< total length of the border edges, needs up to date FF adjacency
+    STAT_ALL                        = 0x1fff
+  };
+
+  /// Result of ComputeStatistics; only the fields of the requested metrics are meaningful.
+  struct Statistics
+  {
+    int mask;
+    size_t vertNum, faceNum;          ///< number of vertices and faces visited (non deleted, and selected if requested)
+    ScalarType area, volume;
+    Point3<ScalarType> shellBarycenter, cloudBarycenter;
+    ScalarType vertQualityMin, vertQualityMax, vertQualityAvg;
+    ScalarType faceQualityMin, faceQualityMax, faceQualityAvg;
+    ScalarType edgeLengthMin, edgeLengthMax, edgeLengthAvg, edgeLengthSum;
+    ScalarType borderLength;
+    Histogram<ScalarType> vertQualityHistogram, faceQualityHistogram, edgeLengthHistogram;
+    Distribution<ScalarType> vertQualityDistribution, faceQualityDistribution;
+  };
+
+  /**
+    \short Compute in a single parallel sweep all the metrics selected by mask (see StatisticsMask).
+
+    Vertices and faces are visited once, in parallel blocks; the partial sums of each block are kept in double
+    and combined in block order, so the scalar results do not depend on the number of threads.
+    Distributions are filled by per thread accumulators that are merged at the end. Histograms are defined over the
+    range of the data, so when one of them is requested a second sweep over the elements fills per thread
+    histograms that are then merged.
+    If selectionOnly is true only the selected vertices and faces are considered.
+    NaN qualities are skipped by the quality metrics; with no valid value min, max and average are 0.
+    */
+  static void ComputeStatistics(const MeshType &m, Statistics &s, int mask, bool selectionOnly=false, int histSize=10000)
+  {
+    if(mask & (STAT_VERT_QUALITY|STAT_VERT_QUALITY_HISTOGRAM|STAT_VERT_QUALITY_DISTRIBUTION)) tri::RequirePerVertexQuality(m);
+    if(mask & (STAT_FACE_QUALITY|STAT_FACE_QUALITY_HISTOGRAM|STAT_FACE_QUALITY_DISTRIBUTION)) tri::RequirePerFaceQuality(m);
+    if(mask & STAT_BORDER_LENGTH) tri::RequireFFAdjacency(m);
+    if(mask & STAT_VERT_QUALITY_HISTOGRAM) mask |= STAT_VERT_QUALITY;
+    if(mask & STAT_FACE_QUALITY_HISTOGRAM) mask |= STAT_FACE_QUALITY;
+    if(mask & STAT_FACE_EDGE_LENGTH_HISTOGRAM) mask |= STAT_FACE_EDGE_LENGTH;
+    s.mask = mask;
+    s.vertQualityHistogram.Clear();
+    s.faceQualityHistogram.Clear();
+    s.edgeLengthHistogram.Clear();
+    s.vertQualityDistribution.Clear();
+    s.faceQualityDistribution.Clear();
+
+    const int blockSize = 4096;
+    const bool vertPass = (mask & (STAT_CLOUD_BARYCENTER|STAT_VERT_QUALITY|STAT_VERT_QUALITY_DISTRIBUTION))!=0;
+    const bool facePass = (mask & (STAT_AREA|STAT_VOLUME|STAT_SHELL_BARYCENTER|STAT_FACE_QUALITY|STAT_FACE_QUALITY_DISTRIBUTION|
+                                   STAT_FACE_EDGE_LENGTH|STAT_BORDER_LENGTH))!=0;
+
+    // vertex sweep
+    const int vertNum = int(m.vert.size());
+    const int vertBlockNum = vertPass ? (vertNum+blockSize-1)/blockSize : 0;
+    std::vector<VertexPartial> vp(vertBlockNum);
+#pragma omp parallel
+    {
+      Distribution<ScalarType> qd;
+#pragma omp for schedule(dynamic,1)
+      for(int b=0;b<vertBlockNum;++b)
+      {
+        VertexPartial &p = vp[b];
+        const int end = std::min(vertNum,(b+1)*blockSize);
+        for(int i=b*blockSize;i<end;++i)
+        {
+          const VertexType &v = m.vert[i];
+          if(v.IsD() || (selectionOnly && !v.IsS())) continue;
+          ++p.cnt;
+          if(mask & STAT_CLOUD_BARYCENTER) p.bary += Point3d::Construct(v.cP());
+          if((mask & (STAT_VERT_QUALITY|STAT_VERT_QUALITY_DISTRIBUTION)) && !math::IsNAN(v.cQ()))
+          {
+            if(mask & STAT_VERT_QUALITY) p.q.Add(v.cQ());
+            if(mask & STAT_VERT_QUALITY_DISTRIBUTION) qd.Add(v.cQ());
+          }
+        }
+      }
+      if(mask & STAT_VERT_QUALITY_DISTRIBUTION)
+      {
+#pragma omp critical
+        s.vertQualityDistribution.Merge(qd);
+      }
+    }
+    VertexPartial vt;
+    for(int b=0;b<vertBlockNum;++b) vt.Merge(vp[b]);
+    s.vertNum = vt.cnt;
+    s.cloudBarycenter = Point3<ScalarType>::Construct(vt.bary/double(std::max<size_t>(vt.cnt,1)));
+    vt.q.Get(s.vertQualityMin,s.vertQualityMax,s.vertQualityAvg);
+
+    // face sweep
+    const int faceNum = int(m.face.size());
+    const int faceBlockNum = facePass ? (faceNum+blockSize-1)/blockSize : 0;
+    std::vector<FacePartial> fp(faceBlockNum);
+#pragma omp parallel
+    {
+      Distribution<ScalarType> qd;
+#pragma omp for schedule(dynamic,1)
+      for(int b=0;b<faceBlockNum;++b)
+      {
+        FacePartial &p = fp[b];
+        const int end = std::min(faceNum,(b+1)*blockSize);
+        for(int i=b*blockSize;i<end;++i)
+        {
+          const FaceType &f = m.face[i];
+          if(f.IsD() || (selectionOnly && !f.IsS())) continue;
+          ++p.cnt;
+          if(mask & (STAT_AREA|STAT_SHELL_BARYCENTER))
+          {
+            const double a = DoubleArea(f);
+            p.area += a;
+            if(mask & STAT_SHELL_BARYCENTER) p.bary += Point3d::Construct(Barycenter(f))*a;
+          }
+          if(mask & STAT_VOLUME)
+          {
+            const Point3d p0 = Point3d::Construct(f.cP(0)), p1 = Point3d::Construct(f.cP(1)), p2 = Point3d::Construct(f.cP(2));
+            p.volume += p0.dot(p1^p2);
+          }
+          if((mask & (STAT_FACE_QUALITY|STAT_FACE_QUALITY_DISTRIBUTION)) && !math::IsNAN(f.cQ()))
+          {
+            if(mask & STAT_FACE_QUALITY) p.q.Add(f.cQ());
+            if(mask & STAT_FACE_QUALITY_DISTRIBUTION) qd.Add(f.cQ());
+          }
+          if(mask & (STAT_FACE_EDGE_LENGTH|STAT_BORDER_LENGTH))
+            for(int k=0;k<3;++k)
+            {
+              const ScalarType len = Distance(f.cP0(k),f.cP1(k));
+              if(mask & STAT_FACE_EDGE_LENGTH) p.edge.Add(len);
+              if((mask & STAT_BORDER_LENGTH) && face::IsBorder(f,k)) p.border += len;
+            }
+        }
+      }
+      if(mask & STAT_FACE_QUALITY_DISTRIBUTION)
+      {
+#pragma omp critical
+        s.faceQualityDistribution.Merge(qd);
+      }
+    }
+    FacePartial ft;
+    for(int b=0;b<faceBlockNum;++b) ft.Merge(fp[b]);
+    s.faceNum = ft.cnt;
+    s.area = ScalarType(ft.area/2.0);
+    s.volume = ScalarType(ft.volume/6.0);
+    s.shellBarycenter = Point3<ScalarType>::Construct(ft.bary/(ft.area>0?ft.area:1.0));
+    s.borderLength = ScalarType(ft.border);
+    ft.q.Get(s.faceQualityMin,s.faceQualityMax,s.faceQualityAvg);
+    ft.edge.Get(s.edgeLengthMin,s.edgeLengthMax,s.edgeLengthAvg);
+    s.edgeLengthSum = ScalarType(ft.edge.sum);
+
+    // optional second sweep for the histograms, whose range is now known
+    if(mask & STAT_VERT_QUALITY_HISTOGRAM)
+    {
+      s.vertQualityHistogram.SetRange(s.vertQualityMin,s.vertQualityMax,histSize);
+#pragma omp parallel
+      {
+        Histogram<ScalarType> h;
+        h.SetRange(s.vertQualityMin,s.vertQualityMax,histSize);
+#pragma omp for schedule(static)
+        for(int i=0;i<vertNum;++i)
+        {
+          const VertexType &v = m.vert[i];
+          if(v.IsD() || (selectionOnly && !v.IsS())) continue;
+          if(!math::IsNAN(v.cQ())) h.Add(v.cQ());
+        }
+#pragma omp critical
+        s.vertQualityHistogram.Merge(h);
+      }
+    }
+    if(mask & (STAT_FACE_QUALITY_HISTOGRAM|STAT_FACE_EDGE_LENGTH_HISTOGRAM))
+    {
+      const bool qualityHist = (mask & STAT_FACE_QUALITY_HISTOGRAM)!=0;
+      const bool edgeHist = (mask & STAT_FACE_EDGE_LENGTH_HISTOGRAM)!=0;
+      if(qualityHist) s.faceQualityHistogram.SetRange(s.faceQualityMin,s.faceQualityMax,histSize);
+      if(edgeHist) s.edgeLengthHistogram.SetRange(0,s.edgeLengthMax,histSize);
+#pragma omp parallel
+      {
+        Histogram<ScalarType> qh, eh;
+        if(qualityHist) qh.SetRange(s.faceQualityMin,s.faceQualityMax,histSize);
+        if(edgeHist) eh.SetRange(0,s.edgeLengthMax,histSize);
+#pragma omp for schedule(static)
+        for(int i=0;i<faceNum;++i)
+        {
+          const FaceType &f = m.face[i];
+          if(f.IsD() || (selectionOnly && !f.IsS())) continue;
+          if(qualityHist && !math::IsNAN(f.cQ())) qh.Add(f.cQ());
+          if(edgeHist)
+            for(int k=0;k<3;++k)
+              eh.Add(Distance(f.cP0(k),f.cP1(k)));
+        }
+#pragma omp critical
+        {
+          if(qualityHist) s.faceQualityHistogram.Merge(qh);
+          if(edgeHist) s.edgeLengthHistogram.Merge(eh);
+        }
+      }
+    }
+  }
+
+private:
+  // Add the quality of the vertices (faces) to an empty accumulator (a cleared Distribution or QuantileSketch,
+  // a Histogram just after SetRange). Each thread fills a copy of h that is merged at the end.
+  template <class AccumulatorType>
+  static void AccumulatePerVertexQuality(const MeshType &m, AccumulatorType &h, bool selectionOnly)
+  {
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel
+    {
+      AccumulatorType ph(h);
+#pragma omp for schedule(static)
+      for(int i=0;i<vertNum;++i)
+      {
+        const VertexType &v = m.vert[i];
+        if(v.IsD() || (selectionOnly && !v.IsS())) continue;
+        if(!math::IsNAN(v.cQ())) ph.Add(v.cQ());
+      }
+#pragma omp critical
+      h.Merge(ph);
+    }
+  }
+
+  template <class AccumulatorType>
+  static void AccumulatePerFaceQuality(const MeshType &m, AccumulatorType &h, bool selectionOnly)
+  {
+    const int faceNum = int(m.face.size());
+#pragma omp parallel
+    {
+      AccumulatorType ph(h);
+#pragma omp for schedule(static)
+      for(int i=0;i<faceNum;++i)
+      {
+        const FaceType &f = m.face[i];
+        if(f.IsD() || (selectionOnly && !f.IsS())) continue;
+        if(!math::IsNAN(f.cQ())) ph.Add(f.cQ());
+      }
+#pragma omp critical
+      h.Merge(ph);
+    }
+  }
+
+  // min, max and sum of a set of values, in double; all zero when the set is empty
+  struct MinMaxSum
+  {
+    double minv, maxv, sum;
+    size_t cnt;
+    MinMaxSum() : minv(std::numeric_limits<double>::max()), maxv(std::numeric_limits<double>::lowest()), sum(0), cnt(0) {}
+    void Add(double v) { minv=std::min(minv,v); maxv=std::max(maxv,v); sum+=v; ++cnt; }
+    void Merge(const MinMaxSum &o) { minv=std::min(minv,o.minv); maxv=std::max(maxv,o.maxv); sum+=o.sum; cnt+=o.cnt; }
+    void Get(ScalarType &minV, ScalarType &maxV, ScalarType &avgV) const
+    {
+      if(cnt==0) { minV=maxV=avgV=ScalarType(0); return; }
+      minV=ScalarType(minv); maxV=ScalarType(maxv);
+      avgV=ScalarType(sum/double(cnt));
+    }
+  };
+
+  // partial results of a block of vertices / faces of ComputeStatistics
+  struct VertexPartial
+  {
+    size_t cnt;
+    Point3d bary;
+    MinMaxSum q;
+    VertexPartial() : cnt(0), bary(0,0,0) {}
+    void Merge(const VertexPartial &o) { cnt+=o.cnt; bary+=o.bary; q.Merge(o.q); }
+  };
+
+  struct FacePartial
+  {
+    size_t cnt;
+    double area, volume, border;
+    Point3d bary;
+    MinMaxSum q, edge;
+    FacePartial() : cnt(0), area(0), volume(0), border(0), bary(0,0,0) {}
+    void Merge(const FacePartial &o)
+    {
+      cnt+=o.cnt; area+=o.area; volume+=o.volume; border+=o.border; bary+=o.bary;
+      q.Merge(o.q); edge.Merge(o.edge);
+    }
+  };
+
 }; // end class
 
 } //End Namespace tri
@@ -0,0 +1,787 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+
+#ifndef __VCGLIB_STREAM_DECIMATION
+#define __VCGLIB_STREAM_DECIMATION
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+#include <vcg/complex/complex.h>
+#include <vcg/complex/algorithms/local_optimization.h>
+#include <vcg/complex/algorithms/local_optimization/tri_edge_collapse_quadric.h>
+#include <wrap/ply/plylib.h>
+#include <wrap/io_trimesh/import_ply.h>
+
+namespace vcg {
+namespace tri {
+
+/** \ingroup trimesh
+  Out-of-core quadric edge collapse simplification of a PLY mesh that does not fit in memory.
+
+  The mesh is never loaded as a whole. The input is read in streaming and its faces are partitioned,
+  following a Morton ordered grid, into spatially coherent blocks small enough to be simplified within
+  p.MemoryBudget. Each block is loaded and simplified on its own, keeping locked the vertices shared
+  with other blocks (the seams), and written back to disk. Then consecutive blocks are merged, as long
+  as they fit in the budget, the vertices that are no more shared are unlocked and the merged blocks are
+  simplified again, until a single block remains or no more blocks can be merged. Finally the blocks are
+  joined into the output mesh.
+
+  The per vertex quadrics are saved with the blocks and the ones of the seam vertices are summed when
+  merging, so that each vertex is simplified with the same quadric of the in-core simplification.
+  Each block is simplified to the target fraction of its original faces (or to p.TargetError), except the
+  faces around its locked vertices, that are left out of the budget until a merge unlocks them: this way
+  the seams are simplified by the following levels as much as the rest of the mesh. If the seams take so
+  much of the blocks that none of them can be merged, the blocks fall back to the plain target.
+
+  Besides the block being simplified, the memory holds a 32 bit cell index for each input vertex
+  and the list of the blocks using each seam vertex. The temporary files are named after p.TmpPrefix.
+  The QualityQuadric and QualityWeight options of the quadric parameters are not supported.
+
+  MeshType must have the per vertex components required by CollapseType (a TriEdgeCollapseQuadric).
+*/
+template <class MeshType, class CollapseType>
+class StreamDecimation
+{
+public:
+  typedef typename MeshType::ScalarType ScalarType;
+  typedef typename MeshType::CoordType CoordType;
+  typedef typename MeshType::VertexType VertexType;
+  typedef typename MeshType::VertexIterator VertexIterator;
+  typedef typename MeshType::FaceType FaceType;
+  typedef typename MeshType::FaceIterator FaceIterator;
+  typedef typename CollapseType::QH QH;
+  typedef math::Quadric<double> QuadricType;
+  typedef io::ImporterPLY<MeshType> PlyImporter;
+
+  class Parameter
+  {
+  public:
+    size_t MemoryBudget = size_t(1)<<30;   // Memory (bytes) that can be used by the block being simplified
+    double BytesPerFace = 400;             // Estimated memory needed by each face of a block during its simplification
+    size_t TargetFaceNum = 0;
+    double TargetError = std::numeric_limits<double>::max();
+    std::string TmpPrefix;                 // Prefix of the temporary files (the output name if empty)
+    TriEdgeCollapseQuadricParameter QParam;
+  };
+
+  Parameter p;
+
+  /// Simplify the PLY mesh inFile writing the result in outFile (binary PLY). Return false in case of error.
+  bool Process(const char *inFile, const char *outFile)
+  {
+    if(p.TmpPrefix.empty()) p.TmpPrefix = outFile;
+    const size_t blockFaces = std::max(size_t(1000),size_t(double(p.MemoryBudget)/p.BytesPerFace));
+
+    Box3<ScalarType> bb;
+    size_t vn=0, fn=0;
+    if(!ScanPly(inFile,bb,vn,fn)) return false;
+    if(vn>=size_t(std::numeric_limits<unsigned int>::max()) || (vn>0 && bb.IsNull()))
+    {
+      printf("Unable to simplify '%s': too many or no vertices\n",inFile);
+      return false;
+    }
+    printf("Streaming simplification of %zu vertices %zu faces in blocks of %zu faces\n",vn,fn,blockFaces);
+
+    // Grid of cubic cells, 2^k per side of the largest dimension of the box, about eight non empty cells for
+    // each block; cubic cells keep thin or flat meshes from being sliced across their thickness
+    gridBox=bb;
+    gridBox.Offset(bb.Diag()*1e-4);
+    const ScalarType gridDim=gridBox.Dim()[gridBox.MaxDim()];
+    gridBox.max=gridBox.min+CoordType(gridDim,gridDim,gridDim);
+    gridSide=1;
+    while(gridSide<128 && UsedCellNum(bb,gridSide)*blockFaces < 8.0*fn) gridSide*=2;
+
+    if(!SpoolPly(inFile,vn)) return false;
+    const size_t tn = totalFaces;
+    ratio = (tn>0) ? std::min(1.0,double(p.TargetFaceNum)/double(tn)) : 1.0;
+    seamBudget = true;
+
+    // The quadrics are computed here, once for all, with the scale factor of the whole mesh
+    p.QParam.PresetQuadric = true;
+    p.QParam.QualityQuadric = false;
+    p.QParam.QualityWeight = false;
+    if(p.QParam.ScaleIndependent)
+      p.QParam.ScaleFactor = 1e8*pow(1.0/double(bb.Diag()),6);
+
+    // Level 0: partition in blocks, then simplify each of them
+    std::vector<Block> blocks;
+    if(!Distribute(blockFaces,blocks)) return false;
+    for(size_t i=0;i<blocks.size();++i)
+    {
+      MeshType m;
+      std::vector<BlockVert> bv;
+      if(!LoadFirstLevel(blocks[i],m,bv)) return false;
+      if(!SimplifyAndSave(m,bv,blocks[i],1,i)) return false;
+    }
+
+    // Merge consecutive blocks as long as they fit in the budget and simplify them again
+    for(int level=1; blocks.size()>1; ++level)
+    {
+      std::vector<Block> merged;
+      size_t i=0;
+      while(i<blocks.size())
+      {
+        size_t j=i+1, faceNum=blocks[i].faceNum;
+        while(j<blocks.size() && faceNum+blocks[j].faceNum<=blockFaces)
+          faceNum+=blocks[j++].faceNum;
+        if(j==i+1) merged.push_back(blocks[i]);
+        else
+        {
+          MeshType m;
+          std::vector<BlockVert> bv;
+          Block b;
+          if(!LoadMerged(blocks,i,j,m,bv,b)) return false;
+          if(!SimplifyAndSave(m,bv,b,level+1,merged.size())) return false;
+          merged.push_back(b);
+        }
+        i=j;
+      }
+      if(merged.size()==blocks.size())
+      {
+        if(!seamBudget)
+        {
+          printf("Blocks cannot be merged within the memory budget: %zu seams are left unsimplified\n",blocks.size()-1);
+          break;
+        }
+        // The seams take too much of the blocks: simplify them to the plain target, so that they can be merged
+        printf("Level %i: the seams exceed the memory budget, simplifying the blocks to the plain target\n",level);
+        seamBudget=false;
+        for(size_t k=0;k<blocks.size();++k)
+        {
+          MeshType m;
+          std::vector<BlockVert> bv;
+          Block b;
+          if(!LoadMerged(blocks,k,k+1,m,bv,b)) return false;
+          if(!SimplifyAndSave(m,bv,b,level+1,k)) return false;
+          merged[k]=b;
+        }
+      }
+      blocks.swap(merged);
+      printf("Level %i: %zu blocks\n",level,blocks.size());
+    }
+
+    return Join(blocks,outFile);
+  }
+
+protected:
+  // A vertex of the first level blocks, with the number of blocks using it
+  struct FirstVert { unsigned int id; int occ; float p[3]; };
+  // A vertex of a simplified block; 'done' is set once the vertex has been unlocked (and its quadric completed)
+  struct BlockVert { unsigned int id; int occ; int done; float p[3]; QuadricType q; };
+  struct Block
+  {
+    std::string name;
+    size_t faceNum;
+    size_t origFaceNum;
+  };
+
+  unsigned int gridSide;
+  Box3<ScalarType> gridBox;
+  std::vector<unsigned int> cellOf;   // cell of each input vertex; the high bit marks the vertices used by their own block
+  size_t totalFaces;
+  double ratio;
+  bool seamBudget = true;             // the faces around the locked vertices are left out of the face budget
+
+  static const unsigned int OwnBit = 0x80000000u;
+
+  std::string VertRawName() const { return p.TmpPrefix+"_v.raw"; }
+  std::string FaceRawName() const { return p.TmpPrefix+"_f.raw"; }
+  std::string BlockName(int level, size_t i) const { return p.TmpPrefix+"_L"+std::to_string(level)+"_"+std::to_string(i); }
+
+  static unsigned int Morton(unsigned int x, unsigned int y, unsigned int z)
+  {
+    unsigned int m=0;
+    for(int b=0;b<7;++b)
+      m |= (((x>>b)&1u)<<(3*b)) | (((y>>b)&1u)<<(3*b+1)) | (((z>>b)&1u)<<(3*b+2));
+    return m;
+  }
+
+  /// Number of cells of a grid with the given side spanned by the box bb
+  double UsedCellNum(const Box3<ScalarType> &bb, unsigned int side) const
+  {
+    double n=1;
+    for(int i=0;i<3;++i)
+      n *= std::max(1.0,std::ceil(double(side)*(bb.max[i]-bb.min[i])/(gridBox.max[i]-gridBox.min[i])));
+    return n;
+  }
+
+  unsigned int CellOf(const ScalarType *pos) const
+  {
+    unsigned int c[3];
+    for(int i=0;i<3;++i)
+    {
+      double t = (double(pos[i])-gridBox.min[i])/(gridBox.max[i]-gridBox.min[i]);
+      c[i] = (unsigned int)(std::min(double(gridSide-1),std::max(0.0,t*gridSide)));
+    }
+    return Morton(c[0],c[1],c[2]);
+  }
+
+  /// Append-only writer on many files, each one opened only when its buffer is flushed
+  class SpoolWriter
+  {
+  public:
+    std::vector<std::string> names;
+    std::vector<std::vector<char> > buf;
+    size_t bufSize;
+    bool ok;
+
+    void Init(const std::vector<std::string> &_names, size_t _bufSize)
+    {
+      names=_names; bufSize=_bufSize; ok=true;
+      buf.clear(); buf.resize(names.size());
+      for(size_t i=0;i<names.size();++i)
+      {
+        FILE *fp=fopen(names[i].c_str(),"wb");
+        if(fp) fclose(fp); else ok=false;
+      }
+    }
+    void Append(size_t i, const void *data, size_t sz)
+    {
+      const char *c=(const char *)data;
+      buf[i].insert(buf[i].end(),c,c+sz);
+      if(buf[i].size()>=bufSize) Flush(i);
+    }
+    void Flush(size_t i)
+    {
+      if(buf[i].empty()) return;
+      FILE *fp=fopen(names[i].c_str(),"ab");
+      if(!fp) { ok=false; return; }
+      if(fwrite(&buf[i][0],1,buf[i].size(),fp)!=buf[i].size()) ok=false;
+      fclose(fp);
+      buf[i].clear();
+    }
+    bool FlushAll()
+    {
+      for(size_t i=0;i<buf.size();++i) { Flush(i); std::vector<char>().swap(buf[i]); }
+      return ok;
+    }
+  };
+
+  template <class T>
+  static bool ReadFile(const std::string &name, std::vector<T> &v)
+  {
+    v.clear();
+    FILE *fp=fopen(name.c_str(),"rb");
+    if(!fp) return false;
+    const size_t chunk=1<<16;
+    size_t rd;
+    do {
+      v.resize(v.size()+chunk);
+      rd=fread(&v[v.size()-chunk],sizeof(T),chunk,fp);
+      v.resize(v.size()-chunk+rd);
+    } while(rd==chunk);
+    fclose(fp);
+    return true;
+  }
+
+  template <class T>
+  static bool WriteFile(const std::string &name, const std::vector<T> &v)
+  {
+    FILE *fp=fopen(name.c_str(),"wb");
+    if(!fp) return false;
+    bool ok = v.empty() || fwrite(&v[0],sizeof(T),v.size(),fp)==v.size();
+    fclose(fp);
+    return ok;
+  }
+
+  /// Open a ply file for reading the vertex positions and the face indices
+  static bool OpenPly(vcg::ply::PlyFile &pf, const char *filename)
+  {
+    if(pf.Open(filename,vcg::ply::PlyFile::MODE_READ)==-1)
+    {
+      printf("Unable to open '%s'\n",filename);
+      return false;
+    }
+    for(int i=0;i<3;++i)
+      if(pf.AddToRead(PlyImporter::VertDesc(i))==-1 && pf.AddToRead(PlyImporter::VertDesc(24+i))==-1)
+      {
+        printf("No vertex positions in '%s'\n",filename);
+        return false;
+      }
+    if(pf.AddToRead(PlyImporter::FaceDesc(0))==-1)
+    {
+      int i=_FACEDESC_FIRST_;
+      while(i<_FACEDESC_LAST_ && pf.AddToRead(PlyImporter::FaceDesc(i))==-1) ++i;
+      if(i==_FACEDESC_LAST_)
+      {
+        printf("No faces in '%s'\n",filename);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// First pass: bounding box and element numbers.
+  /// The element numbers come from the header, so the file is read only up to the end of the vertices
+  bool ScanPly(const char *filename, Box3<ScalarType> &bb, size_t &vn, size_t &fn)
+  {
+    vcg::ply::PlyFile pf;
+    if(!OpenPly(pf,filename)) return false;
+    typename PlyImporter::template LoadPly_VertAux<ScalarType> va;
+    typename PlyImporter::template LoadPly_FaceAux<ScalarType> fa;
+    bb.SetNull();
+    vn=fn=0;
+    for(size_t i=0;i<pf.elements.size();++i)
+      if(!strcmp(pf.ElemName(i),"face")) fn=size_t(pf.ElemNumber(i));
+    for(size_t i=0;i<pf.elements.size();++i)
+    {
+      const int n=pf.ElemNumber(i);
+      pf.SetCurElement(i);
+      if(!strcmp(pf.ElemName(i),"vertex"))
+      {
+        vn=size_t(n);
+        for(int j=0;j<n;++j)
+        {
+          if(pf.Read(&va)==-1) { printf("Short file '%s'\n",filename); return false; }
+          bb.Add(CoordType(va.p[0],va.p[1],va.p[2]));
+        }
+        break;
+      }
+      // the elements before the vertices are skipped; the face properties have been added to the read ones
+      for(int j=0;j<n;++j)
+        if(pf.Read(strcmp(pf.ElemName(i),"face") ? 0 : &fa)==-1) { printf("Short file '%s'\n",filename); return false; }
+    }
+    return true;
+  }
+
+  /// Second pass: the cell of each vertex is computed and the positions and the triangles
+  /// (polygons are triangulated as fans) are spooled to raw temporary files
+  bool SpoolPly(const char *filename, size_t vn)
+  {
+    vcg::ply::PlyFile pf;
+    if(!OpenPly(pf,filename)) return false;
+    typename PlyImporter::template LoadPly_VertAux<ScalarType> va;
+    typename PlyImporter::template LoadPly_FaceAux<ScalarType> fa;
+    FILE *fv=fopen(VertRawName().c_str(),"wb");
+    FILE *ff=fopen(FaceRawName().c_str(),"wb");
+    if(!fv || !ff) { printf("Unable to write the temporary files '%s'\n",p.TmpPrefix.c_str()); return false; }
+    cellOf.clear();
+    cellOf.reserve(vn);
+    totalFaces=0;
+    bool ok=true;
+    for(size_t i=0;i<pf.elements.size() && ok;++i)
+    {
+      const int n=pf.ElemNumber(i);
+      pf.SetCurElement(i);
+      if(!strcmp(pf.ElemName(i),"vertex"))
+      {
+        for(int j=0;j<n && ok;++j)
+        {
+          if(pf.Read(&va)==-1) { ok=false; break; }
+          const float pos[3]={float(va.p[0]),float(va.p[1]),float(va.p[2])};
+          cellOf.push_back(CellOf(va.p));
+          ok = fwrite(pos,sizeof(float),3,fv)==3;
+        }
+      }
+      else if(!strcmp(pf.ElemName(i),"face"))
+      {
+        for(int j=0;j<n && ok;++j)
+        {
+          if(pf.Read(&fa)==-1) { ok=false; break; }
+          for(int k=1;k+1<int(fa.size);++k)
+          {
+            const int t[3]={fa.v[0],fa.v[k],fa.v[k+1]};
+            if(t[0]<0 || t[1]<0 || t[2]<0 || size_t(t[0])>=cellOf.size() || size_t(t[1])>=cellOf.size() || size_t(t[2])>=cellOf.size()) continue;
+            if(t[0]==t[1] || t[1]==t[2] || t[2]==t[0]) continue;
+            const unsigned int ut[3]={unsigned(t[0]),unsigned(t[1]),unsigned(t[2])};
+            ok = fwrite(ut,sizeof(unsigned int),3,ff)==3;
+            ++totalFaces;
+          }
+        }
+      }
+      else
+      {
+        for(int j=0;j<n && ok;++j)
+          if(pf.Read(0)==-1) ok=false;
+      }
+    }
+    fclose(fv);
+    fclose(ff);
+    if(!ok) printf("Error reading '%s' or writing the temporary files\n",filename);
+    return ok;
+  }
+
+  /// Third pass: the Morton ordered cells are grouped into blocks of at most blockFaces faces, each face goes to
+  /// the block of the first of its cells and each vertex is written in all the blocks that use it
+  bool Distribute(size_t blockFaces, std::vector<Block> &blocks)
+  {
+    const size_t cellNum=size_t(gridSide)*gridSide*gridSide;
+    std::vector<unsigned int> cellFaces(cellNum,0);
+    FILE *ff=fopen(FaceRawName().c_str(),"rb");
+    if(!ff) return false;
+    unsigned int t[3];
+    while(fread(t,sizeof(unsigned int),3,ff)==3)
+      ++cellFaces[std::min(cellOf[t[0]],std::min(cellOf[t[1]],cellOf[t[2]]))];
+
+    std::vector<unsigned int> blockOfCell(cellNum);
+    blocks.clear();
+    size_t cur=0;
+    for(size_t c=0;c<cellNum;++c)
+    {
+      if(blocks.empty() || (cur>0 && cur+cellFaces[c]>blockFaces))
+      {
+        if(!blocks.empty() && blocks.back().faceNum>blockFaces)
+          printf("Warning: a block of %zu faces exceeds the memory budget\n",blocks.back().faceNum);
+        Block b; b.name=BlockName(0,blocks.size()); b.faceNum=0; b.origFaceNum=0;
+        blocks.push_back(b);
+        cur=0;
+      }
+      cur+=cellFaces[c];
+      blocks.back().faceNum+=cellFaces[c];
+      blockOfCell[c]=unsigned(blocks.size()-1);
+    }
+    std::vector<unsigned int>().swap(cellFaces);
+    printf("Partitioned %zu faces in %zu blocks\n",totalFaces,blocks.size());
+
+    std::vector<std::string> fnames(blocks.size()), vnames(blocks.size());
+    for(size_t i=0;i<blocks.size();++i)
+    {
+      fnames[i]=blocks[i].name+".f";
+      vnames[i]=blocks[i].name+".v";
+      blocks[i].origFaceNum=blocks[i].faceNum;
+    }
+    const size_t bufSize = std::max(size_t(4096),std::min(size_t(1)<<20,p.MemoryBudget/(4*blocks.size())));
+    SpoolWriter sw;
+
+    // Faces, recording for each vertex whether it is used by its own block and by which other blocks
+    std::unordered_map<unsigned int,std::vector<unsigned int> > seam;
+    sw.Init(fnames,bufSize);
+    rewind(ff);
+    while(fread(t,sizeof(unsigned int),3,ff)==3)
+    {
+      const unsigned int c=std::min(cellOf[t[0]]&~OwnBit,std::min(cellOf[t[1]]&~OwnBit,cellOf[t[2]]&~OwnBit));
+      const unsigned int b=blockOfCell[c];
+      sw.Append(b,t,sizeof(t));
+      for(int k=0;k<3;++k)
+      {
+        if(blockOfCell[cellOf[t[k]]&~OwnBit]==b) cellOf[t[k]]|=OwnBit;
+        else
+        {
+          std::vector<unsigned int> &sb=seam[t[k]];
+          if(std::find(sb.begin(),sb.end(),b)==sb.end()) sb.push_back(b);
+        }
+      }
+    }
+    fclose(ff);
+    remove(FaceRawName().c_str());
+    if(!sw.FlushAll()) return false;
+
+    // Vertices, in index order
+    sw.Init(vnames,bufSize);
+    FILE *fv=fopen(VertRawName().c_str(),"rb");
+    if(!fv) return false;
+    FirstVert fvr;
+    for(size_t i=0;i<cellOf.size();++i)
+    {
+      if(fread(fvr.p,sizeof(float),3,fv)!=3) { fclose(fv); return false; }
+      fvr.id=unsigned(i);
+      typename std::unordered_map<unsigned int,std::vector<unsigned int> >::const_iterator si=seam.find(fvr.id);
+      const bool own = (cellOf[i]&OwnBit)!=0;
+      fvr.occ = (own?1:0) + (si==seam.end() ? 0 : int(si->second.size()));
+      if(own) sw.Append(blockOfCell[cellOf[i]&~OwnBit],&fvr,sizeof(fvr));
+      if(si!=seam.end())
+        for(size_t k=0;k<si->second.size();++k)
+          sw.Append(si->second[k],&fvr,sizeof(fvr));
+    }
+    fclose(fv);
+    remove(VertRawName().c_str());
+    std::vector<unsigned int>().swap(cellOf);
+    return sw.FlushAll();
+  }
+
+  static void FacePlane(const FaceType &f, bool useArea, Plane3<ScalarType,false> &facePlane)
+  {
+    facePlane.SetDirection( ( f.cV(1)->cP() - f.cV(0)->cP() ) ^  ( f.cV(2)->cP() - f.cV(0)->cP() ));
+    if(!useArea) facePlane.Normalize();
+    facePlane.SetOffset( facePlane.Direction().dot(f.cV(0)->cP()));
+  }
+
+  bool LoadFirstLevel(const Block &b, MeshType &m, std::vector<BlockVert> &bv)
+  {
+    std::vector<FirstVert> fv;
+    std::vector<unsigned int> fi;
+    if(!ReadFile(b.name+".v",fv) || !ReadFile(b.name+".f",fi)) return false;
+    remove((b.name+".v").c_str());
+    remove((b.name+".f").c_str());
+    bv.resize(fv.size());
+    for(size_t i=0;i<fv.size();++i)
+    {
+      bv[i].id=fv[i].id; bv[i].occ=fv[i].occ; bv[i].done=0;
+      bv[i].p[0]=fv[i].p[0]; bv[i].p[1]=fv[i].p[1]; bv[i].p[2]=fv[i].p[2];
+      bv[i].q.SetZero();
+    }
+    std::vector<FirstVert>().swap(fv);
+    if(!BuildMesh(m,bv,fi)) return false;
+
+    // Face quadrics, for all the vertices (also the locked ones, that will be summed when merging)
+    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+    {
+      Plane3<ScalarType,false> facePlane;
+      FacePlane(*fi,p.QParam.UseArea,facePlane);
+      QuadricType q;
+      q.ByPlane(facePlane);
+      for(int j=0;j<3;++j)
+        bv[tri::Index(m,(*fi).V(j))].q += q;
+    }
+    return true;
+  }
+
+  /// Load the blocks [i0,i1) in a single mesh: the vertices with the same id are merged summing their quadrics
+  bool LoadMerged(const std::vector<Block> &blocks, size_t i0, size_t i1, MeshType &m, std::vector<BlockVert> &bv, Block &mb)
+  {
+    std::vector<BlockVert> tv;
+    std::vector<unsigned int> fi, tf;
+    bv.clear();
+    mb.origFaceNum=0;
+    for(size_t i=i0;i<i1;++i)
+    {
+      if(!ReadFile(blocks[i].name+".v",tv) || !ReadFile(blocks[i].name+".f",tf)) return false;
+      remove((blocks[i].name+".v").c_str());
+      remove((blocks[i].name+".f").c_str());
+      bv.insert(bv.end(),tv.begin(),tv.end());
+      fi.insert(fi.end(),tf.begin(),tf.end());
+      mb.origFaceNum+=blocks[i].origFaceNum;
+    }
+    std::sort(bv.begin(),bv.end(),[](const BlockVert &a, const BlockVert &b){return a.id<b.id;});
+    size_t n=0;
+    for(size_t i=0;i<bv.size();)
+    {
+      size_t j=i+1;
+      bv[n]=bv[i];
+      for(;j<bv.size() && bv[j].id==bv[i].id;++j)
+      {
+        bv[n].q += bv[j].q;
+        bv[n].done = std::max(bv[n].done,bv[j].done);
+      }
+      bv[n].occ -= int(j-i)-1;  // the copies found here are now a single one
+      ++n;
+      i=j;
+    }
+    bv.resize(n);
+    return BuildMesh(m,bv,fi);
+  }
+
+  static bool BuildMesh(MeshType &m, const std::vector<BlockVert> &bv, const std::vector<unsigned int> &fi)
+  {
+    m.Clear();
+    if(bv.empty()) return true;
+    VertexIterator vi=Allocator<MeshType>::AddVertices(m,bv.size());
+    for(size_t i=0;i<bv.size();++i,++vi)
+      (*vi).P()=CoordType(bv[i].p[0],bv[i].p[1],bv[i].p[2]);
+    FaceIterator fi0=Allocator<MeshType>::AddFaces(m,fi.size()/3);
+    for(size_t i=0;i<fi.size()/3;++i,++fi0)
+      for(int j=0;j<3;++j)
+      {
+        typename std::vector<BlockVert>::const_iterator it =
+            std::lower_bound(bv.begin(),bv.end(),fi[3*i+j],[](const BlockVert &a, unsigned int id){return a.id<id;});
+        if(it==bv.end() || it->id!=fi[3*i+j]) { printf("Inconsistent temporary block\n"); return false; }
+        (*fi0).V(j)=&m.vert[it-bv.begin()];
+      }
+    return true;
+  }
+
+  /// Simplify a block with its seam vertices locked, and write it to disk
+  bool SimplifyAndSave(MeshType &m, std::vector<BlockVert> &bv, Block &b, int level, size_t index)
+  {
+    const size_t startFn=size_t(m.fn);
+    tri::UpdateTopology<MeshType>::VertexFace(m);
+    tri::UpdateFlags<MeshType>::FaceBorderFromVF(m);
+    for(size_t i=0;i<bv.size();++i)
+    {
+      if(bv[i].occ>1) m.vert[i].ClearW();
+      else m.vert[i].SetW();
+    }
+
+    // The faces around the locked vertices stay (almost) at full resolution until their seam is unlocked by a
+    // merge: they get their own face budget, otherwise the rest of the block would be over-simplified to make room
+    // for them and, once unlocked, they would already meet the target. Being locked since the first level,
+    // they are counted as original faces: the rest of the block is simplified to the target fraction of the others.
+    size_t lockedFn=0;
+    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+      if(!(*fi).V(0)->IsW() || !(*fi).V(1)->IsW() || !(*fi).V(2)->IsW()) ++lockedFn;
+    if(!seamBudget) lockedFn=0;
+    const double targetFn = ratio*double(b.origFaceNum-std::min(lockedFn,b.origFaceNum)) + double(lockedFn);
+
+    // Border quadrics of the vertices unlocked now: their border edges cannot be seams
+    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+      for(int j=0;j<3;++j)
+        if((*fi).IsB(j))
+        {
+          Plane3<ScalarType,false> facePlane, borderPlane;
+          FacePlane(*fi,p.QParam.UseArea,facePlane);
+          borderPlane.SetDirection(facePlane.Direction() ^ (( (*fi).V1(j)->cP() - (*fi).V(j)->cP() ).normalized()));
+          borderPlane.SetDirection(borderPlane.Direction()* (ScalarType)(p.QParam.BoundaryQuadricWeight ));
+          borderPlane.SetOffset(borderPlane.Direction().dot((*fi).V(j)->cP()));
+          QuadricType bq;
+          bq.ByPlane(borderPlane);
+          const size_t i0=tri::Index(m,(*fi).V(j)), i1=tri::Index(m,(*fi).V1(j));
+          if(bv[i0].occ<=1 && !bv[i0].done) bv[i0].q+=bq;
+          if(bv[i1].occ<=1 && !bv[i1].done) bv[i1].q+=bq;
+        }
+    for(size_t i=0;i<bv.size();++i)
+    {
+      if(bv[i].occ<=1) bv[i].done=1;
+      QH::Qd(m.vert[i])=bv[i].q;
+    }
+
+    if(m.fn>0)
+    {
+      LocalOptimization<MeshType> session(m,&p.QParam);
+      session.UseIndexedHeap=true;
+      session.template Init<CollapseType>();
+      session.SetTargetSimplices(int(std::min<double>(std::numeric_limits<int>::max(),targetFn+0.5)));
+      if(p.TargetError<std::numeric_limits<double>::max()) session.SetTargetMetric(ScalarType(p.TargetError));
+      session.DoOptimization();
+      session.template Finalize<CollapseType>();
+    }
+
+    // Save the alive vertices that are used by a face or locked (they are still used by other blocks)
+    tri::UpdateFlags<MeshType>::VertexClearV(m);
+    std::vector<BlockVert> ov;
+    std::vector<unsigned int> of;
+    of.reserve(size_t(m.fn)*3);
+    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+      if(!(*fi).IsD())
+        for(int j=0;j<3;++j)
+        {
+          (*fi).V(j)->SetV();
+          of.push_back(bv[tri::Index(m,(*fi).V(j))].id);
+        }
+    for(size_t i=0;i<bv.size();++i)
+      if(!m.vert[i].IsD() && (m.vert[i].IsV() || bv[i].occ>1))
+      {
+        BlockVert v=bv[i];
+        v.p[0]=float(m.vert[i].P()[0]); v.p[1]=float(m.vert[i].P()[1]); v.p[2]=float(m.vert[i].P()[2]);
+        v.q=QH::Qd(m.vert[i]);
+        ov.push_back(v);
+      }
+    b.name=BlockName(level,index);
+    b.faceNum=of.size()/3;
+    printf("Level %i block %4zu: %9zu -> %9zu faces\n",level-1,index,startFn,b.faceNum);
+    if(!WriteFile(b.name+".v",ov) || !WriteFile(b.name+".f",of))
+    {
+      printf("Unable to write the temporary block '%s'\n",b.name.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /// Join the blocks into the output binary PLY; the seam vertices left are shared by their blocks
+  bool Join(const std::vector<Block> &blocks, const char *outFile)
+  {
+    const std::string vName=p.TmpPrefix+"_out.v", fName=p.TmpPrefix+"_out.f";
+    FILE *fv=fopen(vName.c_str(),"wb");
+    FILE *ff=fopen(fName.c_str(),"wb");
+    if(!fv || !ff) return false;
+    std::unordered_map<unsigned int,unsigned int> seamIdx;
+    unsigned int vCnt=0;
+    size_t fCnt=0;
+    bool ok=true;
+    for(size_t i=0;i<blocks.size() && ok;++i)
+    {
+      std::vector<BlockVert> bv;
+      std::vector<unsigned int> fi;
+      if(!ReadFile(blocks[i].name+".v",bv) || !ReadFile(blocks[i].name+".f",fi)) { ok=false; break; }
+      remove((blocks[i].name+".v").c_str());
+      remove((blocks[i].name+".f").c_str());
+      std::vector<std::pair<unsigned int,unsigned int> > idx(bv.size());
+      for(size_t j=0;j<bv.size() && ok;++j)
+      {
+        unsigned int vi=vCnt;
+        bool isNew=true;
+        if(bv[j].occ>1)
+        {
+          std::pair<std::unordered_map<unsigned int,unsigned int>::iterator,bool> ins=seamIdx.insert(std::make_pair(bv[j].id,vCnt));
+          isNew=ins.second;
+          vi=ins.first->second;
+        }
+        if(isNew)
+        {
+          ok = fwrite(bv[j].p,sizeof(float),3,fv)==3;
+          ++vCnt;
+        }
+        idx[j]=std::make_pair(bv[j].id,vi);
+      }
+      std::sort(idx.begin(),idx.end());
+      for(size_t j=0;j+2<fi.size() && ok;j+=3)
+      {
+        unsigned char c=3;
+        int f[3];
+        for(int k=0;k<3 && ok;++k)
+        {
+          std::vector<std::pair<unsigned int,unsigned int> >::const_iterator it=
+              std::lower_bound(idx.begin(),idx.end(),std::make_pair(fi[j+k],0u));
+          if(it==idx.end() || it->first!=fi[j+k]) { printf("Inconsistent temporary block\n"); ok=false; break; }
+          f[k]=int(it->second);
+        }
+        if(!ok) break;
+        ok = fwrite(&c,1,1,ff)==1 && fwrite(f,sizeof(int),3,ff)==3;
+        ++fCnt;
+      }
+    }
+    fclose(fv);
+    fclose(ff);
+    if(ok) ok=WritePly(outFile,vName,fName,vCnt,fCnt);
+    remove(vName.c_str());
+    remove(fName.c_str());
+    if(ok) printf("Saved %u vertices %zu faces in '%s'\n",vCnt,fCnt,outFile);
+    else printf("Unable to write '%s'\n",outFile);
+    return ok;
+  }
+
+  static bool WritePly(const char *outFile, const std::string &vName, const std::string &fName, unsigned int vn, size_t fn)
+  {
+    FILE *fp=fopen(outFile,"wb");
+    if(!fp) return false;
+    const unsigned int one=1;
+    const bool littleEndian = *((const unsigned char *)&one)==1;
+    fprintf(fp,"ply\nformat %s 1.0\nelement vertex %u\nproperty float x\nproperty float y\nproperty float z\n"
+               "element face %zu\nproperty list uchar int vertex_indices\nend_header\n",
+            littleEndian?"binary_little_endian":"binary_big_endian",vn,fn);
+    bool ok=true;
+    std::vector<char> buf(1<<20);
+    const std::string src[2]={vName,fName};
+    for(int i=0;i<2 && ok;++i)
+    {
+      FILE *fi=fopen(src[i].c_str(),"rb");
+      if(!fi) { ok=false; break; }
+      size_t rd;
+      while(ok && (rd=fread(&buf[0],1,buf.size(),fi))>0)
+        ok = fwrite(&buf[0],1,rd,fp)==rd;
+      fclose(fi);
+    }
+    fclose(fp);
+    return ok;
+  }
+};
+
+} // end namespace tri
+} // end namespace vcg
+#endif
@@ -39,16 +39,47 @@ typedef ComputeMeshType MeshType;
 typedef typename MeshType::VertexType     VertexType;
 typedef typename MeshType::VertexPointer  VertexPointer;
 typedef typename MeshType::VertexIterator VertexIterator;
+typedef typename MeshType::CoordType      CoordType;
 
 /// \brief Calculates the bounding box of the given mesh m
 
 static void Box(ComputeMeshType &m)
 {
 	m.bbox.SetNull();
+	// compact mesh with the positions packed in their own array (vertex::CoordOcf): plain scan of the coords
+	const CoordType *pv = tri::VertexVectorCoordData(m.vert);
+	if(pv!=0 && m.vn==int(m.vert.size()))
+	{
+		for(size_t i=0;i<m.vert.size();++i)
+			m.bbox.Add(pv[i]);
+		return;
+	}
 	for(VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
 		if( !(*vi).IsD() )	m.bbox.Add((*vi).cP());
 }
 
+/// \brief Lazily updates the bounding box using the dirty region recorded by the Allocator (see Allocator::EnableDirtyTracking()).
+/// The box is grown with the dirty vertices; it is recomputed from scratch only when a vertex lying on its boundary
+/// has been moved or deleted (or when tracking is not enabled). The bounding box part of the region is then cleared.
+
+static void BoxDirty(ComputeMeshType &m)
+{
+	DirtyRegion *dr = Allocator<ComputeMeshType>::GetDirtyRegion(m);
+	if(dr==nullptr || dr->boxShrink || dr->boxVert.all)
+	{
+		Box(m);
+		if(dr) { dr->boxVert.Clear(); dr->boxShrink=false; }
+		return;
+	}
+	for(size_t i=0;i<dr->boxVert.idx.size();++i)
+	{
+		const size_t vi = dr->boxVert.idx[i];
+		if(vi<m.vert.size() && !m.vert[vi].IsD())
+			m.bbox.Add(m.vert[vi].cP());
+	}
+	dr->boxVert.Clear();
+}
+
 
 }; // end class
 
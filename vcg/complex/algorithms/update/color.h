@@ -33,6 +33,7 @@
 #include <vcg/math/random_generator.h>
 #include <vcg/complex/algorithms/clean.h>
 #include <vcg/complex/algorithms/stat.h>
+#include <vcg/complex/algorithms/vf_adjacency_csr.h>
 
 namespace vcg {
 namespace tri {
@@ -165,38 +166,35 @@ public:
 	/** \brief Transfer face color onto vertex color
 
   Plain average of the color of the faces incident on a given vertex.
-  No adjacency required.
+  No adjacency component required: each vertex gathers the colors of its faces
+  from a temporary VFAdjacencyCSR, so the vertices are processed in parallel.
   */
 	static void PerVertexFromFace( MeshType &m)
 	{
 		RequirePerFaceColor(m);
 		RequirePerVertexColor(m);
 
-		ColorAvgInfo csi;
-		csi.r=0; csi.g=0; csi.b=0; csi.cnt=0;
-		SimpleTempData<typename MeshType::VertContainer, ColorAvgInfo> TD(m.vert,csi);
-
-		FaceIterator fi;
-		for(fi=m.face.begin();fi!=m.face.end();++fi)
-			if(!(*fi).IsD())
-				for(int j=0;j<3;++j)
-				{
-					TD[(*fi).V(j)].r+=(*fi).C()[0];
-					TD[(*fi).V(j)].g+=(*fi).C()[1];
-					TD[(*fi).V(j)].b+=(*fi).C()[2];
-					TD[(*fi).V(j)].a+=(*fi).C()[3];
-					++TD[(*fi).V(j)].cnt;
-				}
-
-		VertexIterator vi;
-		for(vi=m.vert.begin();vi!=m.vert.end();++vi)
-			if(!(*vi).IsD() && TD[*vi].cnt>0 )
+		VFAdjacencyCSR<MeshType> vfa(m);
+		const std::vector<size_t> &off = vfa.Offset();
+		const std::vector<typename VFAdjacencyCSR<MeshType>::Entry> &ent = vfa.Entries();
+		const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+		{
+			VertexType &v = m.vert[i];
+			if(v.IsD() || off[i]==off[i+1]) continue;
+			unsigned int r=0, g=0, b=0, a=0;
+			for(size_t k=off[i];k<off[i+1];++k)
 			{
-				(*vi).C()[0] = TD[*vi].r / TD[*vi].cnt;
-				(*vi).C()[1] = TD[*vi].g / TD[*vi].cnt;
-				(*vi).C()[2] = TD[*vi].b / TD[*vi].cnt;
-				(*vi).C()[3] = TD[*vi].a / TD[*vi].cnt;
+				const Color4b &c = ent[k].f->cC();
+				r+=c[0]; g+=c[1]; b+=c[2]; a+=c[3];
 			}
+			const unsigned int cnt = (unsigned int)(off[i+1]-off[i]);
+			v.C()[0] = r / cnt;
+			v.C()[1] = g / cnt;
+			v.C()[2] = b / cnt;
+			v.C()[3] = a / cnt;
+		}
 	}
 
 	/*! \brief Transfer vertex color onto face color
@@ -207,19 +205,23 @@ public:
 		RequirePerFaceColor(m);
 		RequirePerVertexColor(m);
 
-		FaceIterator fi;
-		for(fi=m.face.begin();fi!=m.face.end();++fi) if(!(*fi).IsD())
+		const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
 		{
-			Color4f avg = (Color4f::Construct((*fi).V(0)->C()) +
-			               Color4f::Construct((*fi).V(1)->C()) +
-			               Color4f::Construct((*fi).V(2)->C()) )/ 3.0;
-			(*fi).C().Import(avg);
+			FaceType &f = m.face[i];
+			if(f.IsD()) continue;
+			Color4f avg = (Color4f::Construct(f.V(0)->C()) +
+			               Color4f::Construct(f.V(1)->C()) +
+			               Color4f::Construct(f.V(2)->C()) )/ 3.0;
+			f.C().Import(avg);
 		}
 	}
 
-	/*! \brief This function colores all the faces of a mesh with a hue color shade dependent on the quality.
+	/*! \brief This function colores all the vertices of a mesh with a hue color shade dependent on the quality.
 
   If no range of quality is passed it is automatically computed.
+  The ramp is sampled once in a ColorMapLUT and the vertices are colored in parallel.
   */
 	static void PerVertexQualityRamp(MeshType &m, ScalarType minq = 0., ScalarType maxq = 0., vcg::ColorMap cmap = vcg::ColorMap::RGB)
 	{
@@ -232,10 +234,12 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-			if(!(*vi).IsD()) {
-				(*vi).C() = vcg::GetColorMapping((*vi).Q(), minq, maxq, cmap);
-			}
+		const ColorMapLUT lut(minq, maxq, cmap);
+		const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+			if(!m.vert[i].IsD())
+				m.vert[i].C() = lut(m.vert[i].Q());
 	}
 
 
@@ -254,9 +258,13 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-			if(!(*vi).IsD())
-				(*vi).C().SetColorRampParula(minq, maxq, (*vi).Q());
+		const ColorMapLUT lut(minq, maxq, [](double v, double mi, double ma) {
+			Color4b c; c.SetColorRampParula(float(mi), float(ma), float(v)); return c; });
+		const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+			if(!m.vert[i].IsD())
+				m.vert[i].C() = lut(m.vert[i].Q());
 	}
 
 	/*! \brief This function colores all the faces of a mesh with a hue color shade dependent on the quality.
@@ -275,9 +283,10 @@ public:
 			maxq=minmax.second;
 		}
 
+		const ColorMapLUT lut(minq, maxq, cmap);
 		ForEachTetra(m, [&] (TetraType & t){
 			if (!selected || t.IsS())
-				t.C() = vcg::GetColorMapping(t.Q(), minq, maxq, cmap);
+				t.C() = lut(t.Q());
 		});
 	}
 	/*! \brief This function colores all the faces of a mesh with a hue color shade dependent on the quality.
@@ -295,10 +304,13 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(FaceIterator fi = m.face.begin();fi != m.face.end(); ++fi)
-			if(!(*fi).IsD())
-				if(!selected || (*fi).IsS())
-					(*fi).C() = vcg::GetColorMapping((*fi).Q(), minq, maxq, cmap);
+		const ColorMapLUT lut(minq, maxq, cmap);
+		const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			if(!m.face[i].IsD())
+				if(!selected || m.face[i].IsS())
+					m.face[i].C() = lut(m.face[i].Q());
 	}
 
 	/*! \brief This function colores all the edges of a mesh with a hue color shade dependent on the quality.
@@ -316,9 +328,13 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(EdgeIterator ei=m.edge.begin();ei!=m.edge.end();++ei) if(!(*ei).IsD())
-			if(!selected || (*ei).IsS())
-				(*ei).C() = vcg::GetColorMapping((*ei).Q(), minq, maxq, cmap);
+		const ColorMapLUT lut(minq, maxq, cmap);
+		const int edgeNum = int(m.edge.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<edgeNum;++i)
+			if(!m.edge[i].IsD())
+				if(!selected || m.edge[i].IsS())
+					m.edge[i].C() = lut(m.edge[i].Q());
 	}
 
 	/*! \brief This function colores all the vertices of a mesh with a gray shade dependent on the quality.
@@ -335,9 +351,11 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-			if(!(*vi).IsD())
-				(*vi).C().SetGrayShade( ((*vi).Q()-minq)/(maxq-minq));
+		const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<vertNum;++i)
+			if(!m.vert[i].IsD())
+				m.vert[i].C().SetGrayShade( (m.vert[i].Q()-minq)/(maxq-minq));
 	}
 
 	/*! \brief This function colores all the faces of a mesh with a gray shade dependent on the quality.
@@ -355,8 +373,11 @@ public:
 			minq=minmax.first;
 			maxq=minmax.second;
 		}
-		for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi) if(!(*fi).IsD())
-			(*fi).C().SetGrayShade( ((*fi).Q()-minq)/(maxq-minq));
+		const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<faceNum;++i)
+			if(!m.face[i].IsD())
+				m.face[i].C().SetGrayShade( (m.face[i].Q()-minq)/(maxq-minq));
 	}
 
 	/** \brief Color the vertexes of the mesh that are on the border
@@ -405,17 +426,15 @@ It require FaceFace Adjacency becouse it relies on the output of the ConnecteCom
 		RequirePerFaceColor(m);
 		RequireFFAdjacency(m);
 
-		std::vector< std::pair<int, typename MeshType::FacePointer> > CCV;
-		int ScatterSize= std::min (100,tri::Clean<MeshType>::ConnectedComponents(m, CCV)); // number of random color to be used. Never use too many.
+		std::vector<int> label;
+		int ScatterSize= std::min (100,tri::Clean<MeshType>::ConnectedComponentsLabel(m, label)); // number of random color to be used. Never use too many.
 
-		ConnectedComponentIterator<MeshType> ci;
-		for(unsigned int i=0;i<CCV.size();++i)
-		{
-			Color4b BaseColor = Color4b::Scatter(ScatterSize, i%ScatterSize,.4f,.7f);
-			std::vector<typename MeshType::FacePointer> FPV;
-			for(ci.start(m,CCV[i].second);!ci.completed();++ci)
-				(*ci)->C()=BaseColor;
-		}
+		std::vector<Color4b> BaseColor(ScatterSize);
+		for(int i=0;i<ScatterSize;++i)
+			BaseColor[i] = Color4b::Scatter(ScatterSize, i,.4f,.7f);
+		for(size_t i=0;i<m.face.size();++i)
+			if(label[i]>=0)
+				m.face[i].C()=BaseColor[label[i]%ScatterSize];
 	}
 
 	/*! \brief This function colores the face of a mesh randomly.
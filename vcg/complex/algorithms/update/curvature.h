@@ -30,6 +30,7 @@
 #include <vcg/complex/algorithms/point_sampling.h>
 #include <vcg/complex/algorithms/intersection.h>
 #include <vcg/complex/algorithms/inertia.h>
+#include <vcg/space/index/kdtree/kdtree.h>
 #include <Eigen/Core>
 
 namespace vcg {
@@ -275,65 +276,128 @@ If pointVSfaceInt==false the covariance is computed by (analytic)integration ove
 
   static void PrincipalDirectionsPCA(MeshType &m, ScalarType r, bool pointVSfaceInt = true,vcg::CallBackPos * cb = NULL)
   {
-    std::vector<VertexType*> closests;
-    std::vector<ScalarType> distances;
-    std::vector<CoordType> points;
-    VertexIterator vi;
-    ScalarType area;
-    MeshType tmpM;
-    typename std::vector<CoordType>::iterator ii;
-    vcg::tri::TrivialSampler<MeshType> vs;
+    if(m.vert.empty()) return;
+    if(pointVSfaceInt)
+    {
+      VertexConstDataWrapper<MeshType> ww(m);
+      KdTree<ScalarType> vertexTree(ww);
+      PrincipalDirectionsPCA(m,r,vertexTree,cb);
+      return;
+    }
+
     tri::UpdateNormal<MeshType>::PerVertexAngleWeighted(m);
     tri::UpdateNormal<MeshType>::NormalizePerVertex(m);
 
-    MeshGridType mGrid;
-    PointsGridType pGrid;
-
-    // Fill the grid used
-    if(pointVSfaceInt)
+    // the faces touching the sphere are searched among the ones whose barycenter is closer than r plus the largest face radius
+    std::vector<CoordType> bary(m.face.size());
+    ScalarType maxFaceRadius=0;
+    for(size_t i=0;i<m.face.size();++i)
     {
-      area = Stat<MeshType>::ComputeMeshArea(m);
-      vcg::tri::SurfaceSampling<MeshType,vcg::tri::TrivialSampler<MeshType> >::Montecarlo(m,vs,1000 * area / (2*M_PI*r*r ));
-      vi = vcg::tri::Allocator<MeshType>::AddVertices(tmpM,m.vert.size());
-      for(size_t y  = 0; y <  m.vert.size(); ++y,++vi)  (*vi).P() =  m.vert[y].P();
-      pGrid.Set(tmpM.vert.begin(),tmpM.vert.end());
+      bary[i] = Barycenter(m.face[i]);
+      if(m.face[i].IsD()) continue;
+      for(int j=0;j<3;++j)
+        maxFaceRadius = std::max(maxFaceRadius,Distance(bary[i],m.face[i].cP(j)));
     }
-    else
+    if(bary.empty()) return;
+    VectorConstDataWrapper<std::vector<CoordType> > bw(bary);
+    KdTree<ScalarType> faceTree(bw);
+    const ScalarType queryRadius = (r+maxFaceRadius)*ScalarType(1.001);
+
+    const int vertNum = int(m.vert.size());
+    const int blockSize = 4096;
+    for(int block=0;block<vertNum;block+=blockSize)
     {
-      mGrid.Set(m.face.begin(),m.face.end());
+      if(cb) (*cb)(int(100.0f * (float)block / (float)vertNum),"Vertices Analysis");
+      const int blockEnd = std::min(vertNum,block+blockSize);
+#pragma omp parallel
+      {
+        // per thread scratch: the candidate faces and the clipped neighborhood
+        MeshType candM, ballM;
+        std::vector<unsigned int> candIdx;
+        std::vector<ScalarType> candDist;
+#pragma omp for schedule(dynamic,64)
+        for(int i=block;i<blockEnd;++i)
+        {
+          VertexType &v = m.vert[i];
+          if(v.IsD()) continue;
+          candIdx.clear(); candDist.clear();
+          faceTree.doQueryDist(v.cP(),queryRadius,candIdx,candDist);
+          std::sort(candIdx.begin(),candIdx.end());
+          candM.Clear();
+          size_t fn=0;
+          for(size_t j=0;j<candIdx.size();++j) if(!m.face[candIdx[j]].IsD()) ++fn;
+          VertexIterator cvi = Allocator<MeshType>::AddVertices(candM,fn*3);
+          FaceIterator cfi = Allocator<MeshType>::AddFaces(candM,fn);
+          for(size_t j=0;j<candIdx.size();++j)
+          {
+            const FaceType &f = m.face[candIdx[j]];
+            if(f.IsD()) continue;
+            for(int k=0;k<3;++k,++cvi)
+            {
+              (*cvi).P() = f.cP(k);
+              (*cfi).V(k) = &*cvi;
+            }
+            ++cfi;
+          }
+          IntersectionBallMesh<MeshType,ScalarType>(candM,vcg::Sphere3<ScalarType>(v.cP(),r),ballM);
+          vcg::Point3<ScalarType> _bary;
+          vcg::Matrix33<ScalarType> A;
+          vcg::tri::Inertia<MeshType>::Covariance(ballM,_bary,A);
+          PrincipalDirectionsFromCovariance(v,A,r);
+        }
+      }
     }
+  }
 
-    int jj = 0;
-    for(vi  = m.vert.begin(); vi != m.vert.end(); ++vi)
-    {
-      vcg::Matrix33<ScalarType> A, eigenvectors;
-      vcg::Point3<ScalarType> bp, eigenvalues;
-//      int nrot;
+  /// \brief PCA curvature (see above) computed by point integration using a prebuilt kd-tree on the mesh vertices.
+  /// The tree can be shared by several calls, e.g. for computing the curvature at multiple scales;
+  /// the vertices are processed in parallel.
+  static void PrincipalDirectionsPCA(MeshType &m, ScalarType r, KdTree<ScalarType> &vertexTree, vcg::CallBackPos * cb = NULL)
+  {
+    tri::UpdateNormal<MeshType>::PerVertexAngleWeighted(m);
+    tri::UpdateNormal<MeshType>::NormalizePerVertex(m);
+    const ScalarType area = Stat<MeshType>::ComputeMeshArea(m);
 
-      // sample the neighborhood
-      if(pointVSfaceInt)
+    const int vertNum = int(m.vert.size());
+    const int blockSize = 4096;
+    for(int block=0;block<vertNum;block+=blockSize)
+    {
+      if(cb) (*cb)(int(100.0f * (float)block / (float)vertNum),"Vertices Analysis");
+      const int blockEnd = std::min(vertNum,block+blockSize);
+#pragma omp parallel
       {
-        vcg::tri::GetInSphereVertex<
-            MeshType,
-            PointsGridType,std::vector<VertexType*>,
-            std::vector<ScalarType>,
-            std::vector<CoordType> >(tmpM,pGrid,  (*vi).cP(),r ,closests,distances,points);
-
-        A.Covariance(points,bp);
-        A*=area*area/1000;
-      }
-      else{
-        IntersectionBallMesh<MeshType,ScalarType>( m ,vcg::Sphere3<ScalarType>((*vi).cP(),r),tmpM );
-        vcg::Point3<ScalarType> _bary;
-        vcg::tri::Inertia<MeshType>::Covariance(tmpM,_bary,A);
+        // per thread scratch buffers for the radius queries
+        std::vector<unsigned int> ballIdx;
+        std::vector<ScalarType> ballDist;
+        std::vector<CoordType> points;
+#pragma omp for schedule(dynamic,64)
+        for(int i=block;i<blockEnd;++i)
+        {
+          VertexType &v = m.vert[i];
+          if(v.IsD()) continue;
+          ballIdx.clear(); ballDist.clear(); points.clear();
+          vertexTree.doQueryDist(v.cP(),r,ballIdx,ballDist);
+          std::sort(ballIdx.begin(),ballIdx.end());
+          for(size_t j=0;j<ballIdx.size();++j)
+            if(!m.vert[ballIdx[j]].IsD())
+              points.push_back(m.vert[ballIdx[j]].cP());
+
+          vcg::Matrix33<ScalarType> A;
+          vcg::Point3<ScalarType> bp;
+          A.Covariance(points,bp);
+          A*=area*area/1000;
+          PrincipalDirectionsFromCovariance(v,A,r);
+        }
       }
+    }
+  }
 
-//      Eigen::Matrix3f AA; AA=A;
-//      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> eig(AA);
-//      Eigen::Vector3f c_val = eig.eigenvalues();
-//      Eigen::Matrix3f c_vec = eig.eigenvectors();
-
-//      Jacobi(A,  eigenvalues , eigenvectors, nrot);
+private:
+  // principal directions and curvatures of a vertex from the covariance of its neighborhood of radius r
+  static void PrincipalDirectionsFromCovariance(VertexType &v, const vcg::Matrix33<ScalarType> &A, ScalarType r)
+  {
+      vcg::Matrix33<ScalarType> eigenvectors;
+      vcg::Point3<ScalarType> eigenvalues;
 
       Eigen::Matrix3d AA;
       A.ToEigenMatrix(AA);
@@ -342,49 +406,43 @@ If pointVSfaceInt==false the covariance is computed by (analytic)integration ove
       Eigen::Matrix3d c_vec = eig.eigenvectors(); // eigenvector are stored as columns.
       eigenvectors.FromEigenMatrix(c_vec);
       eigenvalues.FromEigenVector(c_val);
-//	  EV.transposeInPlace();
-//	  ev.FromEigenVector(c_val);
 
       // get the estimate of curvatures from eigenvalues and eigenvectors
       // find the 2 most tangent eigenvectors (by finding the one closest to the normal)
-      int best = 0; ScalarType bestv = fabs( (*vi).cN().dot(eigenvectors.GetColumn(0).normalized()) );
+      int best = 0; ScalarType bestv = fabs( v.cN().dot(eigenvectors.GetColumn(0).normalized()) );
       for(int i  = 1 ; i < 3; ++i){
-        ScalarType prod = fabs((*vi).cN().dot(eigenvectors.GetColumn(i).normalized()));
+        ScalarType prod = fabs(v.cN().dot(eigenvectors.GetColumn(i).normalized()));
         if( prod > bestv){bestv = prod; best = i;}
       }
 
-      (*vi).PD1().Import(eigenvectors.GetColumn( (best+1)%3).normalized());
-      (*vi).PD2().Import(eigenvectors.GetColumn( (best+2)%3).normalized());
+      v.PD1().Import(eigenvectors.GetColumn( (best+1)%3).normalized());
+      v.PD2().Import(eigenvectors.GetColumn( (best+2)%3).normalized());
 
       // project them to the plane identified by the normal
       vcg::Matrix33<CurScalarType> rot;
-      CurVecType NN = CurVecType::Construct((*vi).N());
+      CurVecType NN = CurVecType::Construct(v.N());
       CurScalarType angle;
-      angle = acos((*vi).PD1().dot(NN));
-      rot.SetRotateRad(  - (M_PI*0.5 - angle),(*vi).PD1()^NN);
-      (*vi).PD1() = rot*(*vi).PD1();
-      angle = acos((*vi).PD2().dot(NN));
-      rot.SetRotateRad(  - (M_PI*0.5 - angle),(*vi).PD2()^NN);
-      (*vi).PD2() = rot*(*vi).PD2();
+      angle = acos(v.PD1().dot(NN));
+      rot.SetRotateRad(  - (M_PI*0.5 - angle),v.PD1()^NN);
+      v.PD1() = rot*v.PD1();
+      angle = acos(v.PD2().dot(NN));
+      rot.SetRotateRad(  - (M_PI*0.5 - angle),v.PD2()^NN);
+      v.PD2() = rot*v.PD2();
 
 
       // copmutes the curvature values
       const ScalarType r5 = r*r*r*r*r;
       const ScalarType r6 = r*r5;
-      (*vi).K1() = (2.0/5.0) * (4.0*M_PI*r5 + 15*eigenvalues[(best+2)%3]-45.0*eigenvalues[(best+1)%3])/(M_PI*r6);
-      (*vi).K2() = (2.0/5.0) * (4.0*M_PI*r5 + 15*eigenvalues[(best+1)%3]-45.0*eigenvalues[(best+2)%3])/(M_PI*r6);
-      if((*vi).K1() < (*vi).K2())	{	std::swap((*vi).K1(),(*vi).K2());
-        std::swap((*vi).PD1(),(*vi).PD2());
-        if (cb)
-        {
-          (*cb)(int(100.0f * (float)jj / (float)m.vn),"Vertices Analysis");
-          ++jj;
-        }													}
-    }
-
-
+      v.K1() = (2.0/5.0) * (4.0*M_PI*r5 + 15*eigenvalues[(best+2)%3]-45.0*eigenvalues[(best+1)%3])/(M_PI*r6);
+      v.K2() = (2.0/5.0) * (4.0*M_PI*r5 + 15*eigenvalues[(best+1)%3]-45.0*eigenvalues[(best+2)%3])/(M_PI*r6);
+      if(v.K1() < v.K2())
+      {
+        std::swap(v.K1(),v.K2());
+        std::swap(v.PD1(),v.PD2());
+      }
   }
 
+public:
 /// \brief Computes the discrete mean gaussian curvature.
 /**
 The algorithm used is the one Desbrun et al. that is based on a discrete analysis of the angles of the faces around a vertex.
@@ -37,6 +37,7 @@
 #include <vcg/complex/algorithms/intersection.h>
 #include <vcg/complex/algorithms/inertia.h>
 #include <vcg/complex/algorithms/nring.h>
+#include <vcg/space/index/kdtree/kdtree.h>
 
 #include <Eigen/Core>
 #include <Eigen/QR>
@@ -235,9 +236,12 @@ class Quadric
         vcg::tri::UpdateNormal<MeshType>::NormalizePerVertex(m);
 
 
-        VertexIterator vi;
-        for(vi = m.vert.begin(); vi!=m.vert.end(); ++vi )
+        // each vertex only reads the positions of its neighbors: process them in parallel
+        const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(dynamic,256)
+        for(int i = 0; i < vertNum; ++i )
         {
+            VertexIterator vi = m.vert.begin() + i;
             std::vector<CoordType> ref = computeReferenceFrames(&*vi);
 
             Quadric q = fitQuadric(&*vi,ref);
@@ -391,25 +395,19 @@ class Quadric
             }
 
 
-            static int count = 0, index = 0;
             double min = 0.000000000001; //1.0e-12
-            /*
-            if (!count)
-                printf("GNE %e\n", min);
-             */
 
             if (detCheck && ((A.transpose()*A).determinant() < min && (A.transpose()*A).determinant() > -min))
             {
                 //A.svd().solve(b, &sol); A.svd().solve(b, &sol);
                 //cout << sol << endl;
-                printf("Quadric: unsolvable vertex %d %d\n", count, ++index);
+                printf("Quadric: unsolvable vertex\n");
                 //return Quadric (1, 1, 1, 1, 1);
 //                A.svd().solve(b, &sol);
                 Eigen::JacobiSVD<Eigen::MatrixXd> svd(A);
                 sol=svd.solve(b);
                 return QuadricLocal(sol[0],sol[1],sol[2],sol[3],sol[4]);
             }
-            count++;
 
             //for (int i = 0; i < 100; i++)
             {
@@ -442,6 +440,32 @@ class Quadric
     }
 
 
+    // same as expandMaxLocal (the first max vertices of the rings around v) but only reading the VF adjacency,
+    // so that it can be called concurrently; ring and nextRing are scratch buffers
+    static void expandMaxLocalVF (VertexType *v, int max, std::vector<VertexType*> &vv,
+                                  std::vector<VertexType*> &ring, std::vector<VertexType*> &nextRing)
+    {
+    vv.clear();
+    ring.assign(1, v);
+    while (int(vv.size()) < max && !ring.empty())
+    {
+        nextRing.clear();
+        for (size_t i = 0; i < ring.size(); ++i)
+            for (vcg::face::VFIterator<FaceType> vfi(ring[i]); !vfi.End(); ++vfi)
+                for (int k = 1; k < 3; ++k)
+                {
+                    VertexType *w = vfi.F()->V((vfi.I()+k)%3);
+                    if (w != v && std::find(vv.begin(), vv.end(), w) == vv.end())
+                    {
+                        vv.push_back(w);
+                        nextRing.push_back(w);
+                    }
+                }
+        ring.swap(nextRing);
+    }
+    if (int(vv.size()) > max) vv.resize(max);
+    }
+
     static void expandSphereLocal (MeshType & mesh, VertexType *v, float r, int min, std::vector<VertexType*> *vv)
     {
     Nring<MeshType> rw = Nring<MeshType> (v, &mesh);
@@ -548,7 +572,7 @@ class Quadric
     }
 
 
-    static void finalEigenStuff (VertexType *v, std::vector<CoordType> ref, QuadricLocal q)
+    static void finalEigenStuff (VertexType *v, std::vector<CoordType> ref, QuadricLocal q, CoordType *normal = NULL)
     {
     double a = q.a();
     double b = q.b();
@@ -562,7 +586,9 @@ class Quadric
 
     CoordType n = CoordType(-d,-e,1.0).Normalize();
 
-    v->N() = ref[0] * n[0] + ref[1] * n[1] + ref[2] * n[2];
+    // the new normal is written in *normal, if given, so that the neighbors still read the old one
+    if (normal != NULL) *normal = ref[0] * n[0] + ref[1] * n[1] + ref[2] * n[2];
+    else v->N() = ref[0] * n[0] + ref[1] * n[1] + ref[2] * n[2];
 
     double L = 2.0 * a * n.Z();
     double M = b * n.Z();
@@ -619,50 +645,86 @@ class Quadric
 
 
 
+    /// \brief Local quadric fitting curvature: for each vertex a quadric is fitted to the vertices closer than radiusSphere
+    /// (at least the 5 nearest ones) and the vertex normal is replaced by the normal of the fitted quadric.
     static void updateCurvatureLocal (MeshType & mesh, float radiusSphere, vcg::CallBackPos * cb = NULL)
     {
-	vcg::tri::UpdateFlags<MeshType>::FaceClear(mesh, FaceType::VISITED);
+    if (mesh.vert.empty()) return;
+    VertexConstDataWrapper<MeshType> ww(mesh);
+    KdTree<ScalarType> tree(ww);
+    updateCurvatureLocal(mesh, radiusSphere, tree, cb);
+    }
+
+    /// \brief Same as above using a prebuilt kd-tree on the mesh vertices, that can be shared by several calls
+    /// (e.g. at different radii). The neighborhoods are found with radius (or nearest neighbors) queries on the tree
+    /// and the vertices are processed in parallel; all the fits use the normals as they were before the call.
+    static void updateCurvatureLocal (MeshType & mesh, float radiusSphere, KdTree<ScalarType> &tree, vcg::CallBackPos * cb = NULL)
+    {
     bool projectionPlaneCheck = true;
+    const int minVertNum = 5;
     int vertexesPerFit = 0;
 
-    int i = 0;
-    VertexIterator vi;
-    for(vi = mesh.vert.begin(); vi != mesh.vert.end(); ++vi, i++)
+    const int vertNum = int(mesh.vert.size());
+    std::vector<CoordType> newNormal(vertNum);
+    const int blockSize = 4096;
+    for (int block = 0; block < vertNum; block += blockSize)
     {
+        if (cb) (*cb)(int(100.0f * (float)block / (float)vertNum),"Vertices Analysis");
+        const int blockEnd = std::min(vertNum, block + blockSize);
+#pragma omp parallel
+        {
+        // per thread scratch buffers
+        std::vector<unsigned int> ballIdx;
+        std::vector<ScalarType> ballDist;
+        std::vector<VertexType*> ring, nextRing;
         std::vector<VertexType*> vv;
         std::vector<VertexType*> vvtmp;
-		if (cb && ((i%1024)==00)) {
-			(*cb)(int(100.0f * (float)i / (float)mesh.vn),"Vertices Analysis");
-		}		
-        expandSphereLocal (mesh, &*vi, radiusSphere, 5, &vv);
-
-        assert (vv.size() >= 5);
-
-        CoordType ppn;
-        getAverageNormal (&*vi, vv, &ppn);
-
-        if (projectionPlaneCheck)
+        std::vector<CoordType> ref;
+#pragma omp for schedule(dynamic,64) reduction(+:vertexesPerFit)
+        for (int i = block; i < blockEnd; ++i)
         {
-        vvtmp.reserve (vv.size ());
-        applyProjOnPlane (ppn, vv, &vvtmp);
-        if (vvtmp.size() >= 5)
-            vv = vvtmp;
-        }
+            VertexType *vp = &mesh.vert[i];
+            newNormal[i] = vp->N();
+            if (vp->IsD()) continue;
+
+            vv.clear();
+            ballIdx.clear(); ballDist.clear();
+            tree.doQueryDist(vp->cP(), radiusSphere, ballIdx, ballDist);
+            std::sort(ballIdx.begin(), ballIdx.end());
+            for (size_t j = 0; j < ballIdx.size(); ++j)
+                if (int(ballIdx[j]) != i && !mesh.vert[ballIdx[j]].IsD())
+                    vv.push_back(&mesh.vert[ballIdx[j]]);
+
+            if (int(vv.size()) < minVertNum)
+            {
+                expandMaxLocalVF (vp, minVertNum, vv, ring, nextRing);
+                if (int(vv.size()) < minVertNum) continue;
+            }
 
-        vvtmp.clear();
-        assert (vv.size() >= 5);
+            CoordType ppn;
+            getAverageNormal (vp, vv, &ppn);
 
-        std::vector<CoordType> ref;
-        computeReferenceFramesLocal (&*vi, ppn, &ref);
+            if (projectionPlaneCheck)
+            {
+            vvtmp.clear();
+            applyProjOnPlane (ppn, vv, &vvtmp);
+            if (vvtmp.size() >= (size_t)minVertNum)
+                vv.swap(vvtmp);
+            }
 
-        vertexesPerFit += vv.size();
+            computeReferenceFramesLocal (vp, ppn, &ref);
 
-        QuadricLocal q;
-        fitQuadricLocal (&*vi, ref, vv, &q);
+            vertexesPerFit += int(vv.size());
 
-        finalEigenStuff (&*vi, ref, q);
+            QuadricLocal q;
+            fitQuadricLocal (vp, ref, vv, &q);
 
+            finalEigenStuff (vp, ref, q, &newNormal[i]);
+        }
+        }
     }
+    for (int i = 0; i < vertNum; ++i)
+        mesh.vert[i].N() = newNormal[i];
 
     if (cb)
         printf ("average vertex num in each fit: %f\n", ((float) vertexesPerFit) / mesh.vn);
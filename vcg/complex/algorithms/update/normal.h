@@ -28,6 +28,7 @@
 #include <vcg/complex/base.h>
 
 #include <vcg/complex/algorithms/polygon_support.h>
+#include <vcg/complex/algorithms/vf_adjacency_csr.h>
 
 #include "flag.h"
 
@@ -61,6 +62,13 @@ typedef typename MeshType::FaceType       FaceType;
 typedef typename MeshType::FacePointer    FacePointer;
 typedef typename MeshType::FaceIterator   FaceIterator;
 
+/// \brief The weighting of the incident face normals used by PerVertexParallel()
+enum VertexNormalWeight {
+  AreaWeight,       ///< as PerVertex()
+  AngleWeight,      ///< as PerVertexAngleWeighted()
+  NelsonMaxWeight   ///< as PerVertexNelsonMaxWeighted()
+};
+
 /// \brief Set to zero all the PerVertex normals
 /**
  Set to zero all the PerVertex normals. Used by all the face averaging algorithms.
@@ -105,10 +113,12 @@ static void PerVertex(ComputeMeshType &m)
 static void PerFacePolygonal(ComputeMeshType &m)
 {
   RequirePerFaceNormal(m);  
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
   {
-    if( !(*fi).IsD() )
-      fi->N() = PolygonNormal(*fi).Normalize();
+    if( !m.face[i].IsD() )
+      m.face[i].N() = PolygonNormal(m.face[i]).Normalize();
   }
 }
 
@@ -165,15 +175,104 @@ static void PerVertexNelsonMaxWeighted(ComputeMeshType &m)
    }
 }
 
+///  \brief Multi-threaded computation of the vertex normals, gathering the face contributions instead of scattering them.
+/**
+ In a first data-parallel pass each face computes the weighted normal it gives to each of its vertices,
+ with the weighting of PerVertex(), PerVertexAngleWeighted() or PerVertexNelsonMaxWeighted();
+ then each vertex sums the contributions of its incident faces read from the VFAdjacencyCSR, so no atomics are needed.
+ Faces are summed in increasing index order, hence the result is identical to the one of the serial functions.
+
+ The adjacency is rebuilt only if it is not up to date: keep the same object across calls to reuse it
+ while only the vertex positions change (rebuild it explicitly after a topological change that keeps the container sizes).
+ It does not need or exploit current face normals.
+ */
+static void PerVertexParallel(ComputeMeshType &m, VFAdjacencyCSR<ComputeMeshType> &vfa, VertexNormalWeight weight=AreaWeight)
+{
+  RequirePerVertexNormal(m);
+  if(!vfa.IsUpToDate(m)) vfa.Build(m);
+  const int faceNum = int(m.face.size());
+  const int vertNum = int(m.vert.size());
+  if(faceNum==0) return;
+  const FaceType *fBase = &m.face[0];
+
+  // the contribution of the z-th vertex of the i-th face is stored in contrib[cornerOff[i]+z]
+  std::vector<size_t> cornerOff(faceNum+1,0);
+  for(int i=0;i<faceNum;++i)
+    cornerOff[i+1] = cornerOff[i] + (m.face[i].IsD() ? 0 : m.face[i].VN());
+  std::vector<NormalType> contrib(cornerOff[faceNum]);
+
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+  {
+    const FaceType &f = m.face[i];
+    if(f.IsD()) continue;
+    NormalType *c = &contrib[cornerOff[i]];
+    for(int j=0;j<f.VN();++j)
+      c[j] = NormalType(0,0,0);
+    if(!f.IsR()) continue;
+    if(weight==AreaWeight)
+    {
+      const NormalType t = TriangleNormal(f);
+      for(int j=0;j<f.VN();++j)
+        c[j] = t;
+    }
+    else if(weight==AngleWeight)
+    {
+      const NormalType t = TriangleNormal(f).Normalize();
+      const NormalType e0 = (f.cV1(0)->cP()-f.cV0(0)->cP()).Normalize();
+      const NormalType e1 = (f.cV1(1)->cP()-f.cV0(1)->cP()).Normalize();
+      const NormalType e2 = (f.cV1(2)->cP()-f.cV0(2)->cP()).Normalize();
+      c[0] = t*AngleN(e0,-e2);
+      c[1] = t*AngleN(-e0,e1);
+      c[2] = t*AngleN(-e1,e2);
+    }
+    else
+    {
+      const NormalType t = TriangleNormal(f);
+      const ScalarType e0 = SquaredDistance(f.cV0(0)->cP(),f.cV1(0)->cP());
+      const ScalarType e1 = SquaredDistance(f.cV0(1)->cP(),f.cV1(1)->cP());
+      const ScalarType e2 = SquaredDistance(f.cV0(2)->cP(),f.cV1(2)->cP());
+      c[0] = t/(e0*e2);
+      c[1] = t/(e0*e1);
+      c[2] = t/(e1*e2);
+    }
+  }
+
+  const std::vector<size_t> &off = vfa.Offset();
+  const std::vector<typename VFAdjacencyCSR<ComputeMeshType>::Entry> &ent = vfa.Entries();
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i)
+  {
+    // unreferenced vertices keep their normal, as with PerVertexClear()
+    if(off[i]==off[i+1]) continue;
+    VertexType &v = m.vert[i];
+    const bool writable = !v.IsD() && v.IsRW();
+    if(!writable && weight==AreaWeight) continue;
+    NormalType n = writable ? NormalType(0,0,0) : v.N();
+    for(size_t k=off[i];k<off[i+1];++k)
+      n += contrib[cornerOff[ent[k].f-fBase]+ent[k].z];
+    v.N() = n;
+  }
+}
+
+/// \brief As above, building a temporary adjacency.
+static void PerVertexParallel(ComputeMeshType &m, VertexNormalWeight weight=AreaWeight)
+{
+  VFAdjacencyCSR<ComputeMeshType> vfa;
+  PerVertexParallel(m,vfa,weight);
+}
+
 /// \brief Calculates the face normal
 ///
 /// Not normalized. Use PerFaceNormalized() or call NormalizePerVertex() if you need unit length per face normals.
 static void PerFace(ComputeMeshType &m)
 {
   RequirePerFaceNormal(m);
-  for(FaceIterator f=m.face.begin();f!=m.face.end();++f)
-    if( !(*f).IsD() )
-              f->N() = TriangleNormal(*f);
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+    if( !m.face[i].IsD() )
+      m.face[i].N() = TriangleNormal(m.face[i]);
 }
 
 
@@ -183,12 +282,17 @@ static void PerFace(ComputeMeshType &m)
 static void PerPolygonalFace(ComputeMeshType &m) {
   tri::RequirePerFaceNormal(m);
   tri::RequirePolygonalMesh(m);
-  for(FaceIterator fi = m.face.begin(); fi != m.face.end(); fi++)
-    if (!fi->IsD()) {
-      fi->N().SetZero();
-      for (int i = 0; i < fi->VN(); i++)
-        fi->N() += fi->V0(i)->P() ^ fi->V1(i)->P();
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int k=0;k<faceNum;++k)
+  {
+    FaceType &f = m.face[k];
+    if (!f.IsD()) {
+      f.N().SetZero();
+      for (int i = 0; i < f.VN(); i++)
+        f.N() += f.V0(i)->P() ^ f.V1(i)->P();
     }
+  }
 }
 
 
@@ -223,15 +327,17 @@ static void PerFaceFromCurrentVertexNormal(ComputeMeshType &m)
 {
   tri::RequirePerVertexNormal(m);
   tri::RequirePerFaceNormal(m);
-  for (FaceIterator fi=m.face.begin(); fi!=m.face.end(); ++fi)
-   if( !(*fi).IsD())
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+   if( !m.face[i].IsD())
         {
         NormalType n;
         n.SetZero();
         for(int j=0; j<3; ++j)
-            n += fi->V(j)->cN();
+            n += m.face[i].V(j)->cN();
         n.Normalize();
-        fi->N() = n;
+        m.face[i].N() = n;
     }
 }
 
@@ -239,29 +345,34 @@ static void PerFaceFromCurrentVertexNormal(ComputeMeshType &m)
 static void NormalizePerVertex(ComputeMeshType &m)
 {
   tri::RequirePerVertexNormal(m);
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-        if( !(*vi).IsD() && (*vi).IsRW() )
-            (*vi).N().Normalize();
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i)
+        if( !m.vert[i].IsD() && m.vert[i].IsRW() )
+            m.vert[i].N().Normalize();
 }
 
 /// \brief Normalize the length of the face normals.
 static void NormalizePerFace(ComputeMeshType &m)
 {
   tri::RequirePerFaceNormal(m);
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-      if( !(*fi).IsD() )	(*fi).N().Normalize();
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+      if( !m.face[i].IsD() )	m.face[i].N().Normalize();
 }
 
 /// \brief Set the length of the face normals to their area (without recomputing their directions).
 static void NormalizePerFaceByArea(ComputeMeshType &m)
 {
   tri::RequirePerFaceNormal(m);
-  FaceIterator fi;
-  for(fi=m.face.begin();fi!=m.face.end();++fi)
-    if( !(*fi).IsD() )
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+    if( !m.face[i].IsD() )
             {
-                (*fi).N().Normalize();
-                (*fi).N() = (*fi).N() * DoubleArea(*fi);
+                m.face[i].N().Normalize();
+                m.face[i].N() = m.face[i].N() * DoubleArea(m.face[i]);
             }
 }
 
@@ -299,6 +410,85 @@ static void PerVertexNormalizedPerFace(ComputeMeshType &m)
     NormalizePerVertex(m);
 }
 
+/// \brief Incremental version of PerVertexNormalizedPerFace(), that updates only the one-rings of the dirty region.
+/**
+ The dirty region is the one recorded by the Allocator (see Allocator::EnableDirtyTracking());
+ the face normals are recomputed for the dirty faces and for the faces incident on the dirty vertices,
+ and the vertex normals for all the vertices of these faces. The normal part of the region is then cleared.
+ It requires an up to date VF adjacency, otherwise (or if tracking is not enabled or the region is too large)
+ it falls back to the full PerVertexNormalizedPerFace().
+ Results are the same of the full update up to the order of summation of the face contributions.
+ */
+static void PerVertexNormalizedPerFaceDirty(ComputeMeshType &m)
+{
+  DirtyRegion *dr = Allocator<ComputeMeshType>::GetDirtyRegion(m);
+  if(dr==nullptr || dr->normalVert.all || dr->normalFace.all || !HasVFAdjacency(m))
+  {
+    PerVertexNormalizedPerFace(m);
+    if(dr) { dr->normalVert.Clear(); dr->normalFace.Clear(); }
+    return;
+  }
+  RequirePerVertexNormal(m);
+  RequirePerFaceNormal(m);
+
+  // the seeds: moved vertices and the vertices of the changed faces
+  std::vector<size_t> seedVert, ringFace, ringVert;
+  for(size_t i=0;i<dr->normalVert.idx.size();++i)
+    if(dr->normalVert.idx[i]<m.vert.size())
+      seedVert.push_back(dr->normalVert.idx[i]);
+  for(size_t i=0;i<dr->normalFace.idx.size();++i)
+  {
+    const size_t fi = dr->normalFace.idx[i];
+    if(fi>=m.face.size() || m.face[fi].IsD()) continue;
+    ringFace.push_back(fi);
+    for(int j=0;j<3;++j)
+      seedVert.push_back(tri::Index(m,m.face[fi].V(j)));
+  }
+  dr->normalVert.Clear();
+  dr->normalFace.Clear();
+  std::sort(seedVert.begin(),seedVert.end());
+  seedVert.erase(std::unique(seedVert.begin(),seedVert.end()),seedVert.end());
+
+  // the faces whose normal can be changed
+  for(size_t i=0;i<seedVert.size();++i)
+  {
+    VertexType &v = m.vert[seedVert[i]];
+    if(v.IsD()) continue;
+    for(face::VFIterator<FaceType> vfi(&v);!vfi.End();++vfi)
+      ringFace.push_back(tri::Index(m,vfi.F()));
+  }
+  std::sort(ringFace.begin(),ringFace.end());
+  ringFace.erase(std::unique(ringFace.begin(),ringFace.end()),ringFace.end());
+
+  ringVert = seedVert;
+  for(size_t i=0;i<ringFace.size();++i)
+  {
+    FaceType &f = m.face[ringFace[i]];
+    f.N() = TriangleNormal(f);
+    for(int j=0;j<3;++j)
+      ringVert.push_back(tri::Index(m,f.V(j)));
+  }
+  std::sort(ringVert.begin(),ringVert.end());
+  ringVert.erase(std::unique(ringVert.begin(),ringVert.end()),ringVert.end());
+
+  // as PerVertex(), vertices with no incident faces keep their normal
+  for(size_t i=0;i<ringVert.size();++i)
+  {
+    VertexType &v = m.vert[ringVert[i]];
+    if(v.IsD() || !v.IsRW()) continue;
+    NormalType n((ScalarType)0,(ScalarType)0,(ScalarType)0);
+    bool referenced=false;
+    for(face::VFIterator<FaceType> vfi(&v);!vfi.End();++vfi)
+    {
+      referenced=true;
+      if(vfi.F()->IsR())
+        n += NormalType(TriangleNormal(*vfi.F()));
+    }
+    if(referenced) v.N() = n;
+    v.N().Normalize();
+  }
+}
+
 /// \brief Equivalent to PerVertexNormalizedPerFace() and NormalizePerFace().
 static void PerVertexNormalizedPerFaceNormalized(ComputeMeshType &m)
 {
@@ -345,6 +535,7 @@ static void PerBitPolygonFaceNormalized(ComputeMeshType &m)
     }
 }
 /// \brief Multiply the vertex normals by the matrix passed. By default, the scale component is removed.
+/// The vertices are processed in parallel.
 static void PerVertexMatrix(ComputeMeshType &m, const Matrix44<ScalarType> &mat, bool remove_scaling= true)
 {
     tri::RequirePerVertexNormal(m);
@@ -361,12 +552,15 @@ static void PerVertexMatrix(ComputeMeshType &m, const Matrix44<ScalarType> &mat,
         mat33*=S;
     }
 
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-        if( !(*vi).IsD() && (*vi).IsRW() )
-            (*vi).N()  = mat33*(*vi).N();
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i)
+        if( !m.vert[i].IsD() && m.vert[i].IsRW() )
+            m.vert[i].N() = mat33*m.vert[i].N();
 }
 
 /// \brief Multiply the face normals by the matrix passed. By default, the scale component is removed.
+/// The faces are processed in parallel.
 static void PerFaceMatrix(ComputeMeshType &m, const Matrix44<ScalarType> &mat, bool remove_scaling= true)
 {
     tri::RequirePerFaceNormal(m);
@@ -383,9 +577,11 @@ static void PerFaceMatrix(ComputeMeshType &m, const Matrix44<ScalarType> &mat, b
         mat33[2][2]/=scale;
     }
 
-    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-        if( !(*fi).IsD() && (*fi).IsRW() )
-            (*fi).N() = mat33* (*fi).N();
+    const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<faceNum;++i)
+        if( !m.face[i].IsD() && m.face[i].IsRW() )
+            m.face[i].N() = mat33*m.face[i].N();
 }
 
 /// \brief Compute per wedge normals taking into account the angle between adjacent faces.
@@ -56,12 +56,27 @@ typedef typename MeshType::FaceType       FaceType;
 typedef typename MeshType::FacePointer    FacePointer;
 typedef typename MeshType::FaceIterator   FaceIterator;
 
-/// \brief Multiply 
+typedef typename MeshType::CoordType      CoordType;
+
+/// \brief Multiply the vertex positions (and by default the normals) by the matrix M.
+/// The bounding box of the mesh is updated in the same pass. See TransformAndBound().
 static void Matrix(ComputeMeshType &m, const Matrix44<ScalarType> &M, bool update_also_normals = true)
 {
-	VertexIterator vi;
-	for(vi=m.vert.begin();vi!=m.vert.end();++vi)
-	        if(!(*vi).IsD()) (*vi).P()=M*(*vi).cP();
+	const ScalarType a00=M.ElementAt(0,0), a01=M.ElementAt(0,1), a02=M.ElementAt(0,2), a03=M.ElementAt(0,3);
+	const ScalarType a10=M.ElementAt(1,0), a11=M.ElementAt(1,1), a12=M.ElementAt(1,2), a13=M.ElementAt(1,3);
+	const ScalarType a20=M.ElementAt(2,0), a21=M.ElementAt(2,1), a22=M.ElementAt(2,2), a23=M.ElementAt(2,3);
+	const ScalarType a30=M.ElementAt(3,0), a31=M.ElementAt(3,1), a32=M.ElementAt(3,2), a33=M.ElementAt(3,3);
+	if(a30==0 && a31==0 && a32==0 && a33==1)
+	{
+		// affine matrix: no homogeneous divide
+		TransformAndBound(m,[=](const CoordType &p) {
+			return CoordType(a00*p[0] + a01*p[1] + a02*p[2] + a03,
+			                 a10*p[0] + a11*p[1] + a12*p[2] + a13,
+			                 a20*p[0] + a21*p[1] + a22*p[2] + a23);
+		});
+	}
+	else
+		TransformAndBound(m,[=](const CoordType &p) { return M*p; });
 
 	if(update_also_normals){
 		if(HasPerVertexNormal(m)){
@@ -73,27 +88,76 @@ static void Matrix(ComputeMeshType &m, const Matrix44<ScalarType> &M, bool updat
 	}
 }
 
+/// \brief Translate the vertex positions; the bounding box is updated in the same pass.
 static void Translate(ComputeMeshType &m, const Point3<ScalarType> &t)
 {
-  VertexIterator vi;
-  for(vi=m.vert.begin();vi!=m.vert.end();++vi)
-          if(!(*vi).IsD()) (*vi).P()+=t;
+  TransformAndBound(m,[=](const CoordType &p) { return p+t; });
 }
 
+/// \brief Uniformly scale the vertex positions; the bounding box is updated in the same pass.
 static void Scale(ComputeMeshType &m, const ScalarType s)
 {
   Scale(m,Point3<ScalarType>(s,s,s));
 }
 
+/// \brief Scale the vertex positions; the bounding box is updated in the same pass.
 static void Scale(ComputeMeshType &m, const Point3<ScalarType> &s)
 {
-  VertexIterator vi;
-  for(vi=m.vert.begin();vi!=m.vert.end();++vi)
-          if(!(*vi).IsD()) {
-            (*vi).P()[0]*=s[0];
-            (*vi).P()[1]*=s[1];
-            (*vi).P()[2]*=s[2];
-          }
+  TransformAndBound(m,[=](const CoordType &p) { return CoordType(p[0]*s[0],p[1]*s[1],p[2]*s[2]); });
+}
+
+/// \brief Replace each (non deleted) vertex position p with f(p) and recompute the bounding box in the same pass.
+///
+/// The vertices are processed in parallel blocks of 4096, each one computing its own box, and the boxes are merged at the end.
+/// When the positions are packed in their own array (vertex::CoordOcf) and there are no deleted vertices
+/// the loop runs directly on that array, with no per vertex flag test, so that the compiler can vectorize it.
+template <class PointFunctor>
+static void TransformAndBound(ComputeMeshType &m, PointFunctor f)
+{
+	const int vertNum = int(m.vert.size());
+	const int blockSize = 4096;
+	const int blockNum = (vertNum+blockSize-1)/blockSize;
+	std::vector<Box3<ScalarType> > blockBox(blockNum);
+	CoordType *pv = tri::VertexVectorCoordData(m.vert);
+	const bool packed = (pv!=0 && m.vn==vertNum);
+#pragma omp parallel for schedule(static)
+	for(int b=0;b<blockNum;++b)
+	{
+		const int end = std::min(vertNum,(b+1)*blockSize);
+		ScalarType bmin[3] = { std::numeric_limits<ScalarType>::max(), std::numeric_limits<ScalarType>::max(), std::numeric_limits<ScalarType>::max() };
+		ScalarType bmax[3] = { std::numeric_limits<ScalarType>::lowest(), std::numeric_limits<ScalarType>::lowest(), std::numeric_limits<ScalarType>::lowest() };
+		int cnt=0;
+		if(packed)
+		{
+			for(int i=b*blockSize;i<end;++i)
+			{
+				const CoordType q = f(pv[i]);
+				pv[i] = q;
+				for(int k=0;k<3;++k) { bmin[k]=std::min(bmin[k],q[k]); bmax[k]=std::max(bmax[k],q[k]); }
+			}
+			cnt = end-b*blockSize;
+		}
+		else
+		{
+			for(int i=b*blockSize;i<end;++i)
+			{
+				VertexType &v = m.vert[i];
+				if(v.IsD()) continue;
+				const CoordType q = f(v.cP());
+				v.P() = q;
+				for(int k=0;k<3;++k) { bmin[k]=std::min(bmin[k],q[k]); bmax[k]=std::max(bmax[k],q[k]); }
+				++cnt;
+			}
+		}
+		if(cnt>0)
+		{
+			blockBox[b].min = CoordType(bmin[0],bmin[1],bmin[2]);
+			blockBox[b].max = CoordType(bmax[0],bmax[1],bmax[2]);
+		}
+	}
+	m.bbox.SetNull();
+	for(int b=0;b<blockNum;++b)
+		m.bbox.Add(blockBox[b]);
 }
 
 }; // end class
@@ -23,6 +23,7 @@
 #ifndef __VCG_TRI_UPDATE_QUALITY
 #define __VCG_TRI_UPDATE_QUALITY
 #include <vcg/complex/algorithms/stat.h>
+#include <vcg/complex/algorithms/vf_adjacency_csr.h>
 
 namespace vcg {
 namespace tri {
@@ -67,26 +68,23 @@ public:
 static void VertexConstant(MeshType &m, VertexQualityType q)
 {
   tri::RequirePerVertexQuality(m);
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-    (*vi).Q()=q;
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+    m.vert[i].Q()=q;
 }
 
 /** Assign to each vertex of the mesh the valence of faces.
+ The valences are read from a temporary VFAdjacencyCSR.
 */
 static void VertexValence(UpdateMeshType &m)
 {
   tri::RequirePerVertexQuality(m);
-  VertexConstant(m,0);
-  for (size_t i=0;i<m.face.size();i++)
-  {
-    if (m.face[i].IsD())continue;
-    
-    for (int j=0;j<m.face[i].VN();j++)
-    {
-      VertexType *v=m.face[i].V(j);
-      v->Q()+=1;
-    }
-  }
+  VFAdjacencyCSR<MeshType> vfa(m);
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+    m.vert[i].Q()=VertexQualityType(vfa.Degree(size_t(i)));
 }
 
 /** Clamp each vertex of the mesh with a range of values.
@@ -96,8 +94,10 @@ static void VertexClamp(MeshType &m,
                         VertexQualityType qmax)
 {
   tri::RequirePerVertexQuality(m);
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-    (*vi).Q()=std::min(qmax, std::max(qmin,(*vi).Q()));
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+    m.vert[i].Q()=std::min(qmax, std::max(qmin,m.vert[i].Q()));
 }
 
 /** Normalize the vertex quality so that it fits in the specified range.
@@ -107,9 +107,10 @@ static void VertexNormalize(MeshType &m, VertexQualityType qmin=0.0, VertexQuali
   tri::RequirePerVertexQuality(m);
   ScalarType deltaRange = qmax-qmin;
   std::pair<ScalarType,ScalarType> minmax = tri::Stat<MeshType>::ComputePerVertexQualityMinMax(m);
-  VertexIterator vi;
-  for(vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-    (*vi).Q() = qmin+deltaRange*((*vi).Q() - minmax.first)/(minmax.second - minmax.first);
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i)
+    m.vert[i].Q() = qmin+deltaRange*(m.vert[i].Q() - minmax.first)/(minmax.second - minmax.first);
 }
 
 /** Normalize the face quality so that it fits in the specified range.
@@ -119,8 +120,10 @@ static void FaceNormalize(MeshType &m, FaceQualityType qmin=0.0, FaceQualityType
   tri::RequirePerFaceQuality(m);
   FaceQualityType deltaRange = qmax-qmin;
   std::pair<FaceQualityType,FaceQualityType> minmax = tri::Stat<MeshType>::ComputePerFaceQualityMinMax(m);
-  for(FaceIterator fi = m.face.begin(); fi != m.face.end(); ++fi)
-    (*fi).Q() = qmin+deltaRange*((*fi).Q() - minmax.first)/(minmax.second - minmax.first);
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+    m.face[i].Q() = qmin+deltaRange*(m.face[i].Q() - minmax.first)/(minmax.second - minmax.first);
 }
 
 /** Assign to each face of the mesh a constant quality value. Useful for initialization.
@@ -128,8 +131,10 @@ static void FaceNormalize(MeshType &m, FaceQualityType qmin=0.0, FaceQualityType
 static void FaceConstant(MeshType &m, FaceQualityType q)
 {
   tri::RequirePerFaceQuality(m);
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-    (*fi).Q()=q;
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+    m.face[i].Q()=q;
 }
 
 /** Assign to each face of the mesh its area.
@@ -137,8 +142,10 @@ static void FaceConstant(MeshType &m, FaceQualityType q)
 static void FaceArea(MeshType &m)
 {
   tri::RequirePerFaceQuality(m);
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-    (*fi).Q()=FaceQualityType(vcg::DoubleArea(*fi)/ScalarType(2.0));
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+    m.face[i].Q()=FaceQualityType(vcg::DoubleArea(m.face[i])/ScalarType(2.0));
 }
 
 static void TetraConstant(MeshType & m, const TetraQualityType q)
@@ -164,30 +171,43 @@ static void TetraFromAspectRatio(MeshType & m)
   });
 }
 
+/** Assign to each vertex the (area weighted) average of the quality of its incident faces.
+ Each vertex gathers its faces from a temporary VFAdjacencyCSR, in increasing face order,
+ so the vertices are processed in parallel and the sums are accumulated in the same order of a serial scan of the faces.
+*/
 static void VertexFromFace( MeshType &m, bool areaWeighted=true)
 {
   tri::RequirePerFaceQuality(m);
   tri::RequirePerVertexQuality(m);
-  SimpleTempData<typename MeshType::VertContainer, ScalarType> TQ(m.vert,0);
-  SimpleTempData<typename MeshType::VertContainer, ScalarType> TCnt(m.vert,0);
+  if(m.face.empty()) return;
 
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-    if(!(*fi).IsD())
-    {
-      VertexQualityType weight=1.0;
-      if(areaWeighted) weight = vcg::DoubleArea(*fi);
-      for(int j=0;j<3;++j)
-      {
-        TQ[(*fi).V(j)]+=(*fi).Q()*weight;
-        TCnt[(*fi).V(j)]+=weight;
-      }
-    }
+  const int faceNum = int(m.face.size());
+  std::vector<VertexQualityType> weight(m.face.size(),VertexQualityType(1.0));
+  if(areaWeighted)
+  {
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<faceNum;++i)
+      if(!m.face[i].IsD()) weight[i] = vcg::DoubleArea(m.face[i]);
+  }
 
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-    if(!(*vi).IsD() && TCnt[*vi]>0 )
+  VFAdjacencyCSR<MeshType> vfa(m);
+  const std::vector<size_t> &off = vfa.Offset();
+  const std::vector<typename VFAdjacencyCSR<MeshType>::Entry> &ent = vfa.Entries();
+  const FaceType *fBase = &m.face[0];
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i)
+  {
+    if(m.vert[i].IsD()) continue;
+    ScalarType q=0, cnt=0;
+    for(size_t k=off[i];k<off[i+1];++k)
     {
-      (*vi).Q() = TQ[*vi] / TCnt[*vi];
+      const VertexQualityType w = weight[ent[k].f-fBase];
+      q+=ent[k].f->cQ()*w;
+      cnt+=w;
     }
+    if(cnt>0) m.vert[i].Q() = q / cnt;
+  }
 }
 
 static void VertexFromTetra(MeshType & m, bool volumeWeighted = true)
@@ -219,9 +239,11 @@ template <class HandleScalar>
 static void VertexFromAttributeHandle(MeshType &m, typename MeshType::template PerVertexAttributeHandle<HandleScalar> &h)
 {
   tri::RequirePerVertexQuality(m);
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi)
-    if(!(*vi).IsD())
-      (*vi).Q()=VertexQualityType(h[vi]);
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i)
+    if(!m.vert[i].IsD())
+      m.vert[i].Q()=VertexQualityType(h[size_t(i)]);
 }
 
 static void VertexFromAttributeName(MeshType &m, const std::string &AttrName)
@@ -229,16 +251,20 @@ static void VertexFromAttributeName(MeshType &m, const std::string &AttrName)
     tri::RequirePerVertexQuality(m);
     auto KH = tri::Allocator<MeshType>:: template FindPerVertexAttribute<ScalarType> (m, AttrName);
     if(!tri::Allocator<MeshType>::template IsValidHandle<ScalarType>(m, KH)) throw vcg::MissingPreconditionException("Required Attribute is non existent");
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-            (*vi).Q() = KH[vi];
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+            m.vert[i].Q() = KH[size_t(i)];
 }
 
 template <class HandleScalar>
 static void FaceFromAttributeHandle(MeshType &m, typename MeshType::template PerFaceAttributeHandle<HandleScalar> &h)
 {
   tri::RequirePerFaceQuality(m);
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi) if(!(*fi).IsD())
-    (*fi).Q() =FaceQualityType(h[fi]);
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i) if(!m.face[i].IsD())
+    m.face[i].Q() =FaceQualityType(h[size_t(i)]);
 }
 
 static void FaceFromAttributeName(MeshType &m, const std::string &AttrName)
@@ -246,58 +272,74 @@ static void FaceFromAttributeName(MeshType &m, const std::string &AttrName)
     tri::RequirePerFaceQuality(m);
     auto KH = tri::Allocator<MeshType>:: template FindPerFaceAttribute<ScalarType> (m, AttrName);
     if(!tri::Allocator<MeshType>::template IsValidHandle<ScalarType>(m, KH)) throw vcg::MissingPreconditionException("Required Attribute is non existent");
-    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi) if(!(*fi).IsD())
-            (*fi).Q() =FaceQualityType(KH[fi]);
+    const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<faceNum;++i) if(!m.face[i].IsD())
+            m.face[i].Q() =FaceQualityType(KH[size_t(i)]);
 }
 
 static void FaceFromVertex( MeshType &m)
 {
   tri::RequirePerFaceQuality(m);
   tri::RequirePerVertexQuality(m);
-  for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi) if(!(*fi).IsD())
+  const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+  for(int k=0;k<faceNum;++k)
   {
-     (*fi).Q() =0;
-     for (int i=0;i<(*fi).VN();i++)
-        (*fi).Q() += (*fi).V(i)->Q();
-     (*fi).Q()/=(FaceQualityType)(*fi).VN();
+     FaceType &f = m.face[k];
+     if(f.IsD()) continue;
+     f.Q() =0;
+     for (int i=0;i<f.VN();i++)
+        f.Q() += f.V(i)->Q();
+     f.Q()/=(FaceQualityType)f.VN();
   }
 }
 
 static void VertexFromPlane(MeshType &m, const Plane3<ScalarType> &pl)
 {
   tri::RequirePerVertexQuality(m);
-  for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-    (*vi).Q() =SignedDistancePlanePoint(pl,(*vi).cP());
+  const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+    m.vert[i].Q() =SignedDistancePlanePoint(pl,m.vert[i].cP());
 }
 
 static void VertexGaussianFromCurvatureDir(MeshType &m)
 {
   tri::RequirePerVertexQuality(m);
   tri::RequirePerVertexCurvatureDir(m);
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-      (*vi).Q() = (*vi).K1()*(*vi).K2();
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+        m.vert[i].Q() = m.vert[i].K1()*m.vert[i].K2();
 }
 
 static void VertexMeanFromCurvatureDir(MeshType &m)
 {
   tri::RequirePerVertexQuality(m);
   tri::RequirePerVertexCurvatureDir(m);
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-        (*vi).Q() = ((*vi).K1()+(*vi).K2())/2.0f;
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+        m.vert[i].Q() = (m.vert[i].K1()+m.vert[i].K2())/2.0f;
 }
 static void VertexMinCurvFromCurvatureDir(MeshType &m)
 {
   tri::RequirePerVertexQuality(m);
   tri::RequirePerVertexCurvatureDir(m);
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-        (*vi).Q() = (*vi).K1();
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+        m.vert[i].Q() = m.vert[i].K1();
 }
 static void VertexMaxCurvFromCurvatureDir(MeshType &m)
 {
   tri::RequirePerVertexQuality(m);
   tri::RequirePerVertexCurvatureDir(m);
-    for(VertexIterator vi=m.vert.begin();vi!=m.vert.end();++vi) if(!(*vi).IsD())
-        (*vi).Q() = (*vi).K2();
+    const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vertNum;++i) if(!m.vert[i].IsD())
+        m.vert[i].Q() = m.vert[i].K2();
 }
 
 /**
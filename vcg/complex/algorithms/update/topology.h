@@ -393,26 +393,36 @@ static void ClearFaceFace(MeshType &m)
   }
 }
 
-/// \brief Update the Face-Face topological relation by allowing to retrieve for each face what other faces shares their edges.
-static void FaceFace(MeshType &m)
+/// \brief Strict ordering of PEdge used when building the FF adjacency.
+/// Edges are ordered by vertex pair and, among the ones sharing the same pair, by face and edge index,
+/// so that the faces of a non manifold fan are always chained in the order they have in the face vector.
+class PEdgeFaceOrder
 {
-  RequireFFAdjacency(m);
-  if( m.fn == 0 ) return;
-  // we use an auxiliary vector of pairs (face,edge index) to sort the edges
-  std::vector<PEdge> e;
-  FillEdgeVector(m,e);
-  sort(e.begin(), e.end());	
+public:
+  inline bool operator () (const PEdge &a, const PEdge &b) const
+  {
+    if( a.v[0]!=b.v[0] ) return a.v[0]<b.v[0];
+    if( a.v[1]!=b.v[1] ) return a.v[1]<b.v[1];
+    if( a.f!=b.f ) return a.f<b.f;
+    return a.z<b.z;
+  }
+};
 
-  auto ps = e.begin();
-  auto pe = e.begin();
+/// \brief Connect the faces referred by a range of edges sorted by vertex pair.
+/// All the faces sharing the same edge are linked in a circular list (two faces for a manifold edge).
+static void FaceFaceLinkSorted(typename std::vector<PEdge>::iterator eBegin, typename std::vector<PEdge>::iterator eEnd)
+{
+  if( eBegin==eEnd ) return;
+  auto ps = eBegin;
+  auto pe = eBegin;
   // scans the sorted vector of edges searching for edges with the same pair of vertices
   // and connect the corresponding faces
   do
   {
-    if( pe==e.end() || !(*pe == *ps) )
+    if( pe==eEnd || !(*pe == *ps) )
     {
       typename std::vector<PEdge>::iterator q,q_next;
-      for (q=ps;q<pe-1;++q)						
+      for (q=ps;q<pe-1;++q)
       {
         assert((*q).z>=0);
         //assert((*q).z< 3);
@@ -420,7 +430,7 @@ static void FaceFace(MeshType &m)
         ++q_next;
         assert((*q_next).z>=0);
         assert((*q_next).z< (*q_next).f->VN());
-        (*q).f->FFp(q->z) = (*q_next).f;				
+        (*q).f->FFp(q->z) = (*q_next).f;
         (*q).f->FFi(q->z) = (*q_next).z;
       }
       assert((*q).z>=0);
@@ -429,11 +439,104 @@ static void FaceFace(MeshType &m)
       (*q).f->FFi((*q).z) = ps->z;
       ps = pe;
     }
-    if(pe==e.end()) break;
+    if(pe==eEnd) break;
     ++pe;
   } while(true);
 }
 
+/// \brief Update the Face-Face topological relation by allowing to retrieve for each face what other faces shares their edges.
+static void FaceFace(MeshType &m)
+{
+  RequireFFAdjacency(m);
+  if( m.fn == 0 ) return;
+  // we use an auxiliary vector of pairs (face,edge index) to sort the edges
+  std::vector<PEdge> e;
+  FillEdgeVector(m,e);
+  sort(e.begin(), e.end(), PEdgeFaceOrder());
+  FaceFaceLinkSorted(e.begin(), e.end());
+}
+
+/// \brief Multi-threaded version of FaceFace(), it computes exactly the same FFp/FFi values.
+/**
+The edges are partitioned in buckets according to an hash of their vertex pair, so that all
+the occurrences of the same edge fall in the same bucket. The partition is done with a
+stable, chunked counting sort; then each bucket is sorted and linked independently.
+Buckets never share an edge, so each FFp/FFi entry is written by a single thread.
+Without OpenMP it just runs serially.
+*/
+static void FaceFaceParallel(MeshType &m)
+{
+  RequireFFAdjacency(m);
+  if( m.fn == 0 ) return;
+  const int faceNum = int(m.face.size());
+
+  // position of the first edge of each face in the edge vector (deleted faces have no edge)
+  std::vector<size_t> faceOff(faceNum+1,0);
+  for(int i=0;i<faceNum;++i)
+    faceOff[i+1] = faceOff[i] + (m.face[i].IsD() ? 0 : m.face[i].VN());
+  const size_t edgeNum = faceOff[faceNum];
+  if( edgeNum == 0 ) return;
+
+  const int bucketNum = int(std::max<size_t>(1, std::min<size_t>(4096, edgeNum/1024)));
+  const int chunkNum  = int(std::max<size_t>(1, std::min<size_t>(64, edgeNum/65536)));
+  const size_t chunkSize = (edgeNum + chunkNum - 1) / chunkNum;
+  const VertexPointer vBase = &*m.vert.begin();
+
+  std::vector<PEdge> e(edgeNum);
+  std::vector<int> bucket(edgeNum);
+#pragma omp parallel for schedule(static)
+  for(int i=0;i<faceNum;++i)
+  {
+    if(m.face[i].IsD()) continue;
+    for(int j=0;j<m.face[i].VN();++j)
+    {
+      const size_t k = faceOff[i]+j;
+      e[k].Set(&m.face[i],j);
+      const size_t h = size_t(e[k].v[0]-vBase) * size_t(73856093) ^ size_t(e[k].v[1]-vBase) * size_t(19349663);
+      bucket[k] = int(h % size_t(bucketNum));
+    }
+  }
+
+  // per chunk histogram of the buckets; cnt[c*bucketNum+b] becomes the scatter position of chunk c in bucket b
+  std::vector<size_t> cnt(size_t(chunkNum)*bucketNum,0);
+#pragma omp parallel for schedule(static)
+  for(int c=0;c<chunkNum;++c)
+  {
+    const size_t kEnd = std::min(edgeNum, (c+1)*chunkSize);
+    for(size_t k=c*chunkSize;k<kEnd;++k)
+      ++cnt[size_t(c)*bucketNum+bucket[k]];
+  }
+  std::vector<size_t> bucketOff(bucketNum+1,0);
+  size_t sum=0;
+  for(int b=0;b<bucketNum;++b)
+  {
+    bucketOff[b]=sum;
+    for(int c=0;c<chunkNum;++c)
+    {
+      const size_t t = cnt[size_t(c)*bucketNum+b];
+      cnt[size_t(c)*bucketNum+b] = sum;
+      sum += t;
+    }
+  }
+  bucketOff[bucketNum]=sum;
+
+  std::vector<PEdge> be(edgeNum);
+#pragma omp parallel for schedule(static)
+  for(int c=0;c<chunkNum;++c)
+  {
+    const size_t kEnd = std::min(edgeNum, (c+1)*chunkSize);
+    for(size_t k=c*chunkSize;k<kEnd;++k)
+      be[cnt[size_t(c)*bucketNum+bucket[k]]++] = e[k];
+  }
+
+#pragma omp parallel for schedule(dynamic, 4)
+  for(int b=0;b<bucketNum;++b)
+  {
+    std::sort(be.begin()+bucketOff[b], be.begin()+bucketOff[b+1], PEdgeFaceOrder());
+    FaceFaceLinkSorted(be.begin()+bucketOff[b], be.begin()+bucketOff[b+1]);
+  }
+}
+
 
 /// \brief Update the vertex-tetra topological relation.
 static void VertexTetra(MeshType & m)
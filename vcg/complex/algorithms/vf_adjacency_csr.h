@@ -0,0 +1,235 @@
+/****************************************************************************
+* VCGLib                                                            o o     *
+* Visual and Computer Graphics Library                            o     o   *
+*                                                                _   O  _   *
+* Copyright(C) 2004-2016                                           \/)\/    *
+* Visual Computing Lab                                            /\/|      *
+* ISTI - Italian National Research Council                           |      *
+*                                                                    \      *
+* All rights reserved.                                                      *
+*                                                                           *
+* This program is free software; you can redistribute it and/or modify      *   
+* it under the terms of the GNU General Public License as published by      *
+* the Free Software Foundation; either version 2 of the License, or         *
+* (at your option) any later version.                                       *
+*                                                                           *
+* This program is distributed in the hope that it will be useful,           *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+* GNU General Public License (http://www.gnu.org/licenses/gpl.txt)          *
+* for more details.                                                         *
+*                                                                           *
+****************************************************************************/
+#ifndef __VCG_TRI_VF_ADJACENCY_CSR
+#define __VCG_TRI_VF_ADJACENCY_CSR
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <vcg/complex/base.h>
+
+namespace vcg {
+namespace tri {
+/// \ingroup trimesh
+
+/// \headerfile vf_adjacency_csr.h vcg/complex/algorithms/vf_adjacency_csr.h
+
+/// \brief Read-only vertex-face adjacency stored in compressed sparse row form.
+/**
+It is an alternative to the VFp/VFi linked lists built by UpdateTopology::VertexFace().
+For each vertex the (face, index of the vertex in the face) pairs of the incident faces
+are packed contiguously in a single array, and an offset array tells where the ring of each
+vertex starts, so walking a one-ring is a linear scan instead of pointer chasing through
+the face vector. The faces around a vertex are listed in increasing face index order.
+
+It does not need any VF component on the mesh, only the face-vertex relation.
+The structure is a snapshot: any change to the topology or a reallocation of the vertex/face
+containers invalidates it and it must be rebuilt (see IsUpToDate()).
+
+Typical usage:
+\code
+tri::VFAdjacencyCSR<MyMesh> vfa(m);
+for(tri::VFAdjacencyCSR<MyMesh>::Iterator vfi=vfa.Begin(&m.vert[i]);!vfi.End();++vfi)
+  star += vfi.V1()->P();
+\endcode
+*/
+template <class MeshType>
+class VFAdjacencyCSR
+{
+public:
+  typedef typename MeshType::VertexType     VertexType;
+  typedef typename MeshType::VertexPointer  VertexPointer;
+  typedef typename MeshType::FaceType       FaceType;
+  typedef typename MeshType::FacePointer    FacePointer;
+
+  /// A single (face, vertex index) entry of the adjacency
+  struct Entry
+  {
+    FacePointer f;
+    int z;
+  };
+
+  /// \brief Iterator over the faces incident on a vertex, with the same interface of face::VFIterator.
+  class Iterator
+  {
+  public:
+    Iterator() : cur(0), end(0) {}
+    Iterator(const Entry *_b, const Entry *_e) : cur(_b), end(_e) {}
+
+    FacePointer F() const { return cur->f; }
+    int         I() const { return cur->z; }
+
+    inline VertexPointer V()  const { return cur->f->V(cur->z); }
+    inline VertexPointer V0() const { return cur->f->V0(cur->z); }
+    inline VertexPointer V1() const { return cur->f->V1(cur->z); }
+    inline VertexPointer V2() const { return cur->f->V2(cur->z); }
+
+    bool End() const { return cur==end; }
+    void operator++() { ++cur; }
+    void operator++(int) { ++cur; }
+
+  private:
+    const Entry *cur;
+    const Entry *end;
+  };
+
+  VFAdjacencyCSR() : vertBase(0), faceBase(0), vertNum(0), faceNum(0) {}
+  VFAdjacencyCSR(MeshType &m) : vertBase(0), faceBase(0), vertNum(0), faceNum(0) { Build(m); }
+
+  /// \brief Build the adjacency of the mesh (multi-threaded when OpenMP is available).
+  /// Faces are counted per vertex, the offsets are computed with a blocked prefix sum
+  /// and then each face scatters its entries; finally each ring is sorted by face index.
+  void Build(MeshType &m)
+  {
+    Clear();
+    vertNum  = m.vert.size();
+    faceNum  = m.face.size();
+    vertBase = vertNum>0 ? &*m.vert.begin() : 0;
+    faceBase = faceNum>0 ? &*m.face.begin() : 0;
+    offset.assign(vertNum+1,0);
+    if(vertNum==0 || faceNum==0) return;
+
+    const int fn = int(faceNum);
+    const int vn = int(vertNum);
+    std::vector<std::atomic<int> > cursor(vertNum);
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vn;++i)
+      cursor[i].store(0,std::memory_order_relaxed);
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<fn;++i)
+    {
+      const FaceType &f = m.face[i];
+      if(f.IsD()) continue;
+      for(int j=0;j<f.VN();++j)
+        cursor[f.cV(j)-vertBase].fetch_add(1,std::memory_order_relaxed);
+    }
+
+    PrefixSum(cursor,offset);
+    entry.resize(offset[vertNum]);
+
+    // reuse the counters as insertion cursors
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<vn;++i)
+      cursor[i].store(0,std::memory_order_relaxed);
+#pragma omp parallel for schedule(static)
+    for(int i=0;i<fn;++i)
+    {
+      FaceType &f = m.face[i];
+      if(f.IsD()) continue;
+      for(int j=0;j<f.VN();++j)
+      {
+        const size_t vi = f.V(j)-vertBase;
+        const size_t pos = offset[vi] + cursor[vi].fetch_add(1,std::memory_order_relaxed);
+        entry[pos].f = &f;
+        entry[pos].z = j;
+      }
+    }
+
+    // the scatter order depends on thread scheduling, sorting the rings makes it deterministic
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(int i=0;i<vn;++i)
+      std::sort(entry.begin()+offset[i],entry.begin()+offset[i+1],EntryLess());
+  }
+
+  void Clear()
+  {
+    offset.clear();
+    entry.clear();
+    vertBase=0; faceBase=0;
+    vertNum=0;  faceNum=0;
+  }
+
+  /// \brief True if the containers of the mesh have not been reallocated nor resized since the last Build().
+  /// Topological changes that keep the container sizes (e.g. edge flips) cannot be detected.
+  bool IsUpToDate(const MeshType &m) const
+  {
+    return vertNum==m.vert.size() && faceNum==m.face.size() &&
+        (vertNum==0 || vertBase==&*m.vert.begin()) &&
+        (faceNum==0 || faceBase==&*m.face.begin());
+  }
+
+  /// Number of faces incident on the i-th vertex of the mesh
+  int Degree(size_t vi) const { return int(offset[vi+1]-offset[vi]); }
+  int Degree(const VertexType *v) const { return Degree(v-vertBase); }
+
+  Iterator Begin(size_t vi) const
+  {
+    assert(vi<vertNum);
+    return Iterator(entry.data()+offset[vi],entry.data()+offset[vi+1]);
+  }
+  Iterator Begin(const VertexType *v) const { return Begin(size_t(v-vertBase)); }
+
+  /// Raw access to the packed arrays; the ring of vertex i is entry[offset[i]] .. entry[offset[i+1]-1]
+  const std::vector<size_t> &Offset() const { return offset; }
+  const std::vector<Entry>  &Entries() const { return entry; }
+
+private:
+  class EntryLess
+  {
+  public:
+    bool operator () (const Entry &a, const Entry &b) const
+    {
+      if(a.f!=b.f) return a.f<b.f;
+      return a.z<b.z;
+    }
+  };
+
+  /// Exclusive prefix sum of cnt into off (off.size()==cnt.size()+1), done in parallel over fixed size blocks.
+  static void PrefixSum(const std::vector<std::atomic<int> > &cnt, std::vector<size_t> &off)
+  {
+    const size_t n = cnt.size();
+    const int blockNum = int(std::max<size_t>(1,std::min<size_t>(256,n/16384)));
+    const size_t blockSize = (n+blockNum-1)/blockNum;
+    std::vector<size_t> blockSum(blockNum+1,0);
+#pragma omp parallel for schedule(static)
+    for(int b=0;b<blockNum;++b)
+    {
+      size_t s=0;
+      const size_t iEnd=std::min(n,(b+1)*blockSize);
+      for(size_t i=b*blockSize;i<iEnd;++i) s+=cnt[i].load(std::memory_order_relaxed);
+      blockSum[b+1]=s;
+    }
+    for(int b=0;b<blockNum;++b) blockSum[b+1]+=blockSum[b];
+#pragma omp parallel for schedule(static)
+    for(int b=0;b<blockNum;++b)
+    {
+      size_t s=blockSum[b];
+      const size_t iEnd=std::min(n,(b+1)*blockSize);
+      for(size_t i=b*blockSize;i<iEnd;++i) { off[i]=s; s+=cnt[i].load(std::memory_order_relaxed); }
+    }
+    off[n]=blockSum[blockNum];
+  }
+
+  std::vector<size_t> offset;
+  std::vector<Entry>  entry;
+  const VertexType   *vertBase;
+  const FaceType     *faceBase;
+  size_t vertNum;
+  size_t faceNum;
+};
+
+} // end namespace tri
+} // end namespace vcg
+
+#endif // __VCG_TRI_VF_ADJACENCY_CSR
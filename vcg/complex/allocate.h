@@ -85,6 +85,21 @@ void ResizeAttribute(ATTR_CONT &c, size_t sz, MeshType &/*m*/){
     ((typename MeshType::PointerToAttribute)(*ai)).Resize(sz);
 }
 
+template <class ATTR_CONT>
+void AppendAttributeMemoryInfo(const ATTR_CONT &c, const char *element, size_t elemNum, std::vector<AttributeMemoryInfo> &report){
+  for(typename ATTR_CONT::const_iterator ai = c.begin(); ai != c.end(); ++ai)
+  {
+    AttributeMemoryInfo info;
+    info.name = (*ai)._name;
+    info.element = element;
+    info.type = (*ai)._type;
+    info.elemSize = ((const SimpleTempDataBase *)(*ai)._handle)->SizeOf();
+    info.elemNum = elemNum;
+    info.bytes = info.elemSize*info.elemNum;
+    report.push_back(info);
+  }
+}
+
 /*!
         \brief  Class to safely add and delete elements in a mesh.
 
@@ -174,6 +189,256 @@ public:
     bool preventUpdateFlag; /// when true no update is considered necessary.
   };
 
+  /* +++++++++++++++ Pointer fixing after reallocation ++++++++++++++++ */
+
+  /** \brief Update all the vertex pointers stored in the other simplices of the mesh after the vertex vector has been reallocated.
+            \param pu a PointerUpdater initialized with the old and new base of the vertex vector.
+            */
+  static void UpdateVertexPointers(MeshType &m, PointerUpdater<VertexPointer> &pu)
+  {
+    for (FaceIterator fi=m.face.begin(); fi!=m.face.end(); ++fi)
+      if(!(*fi).IsD())
+        for(int i=0; i < (*fi).VN(); ++i)
+          if ((*fi).cV(i)!=0) pu.Update((*fi).V(i));
+
+    for (EdgeIterator ei=m.edge.begin(); ei!=m.edge.end(); ++ei)
+      if(!(*ei).IsD())
+      {
+        // if(HasEVAdjacency (m)) 
+        pu.Update((*ei).V(0));
+        pu.Update((*ei).V(1));
+        //							if(HasEVAdjacency(m))   pu.Update((*ei).EVp());
+      }
+
+    HEdgeIterator hi;
+    for (hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
+      if(!(*hi).IsD())
+      {
+        if(HasHVAdjacency (m))
+        {
+          pu.Update((*hi).HVp());
+        }
+      }
+
+    for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
+      if (!(*ti).IsD())
+        for (int i = 0; i < 4; ++i)
+          if ((*ti).cV(i) != 0)
+            pu.Update((*ti).V(i));
+  }
+
+  /** \brief Update all the edge pointers stored in the mesh after the edge vector has been reallocated.
+            The edges from firstNewEdge on are not yet initialized and are skipped.
+            */
+  static void UpdateEdgePointers(MeshType &m, PointerUpdater<EdgePointer> &pu, EdgeIterator firstNewEdge)
+  {
+    if(HasFEAdjacency(m))
+      for (FaceIterator fi=m.face.begin(); fi!=m.face.end(); ++fi){
+        if(!(*fi).IsD())
+          for(int i=0; i < (*fi).VN(); ++i)
+            if ((*fi).cFEp(i)!=0) pu.Update((*fi).FEp(i));
+      }
+
+    if(HasVEAdjacency(m)){
+      for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
+        if(!(*vi).IsD())
+          if ((*vi).cVEp()!=0) pu.Update((*vi).VEp());
+      for(EdgeIterator ei=m.edge.begin();ei!=firstNewEdge;++ei)
+        if(!(*ei).IsD())
+        {            
+          if ((*ei).cVEp(0)!=0) pu.Update((*ei).VEp(0));
+          if ((*ei).cVEp(1)!=0) pu.Update((*ei).VEp(1));
+        }        
+    }
+    
+    if(HasHEAdjacency(m))
+      for (HEdgeIterator hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
+        if(!(*hi).IsD())
+          if ((*hi).cHEp()!=0) pu.Update((*hi).HEp());
+  }
+
+  /** \brief Update all the face pointers stored in the mesh after the face vector has been reallocated.
+            The faces from firstNewFace on are not yet initialized and are skipped.
+            */
+  static void UpdateFacePointers(MeshType &m, PointerUpdater<FacePointer> &pu, FaceIterator firstNewFace)
+  {
+    if(HasFFAdjacency(m))
+    {  // cycle on all the faces except the new ones
+      for(FaceIterator fi=m.face.begin();fi!=firstNewFace;++fi)
+        if(!(*fi).IsD())
+          for(int i  = 0; i < (*fi).VN(); ++i)
+            if ((*fi).cFFp(i)!=0) pu.Update((*fi).FFp(i));
+    }
+
+    if(HasPerVertexVFAdjacency(m) && HasPerFaceVFAdjacency(m))
+    {  // cycle on all the faces except the new ones
+      for(FaceIterator fi=m.face.begin();fi!=firstNewFace;++fi)
+        if(!(*fi).IsD())
+          for(int i = 0; i < (*fi).VN(); ++i)
+            if ((*fi).cVFp(i)!=0) pu.Update((*fi).VFp(i));
+
+      for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
+        if(!(*vi).IsD() && (*vi).cVFp()!=0)
+          pu.Update((*vi).VFp());
+    }
+
+    if(HasEFAdjacency(m))
+    {
+      for (EdgeIterator ei=m.edge.begin(); ei!=m.edge.end(); ++ei)
+        if(!(*ei).IsD() && (*ei).cEFp()!=0)
+          pu.Update((*ei).EFp());
+    }
+
+    if(HasHFAdjacency(m))
+    {
+      for (HEdgeIterator hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
+        if(!(*hi).IsD() && (*hi).cHFp()!=0)
+          pu.Update((*hi).HFp());
+    }
+  }
+
+  /** \brief Update all the tetra pointers stored in the mesh after the tetra vector has been reallocated.
+            The tetras from firstNewTetra on are not yet initialized and are skipped.
+            */
+  static void UpdateTetraPointers(MeshType &m, PointerUpdater<TetraPointer> &pu, TetraIterator firstNewTetra)
+  {
+    if (HasVTAdjacency(m))
+    {
+      for (VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
+        if (!vi->IsD())
+          pu.Update(vi->VTp());
+
+      for (TetraIterator ti = m.tetra.begin(); ti != firstNewTetra; ++ti)
+        if (!ti->IsD())
+        {
+          pu.Update(ti->VTp(0));
+          pu.Update(ti->VTp(1));
+          pu.Update(ti->VTp(2));
+          pu.Update(ti->VTp(3));
+        } 
+    }
+
+    //do edge and face adjacency
+    if (HasTTAdjacency(m))
+      for (TetraIterator ti = m.tetra.begin(); ti != firstNewTetra; ++ti)
+        if (!ti->IsD())
+        {
+          pu.Update(ti->TTp(0));
+          pu.Update(ti->TTp(1));
+          pu.Update(ti->TTp(2));
+          pu.Update(ti->TTp(3));
+        }
+  }
+
+  /* +++++++++++++++ Reserve ++++++++++++++++ */
+
+  /** \brief Make room for at least n vertices, so that the following AddVertices() calls
+            that keep the vertex vector within n elements never reallocate it.
+            Growing a vector that already holds elements costs a pass over all the
+            simplices that refer to them (see PointerUpdater); algorithms that add elements
+            incrementally (refinement, remeshing, hole filling) can reserve their estimated
+            final size once and pay that pass at most once.
+            \param pu a PointerUpdater that can be used to update local pointers to vertices, as in AddVertices()
+            */
+  static void ReserveVertices(MeshType &m, size_t n, PointerUpdater<VertexPointer> &pu)
+  {
+    pu.Clear();
+    if(n <= m.vert.capacity()) return;
+    if(m.vert.empty())
+    {
+      m.vert.reserve(n);
+      return;
+    }
+    pu.oldBase=&*m.vert.begin();
+    pu.oldEnd=&m.vert.back()+1;
+    m.vert.reserve(n);
+    pu.newBase = &*m.vert.begin();
+    pu.newEnd =  &m.vert.back()+1;
+    if(pu.NeedUpdate())
+      UpdateVertexPointers(m,pu);
+  }
+
+  static void ReserveVertices(MeshType &m, size_t n)
+  {
+    PointerUpdater<VertexPointer> pu;
+    ReserveVertices(m,n,pu);
+  }
+
+  /** \brief Make room for at least n edges, see ReserveVertices(). */
+  static void ReserveEdges(MeshType &m, size_t n, PointerUpdater<EdgePointer> &pu)
+  {
+    pu.Clear();
+    if(n <= m.edge.capacity()) return;
+    if(m.edge.empty())
+    {
+      m.edge.reserve(n);
+      return;
+    }
+    pu.oldBase=&*m.edge.begin();
+    pu.oldEnd=&m.edge.back()+1;
+    m.edge.reserve(n);
+    pu.newBase = &*m.edge.begin();
+    pu.newEnd =  &m.edge.back()+1;
+    if(pu.NeedUpdate())
+      UpdateEdgePointers(m,pu,m.edge.end());
+  }
+
+  static void ReserveEdges(MeshType &m, size_t n)
+  {
+    PointerUpdater<EdgePointer> pu;
+    ReserveEdges(m,n,pu);
+  }
+
+  /** \brief Make room for at least n faces, see ReserveVertices(). */
+  static void ReserveFaces(MeshType &m, size_t n, PointerUpdater<FacePointer> &pu)
+  {
+    pu.Clear();
+    if(n <= m.face.capacity()) return;
+    if(m.face.empty())
+    {
+      m.face.reserve(n);
+      return;
+    }
+    pu.oldBase=&*m.face.begin();
+    pu.oldEnd=&m.face.back()+1;
+    m.face.reserve(n);
+    pu.newBase = &*m.face.begin();
+    pu.newEnd  = &m.face.back()+1;
+    if(pu.NeedUpdate())
+      UpdateFacePointers(m,pu,m.face.end());
+  }
+
+  static void ReserveFaces(MeshType &m, size_t n)
+  {
+    PointerUpdater<FacePointer> pu;
+    ReserveFaces(m,n,pu);
+  }
+
+  /** \brief Make room for at least n tetras, see ReserveVertices(). */
+  static void ReserveTetras(MeshType &m, size_t n, PointerUpdater<TetraPointer> &pu)
+  {
+    pu.Clear();
+    if(n <= m.tetra.capacity()) return;
+    if(m.tetra.empty())
+    {
+      m.tetra.reserve(n);
+      return;
+    }
+    pu.oldBase=&*m.tetra.begin();
+    pu.oldEnd=&m.tetra.back()+1;
+    m.tetra.reserve(n);
+    pu.newBase = &*m.tetra.begin();
+    pu.newEnd  = &m.tetra.back()+1;
+    if(pu.NeedUpdate())
+      UpdateTetraPointers(m,pu,m.tetra.end());
+  }
+
+  static void ReserveTetras(MeshType &m, size_t n)
+  {
+    PointerUpdater<TetraPointer> pu;
+    ReserveTetras(m,n,pu);
+  }
+
   /* +++++++++++++++ Add Vertices ++++++++++++++++ */
 
   /** \brief Add n vertices to the mesh.
@@ -210,41 +475,12 @@ public:
     pu.newBase = &*m.vert.begin();
     pu.newEnd =  &m.vert.back()+1;
     if(pu.NeedUpdate())
-    {
-      for (FaceIterator fi=m.face.begin(); fi!=m.face.end(); ++fi)
-        if(!(*fi).IsD())
-          for(int i=0; i < (*fi).VN(); ++i)
-            if ((*fi).cV(i)!=0) pu.Update((*fi).V(i));
-
-      for (EdgeIterator ei=m.edge.begin(); ei!=m.edge.end(); ++ei)
-        if(!(*ei).IsD())
-        {
-          // if(HasEVAdjacency (m)) 
-          pu.Update((*ei).V(0));
-          pu.Update((*ei).V(1));
-          //							if(HasEVAdjacency(m))   pu.Update((*ei).EVp());
-        }
-
-      HEdgeIterator hi;
-      for (hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
-        if(!(*hi).IsD())
-        {
-          if(HasHVAdjacency (m))
-          {
-            pu.Update((*hi).HVp());
-          }
-        }
-
-      for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-        if (!(*ti).IsD())
-          for (int i = 0; i < 4; ++i)
-            if ((*ti).cV(i) != 0)
-              pu.Update((*ti).V(i));
-
-      // e poiche' lo spazio e' cambiato si ricalcola anche last da zero
-    }
+      UpdateVertexPointers(m,pu);
     size_t siz=(size_t)(m.vert.size()-n);
 
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      dr->boxVert.AddRange(siz,n,m.vert.size());
+
     last = m.vert.begin();
     advance(last,siz);
 
@@ -353,31 +589,7 @@ public:
     pu.newBase = &*m.edge.begin();
     pu.newEnd =  &m.edge.back()+1;
     if(pu.NeedUpdate())
-    {
-      if(HasFEAdjacency(m))
-        for (FaceIterator fi=m.face.begin(); fi!=m.face.end(); ++fi){
-          if(!(*fi).IsD())
-            for(int i=0; i < (*fi).VN(); ++i)
-              if ((*fi).cFEp(i)!=0) pu.Update((*fi).FEp(i));
-        }
-
-      if(HasVEAdjacency(m)){
-        for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
-          if(!(*vi).IsD())
-            if ((*vi).cVEp()!=0) pu.Update((*vi).VEp());
-        for(EdgeIterator ei=m.edge.begin();ei!=firstNewEdge;++ei)
-          if(!(*ei).IsD())
-          {            
-            if ((*ei).cVEp(0)!=0) pu.Update((*ei).VEp(0));
-            if ((*ei).cVEp(1)!=0) pu.Update((*ei).VEp(1));
-          }        
-      }
-      
-      if(HasHEAdjacency(m))
-        for (HEdgeIterator hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
-          if(!(*hi).IsD())
-            if ((*hi).cHEp()!=0) pu.Update((*hi).HEp());
-    }
+      UpdateEdgePointers(m,pu,firstNewEdge);
     
     return firstNewEdge;// deve restituire l'iteratore alla prima faccia aggiunta;
   }
@@ -687,41 +899,10 @@ public:
     pu.newEnd  = &m.face.back()+1;
 
     if(pu.NeedUpdate())
-    {
-      if(HasFFAdjacency(m))
-      {  // cycle on all the faces except the new ones
-        for(FaceIterator fi=m.face.begin();fi!=firstNewFace;++fi)
-          if(!(*fi).IsD())
-            for(int i  = 0; i < (*fi).VN(); ++i)
-              if ((*fi).cFFp(i)!=0) pu.Update((*fi).FFp(i));
-      }
-
-      if(HasPerVertexVFAdjacency(m) && HasPerFaceVFAdjacency(m))
-      {  // cycle on all the faces except the new ones
-        for(FaceIterator fi=m.face.begin();fi!=firstNewFace;++fi)
-          if(!(*fi).IsD())
-            for(int i = 0; i < (*fi).VN(); ++i)
-              if ((*fi).cVFp(i)!=0) pu.Update((*fi).VFp(i));
-
-        for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
-          if(!(*vi).IsD() && (*vi).cVFp()!=0)
-            pu.Update((*vi).VFp());
-      }
+      UpdateFacePointers(m,pu,firstNewFace);
 
-      if(HasEFAdjacency(m))
-      {
-        for (EdgeIterator ei=m.edge.begin(); ei!=m.edge.end(); ++ei)
-          if(!(*ei).IsD() && (*ei).cEFp()!=0)
-            pu.Update((*ei).EFp());
-      }
-
-      if(HasHFAdjacency(m))
-      {
-        for (HEdgeIterator hi=m.hedge.begin(); hi!=m.hedge.end(); ++hi)
-          if(!(*hi).IsD() && (*hi).cHFp()!=0)
-            pu.Update((*hi).HFp());
-      }
-    }
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      dr->normalFace.AddRange(siz,n,m.face.size());
     return firstNewFace;
   }
 
@@ -775,34 +956,7 @@ public:
     pu.newBase = &*m.tetra.begin();
     pu.newEnd  = &m.tetra.back() + 1;
     if (pu.NeedUpdate())
-    {
-      if (HasVTAdjacency(m))
-      {
-        for (VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-          if (!vi->IsD())
-            pu.Update(vi->VTp());
-
-        for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-          if (!ti->IsD())
-          {
-            pu.Update(ti->VTp(0));
-            pu.Update(ti->VTp(1));
-            pu.Update(ti->VTp(2));
-            pu.Update(ti->VTp(3));
-          } 
-      }
-
-      //do edge and face adjacency
-      if (HasTTAdjacency(m))
-        for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-          if (!ti->IsD())
-          {
-            pu.Update(ti->TTp(0));
-            pu.Update(ti->TTp(1));
-            pu.Update(ti->TTp(2));
-            pu.Update(ti->TTp(3));
-          }
-    }
+      UpdateTetraPointers(m,pu,firstNewTetra);
 
     return firstNewTetra;
   }
@@ -915,6 +1069,67 @@ public:
     return t_ret;
   }
 
+  /* +++++++++++++++ Dirty region tracking ++++++++++++++++ */
+
+  /** \brief Start recording the elements touched by the editing operations, see DirtyRegion.
+            The elements added or deleted through the Allocator and the ones modified by the local optimization operators
+            are recorded automatically; the ones changed directly by the user code must be notified with MarkDirtyVertex() and MarkDirtyFace().
+            The first incremental update after enabling the tracking is a full one.
+            */
+  static void EnableDirtyTracking(MeshType &m)
+  {
+    m.dirtyTracking = true;
+    if(GetDirtyRegion(m)==nullptr)
+      AddPerMeshAttribute<DirtyRegion>(m,DirtyRegion::AttributeName());
+  }
+
+  static void DisableDirtyTracking(MeshType &m)
+  {
+    m.dirtyTracking = false;
+    DeletePerMeshAttribute(m,DirtyRegion::AttributeName());
+  }
+
+  /** \brief The dirty region of the mesh, or nullptr if the tracking is not enabled.
+            The by-name lookup is done only while the tracking is enabled, so the Add/Delete functions pay a single test otherwise.
+            */
+  static DirtyRegion *GetDirtyRegion(MeshType &m)
+  {
+    if(!m.dirtyTracking) return nullptr;
+    AttrIterator i = m.mesh_attr.FindByName(DirtyRegion::AttributeName());
+    if(i==m.mesh_attr.end() || (*i)._type!=std::type_index(typeid(DirtyRegion))) return nullptr;
+    return (DirtyRegion *)((*i)._handle->DataBegin());
+  }
+
+  /** \brief Record that a vertex is going to be moved.
+            Call it before changing the position, so that the bounding box is recomputed only if the vertex was on its boundary.
+            */
+  static void MarkDirtyVertex(MeshType &m, VertexType &v)
+  {
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+    {
+      const size_t vi = tri::Index(m,v);
+      dr->normalVert.Add(vi,m.vert.size());
+      dr->boxVert.Add(vi,m.vert.size());
+      if(OnBoxBoundary(m.bbox,v.cP())) dr->boxShrink=true;
+    }
+  }
+
+  /** \brief Record that the vertices of a face have been changed (e.g. by an edge flip).
+            */
+  static void MarkDirtyFace(MeshType &m, FaceType &f)
+  {
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      dr->normalFace.Add(tri::Index(m,f),m.face.size());
+  }
+
+  static bool OnBoxBoundary(const typename MeshType::BoxType &b, const CoordType &p)
+  {
+    if(b.IsNull()) return false;
+    for(int k=0;k<3;++k)
+      if(p[k]<=b.min[k] || p[k]>=b.max[k]) return true;
+    return false;
+  }
+
   /* +++++++++++++++ Deleting  ++++++++++++++++ */
 
   /** Function to delete a face from the mesh.
@@ -924,6 +1139,9 @@ public:
   {
     assert(&f >= &m.face.front() && &f <= &m.face.back());
     assert(!f.IsD());
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      for(int i=0;i<f.VN();++i)
+        if(f.V(i)!=0) dr->normalVert.Add(tri::Index(m,f.V(i)),m.vert.size());
     f.Dealloc();
     f.SetD();
     --m.fn;
@@ -936,6 +1154,8 @@ public:
   {
     assert(&v >= &m.vert.front() && &v <= &m.vert.back());
     assert(!v.IsD());
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      if(OnBoxBoundary(m.bbox,v.cP())) dr->boxShrink=true;
     v.SetD();
     --m.vn;
   }
@@ -973,6 +1193,41 @@ public:
     --m.tn;
   }
 
+  /*!
+    \brief Compute the remap used to compact a container: remap[i] is the new position of the i-th element, or max size_t for deleted elements.
+    The positions are computed with a parallel blocked prefix sum. It returns the number of not deleted elements.
+    */
+  template <class ContainerType>
+  static size_t CompactionRemap(const ContainerType &cont, std::vector<size_t> &remap)
+  {
+    const size_t n = cont.size();
+    remap.resize(n,std::numeric_limits<size_t>::max());
+    if(n==0) return 0;
+    const int blockNum = int(std::max<size_t>(1,std::min<size_t>(256,n/16384)));
+    const size_t blockSize = (n+blockNum-1)/blockNum;
+    std::vector<size_t> blockStart(blockNum+1,0);
+#pragma omp parallel for schedule(static)
+    for(int b=0;b<blockNum;++b)
+    {
+      size_t cnt=0;
+      const size_t iEnd = std::min(n,(b+1)*blockSize);
+      for(size_t i=b*blockSize;i<iEnd;++i)
+        if(!cont[i].IsD()) ++cnt;
+      blockStart[b+1]=cnt;
+    }
+    for(int b=0;b<blockNum;++b)
+      blockStart[b+1]+=blockStart[b];
+#pragma omp parallel for schedule(static)
+    for(int b=0;b<blockNum;++b)
+    {
+      size_t pos=blockStart[b];
+      const size_t iEnd = std::min(n,(b+1)*blockSize);
+      for(size_t i=b*blockSize;i<iEnd;++i)
+        if(!cont[i].IsD()) remap[i]=pos++;
+    }
+    return blockStart[blockNum];
+  }
+
   /*
             Function to rearrange the vertex vector according to a given index permutation
             the permutation is vector such that after calling this function
@@ -1039,31 +1294,47 @@ public:
     ResizeAttribute(m.vert_attr,m.vn,m);
 
     // Loop on the face to update the pointers FV relation (vertex refs)
-    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-      if(!(*fi).IsD())
-        for(int i=0;i<fi->VN();++i)
+    // each face only touches its own references, so the loops below are run in parallel
+    const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+    for(int k=0;k<faceNum;++k)
+    {
+      FaceType &f = m.face[k];
+      if(!f.IsD())
+        for(int i=0;i<f.VN();++i)
         {
-          size_t oldIndex = (*fi).V(i) - pu.oldBase;
-          assert(pu.oldBase <= (*fi).V(i) && oldIndex < pu.remap.size());
-          (*fi).V(i) = pu.newBase+pu.remap[oldIndex];
+          size_t oldIndex = f.V(i) - pu.oldBase;
+          assert(pu.oldBase <= f.V(i) && oldIndex < pu.remap.size());
+          f.V(i) = pu.newBase+pu.remap[oldIndex];
         }
+    }
     // Loop on the tetras to update the pointers TV relation (vertex refs)
-    for(TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-      if(!(*ti).IsD())
+    const int tetraNum = int(m.tetra.size());
+#pragma omp parallel for schedule(static)
+    for(int k=0;k<tetraNum;++k)
+    {
+      TetraType &t = m.tetra[k];
+      if(!t.IsD())
         for(int i = 0; i < 4; ++i)
         {
-          size_t oldIndex = (*ti).V(i) - pu.oldBase;
-          assert(pu.oldBase <= (*ti).V(i) && oldIndex < pu.remap.size());
-          (*ti).V(i) = pu.newBase+pu.remap[oldIndex];
+          size_t oldIndex = t.V(i) - pu.oldBase;
+          assert(pu.oldBase <= t.V(i) && oldIndex < pu.remap.size());
+          t.V(i) = pu.newBase+pu.remap[oldIndex];
         }
+    }
     // Loop on the edges to update the pointers EV relation (vertex refs)
     // if(HasEVAdjacency(m))
-      for(EdgeIterator ei=m.edge.begin();ei!=m.edge.end();++ei)
-        if(!(*ei).IsD())
-        {
-          pu.Update((*ei).V(0));
-          pu.Update((*ei).V(1));
-        }
+    const int edgeNum = int(m.edge.size());
+#pragma omp parallel for schedule(static)
+    for(int k=0;k<edgeNum;++k)
+    {
+      EdgeType &e = m.edge[k];
+      if(!e.IsD())
+      {
+        pu.Update(e.V(0));
+        pu.Update(e.V(1));
+      }
+    }
   }
 
   static void CompactEveryVector(MeshType &m)
@@ -1087,22 +1358,17 @@ public:
     if(m.vn==(int)m.vert.size()) return;
 
     // newVertIndex [ <old_vert_position> ] gives you the new position of the vertex in the vector;
-    pu.remap.resize( m.vert.size(),std::numeric_limits<size_t>::max() );
+    size_t pos = CompactionRemap(m.vert,pu.remap);
+    assert((int)pos==m.vn);
+    (void)pos;
 
-    size_t pos=0;
-    size_t i=0;
+    PermutateVertexVector(m, pu);
 
-    for(i=0;i<m.vert.size();++i)
+    if(DirtyRegion *dr = GetDirtyRegion(m))
     {
-      if(!m.vert[i].IsD())
-      {
-        pu.remap[i]=pos;
-        ++pos;
-      }
+      dr->normalVert.Remap(pu.remap);
+      dr->boxVert.Remap(pu.remap);
     }
-    assert((int)pos==m.vn);
-
-    PermutateVertexVector(m, pu);
   }
 
   /*! \brief Wrapper without the PointerUpdater. */
@@ -1125,20 +1391,9 @@ public:
     if(m.en==(int)m.edge.size()) return;
 
     // remap [ <old_edge_position> ] gives you the new position of the edge in the vector;
-    pu.remap.resize( m.edge.size(),std::numeric_limits<size_t>::max() );
-
-    size_t pos=0;
-    size_t i=0;
-
-    for(i=0;i<m.edge.size();++i)
-    {
-      if(!m.edge[i].IsD())
-      {
-        pu.remap[i]=pos;
-        ++pos;
-      }
-    }
+    size_t pos = CompactionRemap(m.edge,pu.remap);
     assert((int)pos==m.en);
+    (void)pos;
 
     // the actual copying of the data.
     for(size_t i=0;i<m.edge.size();++i)
@@ -1197,18 +1452,26 @@ public:
     ResizeAttribute(m.edge_attr,m.en,m);
 
     // Loop on the vertices to update the pointers of VE relation
-    if(HasVEAdjacency(m))
-      for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
-        if(!(*vi).IsD())  pu.Update((*vi).VEp());
+    const bool hasVE = HasVEAdjacency(m);
+    const bool hasEE = HasEEAdjacency(m);
+    const int vertNum = int(m.vert.size());
+    if(hasVE)
+    {
+#pragma omp parallel for schedule(static)
+      for(int k=0;k<vertNum;++k)
+        if(!m.vert[k].IsD())  pu.Update(m.vert[k].VEp());
+    }
 
     // Loop on the edges to update the pointers EE VE relation
-    for(EdgeIterator ei=m.edge.begin();ei!=m.edge.end();++ei)
+    const int edgeNum = int(m.edge.size());
+#pragma omp parallel for schedule(static)
+    for(int k=0;k<edgeNum;++k)
       for(unsigned int i=0;i<2;++i)
       {
-        if(HasVEAdjacency(m))
-          pu.Update((*ei).VEp(i));
-        if(HasEEAdjacency(m))
-          pu.Update((*ei).EEp(i));
+        if(hasVE)
+          pu.Update(m.edge[k].VEp(i));
+        if(hasEE)
+          pu.Update(m.edge[k].EEp(i));
 //        if(HasEFAdjacency(m))
 //          pu.Update((*ei).EFp());
       }
@@ -1234,8 +1497,9 @@ public:
     if(m.fn==(int)m.face.size()) return;
 
     // newFaceIndex [ <old_face_position> ] gives you the new position of the face in the vector;
-    pu.remap.resize( m.face.size(),std::numeric_limits<size_t>::max() );
+    CompactionRemap(m.face,pu.remap);
 
+    // the moves are done serially: the compaction is in place and each face can overwrite the next ones to be moved
     size_t pos=0;
     for(size_t i=0;i<m.face.size();++i)
     {
@@ -1268,7 +1532,7 @@ public:
                 m.face[pos].FFi(j) = m.face[i].cFFi(j);
               }
         }
-        pu.remap[i]=pos;
+        assert(pu.remap[i]==pos);
         ++pos;
       }
     }
@@ -1280,18 +1544,25 @@ public:
     FacePointer fbase=&m.face[0];
 
     // Loop on the vertices to correct VF relation
-    if(HasVFAdjacency(m))
+    const bool hasVF = HasVFAdjacency(m);
+    const bool hasFF = HasFFAdjacency(m);
+    if(hasVF)
     {
-      for (VertexIterator vi=m.vert.begin(); vi!=m.vert.end(); ++vi)
-        if(!(*vi).IsD())
+      const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+      for(int k=0;k<vertNum;++k)
+      {
+        VertexType &v = m.vert[k];
+        if(!v.IsD())
         {
-          if ((*vi).IsVFInitialized() && (*vi).VFp()!=0 )
+          if (v.IsVFInitialized() && v.VFp()!=0 )
           {
-            size_t oldIndex = (*vi).cVFp() - fbase;
-            assert(fbase <= (*vi).cVFp() && oldIndex < pu.remap.size());
-            (*vi).VFp() = fbase+pu.remap[oldIndex];
+            size_t oldIndex = v.cVFp() - fbase;
+            assert(fbase <= v.cVFp() && oldIndex < pu.remap.size());
+            v.VFp() = fbase+pu.remap[oldIndex];
           }
         }
+      }
     }
 
     // Loop on the faces to correct VF and FF relations
@@ -1308,29 +1579,34 @@ public:
     ResizeAttribute(m.face_attr,m.fn,m);
 
     // now we update the various (not null) face pointers (inside VF and FF relations)
-    for(FaceIterator fi=m.face.begin();fi!=m.face.end();++fi)
-      if(!(*fi).IsD())
+    const int faceNum = int(m.face.size());
+#pragma omp parallel for schedule(static)
+    for(int k=0;k<faceNum;++k)
+    {
+      FaceType &f = m.face[k];
+      if(!f.IsD())
       {
-        if(HasVFAdjacency(m))
-          for(int i=0;i<(*fi).VN();++i)
-            if ((*fi).IsVFInitialized(i) && (*fi).VFp(i)!=0 )
+        if(hasVF)
+          for(int i=0;i<f.VN();++i)
+            if (f.IsVFInitialized(i) && f.VFp(i)!=0 )
             {
-              size_t oldIndex = (*fi).VFp(i) - fbase;
-              assert(fbase <= (*fi).VFp(i) && oldIndex < pu.remap.size());
-              (*fi).VFp(i) = fbase+pu.remap[oldIndex];
+              size_t oldIndex = f.VFp(i) - fbase;
+              assert(fbase <= f.VFp(i) && oldIndex < pu.remap.size());
+              f.VFp(i) = fbase+pu.remap[oldIndex];
             }
-        if(HasFFAdjacency(m))
-          for(int i=0;i<(*fi).VN();++i)
-            if ((*fi).cFFp(i)!=0)
+        if(hasFF)
+          for(int i=0;i<f.VN();++i)
+            if (f.cFFp(i)!=0)
             {
-              size_t oldIndex = (*fi).FFp(i) - fbase;
-			  assert(fbase <= (*fi).FFp(i) && oldIndex < pu.remap.size());
-              (*fi).FFp(i) = fbase+pu.remap[oldIndex];
+              size_t oldIndex = f.FFp(i) - fbase;
+              assert(fbase <= f.FFp(i) && oldIndex < pu.remap.size());
+              f.FFp(i) = fbase+pu.remap[oldIndex];
             }
       }
+    }
 
-
-
+    if(DirtyRegion *dr = GetDirtyRegion(m))
+      dr->normalFace.Remap(pu.remap);
   }
 
   /*! \brief Wrapper without the PointerUpdater. */
@@ -1354,7 +1630,7 @@ public:
       return;
 
     //init the remap 
-    pu.remap.resize(m.tetra.size(), std::numeric_limits<size_t>::max());
+    CompactionRemap(m.tetra,pu.remap);
     
     //cycle over all the tetras, pos is the last not D() position, I is the index
     //when pos != i and !tetra[i].IsD() => we need to compact and update adj
@@ -1390,8 +1666,8 @@ public:
               m.tetra[pos].TTi(j) = m.tetra[i].cTTi(j);
             }
         }
-        //update remapping and advance pos
-        pu.remap[i] = pos;
+        //advance pos
+        assert(pu.remap[i] == pos);
         ++pos;
       }
     }
@@ -1413,43 +1689,55 @@ public:
     TetraPointer tbase = &m.tetra[0];
 
     //Loop on the vertices to correct VT relation (since we moved things around)
-    if (HasVTAdjacency(m))
+    const bool hasVT = HasVTAdjacency(m);
+    const bool hasTT = HasTTAdjacency(m);
+    if (hasVT)
     {
-      for (VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-        if (!(*vi).IsD())
+      const int vertNum = int(m.vert.size());
+#pragma omp parallel for schedule(static)
+      for (int k = 0; k < vertNum; ++k)
+      {
+        VertexType &v = m.vert[k];
+        if (!v.IsD())
         {
-          if ((*vi).IsVTInitialized() && (*vi).VTp() != 0)
+          if (v.IsVTInitialized() && v.VTp() != 0)
           {
-            size_t oldIndex = (*vi).cVTp() - tbase;
-            assert(tbase <= (*vi).cVTp() && oldIndex < pu.remap.size());
-            (*vi).VTp() = tbase + pu.remap[oldIndex];
+            size_t oldIndex = v.cVTp() - tbase;
+            assert(tbase <= v.cVTp() && oldIndex < pu.remap.size());
+            v.VTp() = tbase + pu.remap[oldIndex];
           }
         }
+      }
     }
 
     // Loop on the tetras to correct the VT and TT relations
-    for (TetraIterator ti = m.tetra.begin(); ti != m.tetra.end(); ++ti)
-      if (!(*ti).IsD())
+    const int tetraNum = int(m.tetra.size());
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < tetraNum; ++k)
+    {
+      TetraType &t = m.tetra[k];
+      if (!t.IsD())
       {
         //VT
-        if (HasVTAdjacency(m))
+        if (hasVT)
           for (int i = 0; i < 4; ++i)
-            if ((*ti).IsVTInitialized(i) && (*ti).VTp(i) != 0)
+            if (t.IsVTInitialized(i) && t.VTp(i) != 0)
             {
-              size_t oldIndex = (*ti).VTp(i) - tbase;
-              assert(tbase <= (*ti).VTp(i) && oldIndex < pu.remap.size());
-              (*ti).VTp(i) = tbase + pu.remap[oldIndex];
+              size_t oldIndex = t.VTp(i) - tbase;
+              assert(tbase <= t.VTp(i) && oldIndex < pu.remap.size());
+              t.VTp(i) = tbase + pu.remap[oldIndex];
             }
         //TT
-        if (HasTTAdjacency(m))
+        if (hasTT)
           for (int i = 0; i < 4; ++i)
-            if ((*ti).cTTp(i) != 0)
+            if (t.cTTp(i) != 0)
             {
-              size_t oldIndex = (*ti).TTp(i) - tbase;
-              assert(tbase <= (*ti).TTp(i) && oldIndex < pu.remap.size());
-              (*ti).TTp(i) = tbase + pu.remap[oldIndex];
+              size_t oldIndex = t.TTp(i) - tbase;
+              assert(tbase <= t.TTp(i) && oldIndex < pu.remap.size());
+              t.TTp(i) = tbase + pu.remap[oldIndex];
             }
       }
+    }
   }
 
   /*! \brief Wrapper without the PointerUpdater. */
@@ -1469,9 +1757,7 @@ public:
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template PerVertexAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.vert_attr.begin(); i!=m.vert_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.vert_attr.FindById(a.n_attr) != m.vert_attr.end();
   }
 
   /**
@@ -1481,9 +1767,7 @@ public:
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template ConstPerVertexAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.vert_attr.begin(); i!=m.vert_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.vert_attr.FindById(a.n_attr) != m.vert_attr.end();
   }
 
   /*! \brief Add a Per-Vertex Attribute of the given ATTR_TYPE with the given name.
@@ -1618,12 +1902,11 @@ public:
   static
   void
   ClearPerVertexAttribute( MeshType & m,typename MeshType::template PerVertexAttributeHandle<ATTR_TYPE> & h, const  ATTR_TYPE & initVal = ATTR_TYPE()){
-    typename std::set<PointerToAttribute > ::iterator i;
-    for( i = m.vert_attr.begin(); i !=  m.vert_attr.end(); ++i)
-      if( (*i)._handle == h._handle ){
-        for(typename MeshType::VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
-          h[vi] = initVal;
-        return;}
+    AttrIterator i = m.vert_attr.FindById(h.n_attr);
+    if( i != m.vert_attr.end() && (*i)._handle == h._handle ){
+      for(typename MeshType::VertexIterator vi = m.vert.begin(); vi != m.vert.end(); ++vi)
+        h[vi] = initVal;
+      return;}
     assert(0);
   }
 
@@ -1633,12 +1916,11 @@ public:
   static
   void
   DeletePerVertexAttribute( MeshType & m,typename MeshType::template PerVertexAttributeHandle<ATTR_TYPE> & h){
-    typename std::set<PointerToAttribute > ::iterator i;
-    for( i = m.vert_attr.begin(); i !=  m.vert_attr.end(); ++i)
-      if( (*i)._handle == h._handle ){
-        delete ((SimpleTempData<VertContainer,ATTR_TYPE>*)(*i)._handle);
-        m.vert_attr.erase(i);
-        return;}
+    AttrIterator i = m.vert_attr.FindById(h.n_attr);
+    if( i != m.vert_attr.end() && (*i)._handle == h._handle ){
+      delete ((SimpleTempData<VertContainer,ATTR_TYPE>*)(*i)._handle);
+      m.vert_attr.erase(i);
+    }
   }
 
   // Generic DeleteAttribute.
@@ -1662,18 +1944,14 @@ public:
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template PerEdgeAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.edge_attr.begin(); i!=m.edge_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.edge_attr.FindById(a.n_attr) != m.edge_attr.end();
   }
 
   template <class ATTR_TYPE>
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template ConstPerEdgeAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.edge_attr.begin(); i!=m.edge_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.edge_attr.FindById(a.n_attr) != m.edge_attr.end();
   }
 
   template <class ATTR_TYPE>
@@ -1792,12 +2070,11 @@ public:
   static
   void
   DeletePerEdgeAttribute( MeshType & m,typename MeshType::template PerEdgeAttributeHandle<ATTR_TYPE> & h){
-    typename std::set<PointerToAttribute > ::iterator i;
-    for( i = m.edge_attr.begin(); i !=  m.edge_attr.end(); ++i)
-      if( (*i)._handle == h._handle ){
-        delete ((SimpleTempData<EdgeContainer,ATTR_TYPE>*)(*i)._handle);
-        m.edge_attr.erase(i);
-        return;}
+    AttrIterator i = m.edge_attr.FindById(h.n_attr);
+    if( i != m.edge_attr.end() && (*i)._handle == h._handle ){
+      delete ((SimpleTempData<EdgeContainer,ATTR_TYPE>*)(*i)._handle);
+      m.edge_attr.erase(i);
+    }
   }
 
   // Generic DeleteAttribute.
@@ -1822,9 +2099,7 @@ public:
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template PerFaceAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.face_attr.begin(); i!=m.face_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.face_attr.FindById(a.n_attr) != m.face_attr.end();
   }
 
   /**
@@ -1834,9 +2109,7 @@ public:
   static
   bool IsValidHandle( const MeshType & m,  const typename MeshType::template ConstPerFaceAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.face_attr.begin(); i!=m.face_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.face_attr.FindById(a.n_attr) != m.face_attr.end();
   }
 
   template <class ATTR_TYPE>
@@ -1962,12 +2235,11 @@ public:
     */
   template <class ATTR_TYPE>
   static void DeletePerFaceAttribute( MeshType & m,typename MeshType::template PerFaceAttributeHandle<ATTR_TYPE> & h){
-    typename std::set<PointerToAttribute > ::iterator i;
-    for( i = m.face_attr.begin(); i !=  m.face_attr.end(); ++i)
-      if( (*i)._handle == h._handle ){
-        delete ((SimpleTempData<FaceContainer,ATTR_TYPE>*)(*i)._handle);
-        m.face_attr.erase(i);
-        return;}
+    AttrIterator i = m.face_attr.FindById(h.n_attr);
+    if( i != m.face_attr.end() && (*i)._handle == h._handle ){
+      delete ((SimpleTempData<FaceContainer,ATTR_TYPE>*)(*i)._handle);
+      m.face_attr.erase(i);
+    }
 
   }
 
@@ -1990,10 +2262,7 @@ public:
   {
     if (a._handle == nullptr)
       return false;
-    for (AttrIterator i = m.tetra_attr.begin(); i != m.tetra_attr.end(); ++i)
-      if ((*i).n_attr == a.n_attr)
-        return true;
-    return false;
+    return m.tetra_attr.FindById(a.n_attr) != m.tetra_attr.end();
   }
 
   template <class ATTR_TYPE>
@@ -2001,10 +2270,7 @@ public:
   {
     if (a._handle == nullptr)
       return false;
-    for (AttrIterator i = m.tetra_attr.begin(); i != m.tetra_attr.end(); ++i)
-      if ((*i).n_attr == a.n_attr)
-        return true;
-    return false;
+    return m.tetra_attr.FindById(a.n_attr) != m.tetra_attr.end();
   }
 
   template <class ATTR_TYPE>
@@ -2123,14 +2389,12 @@ public:
   template <class ATTR_TYPE>
   static void DeletePerTetraAttribute(MeshType &m, typename MeshType::template PerTetraAttributeHandle<ATTR_TYPE> &h)
   {
-    typename std::set<PointerToAttribute>::iterator i;
-    for (i = m.tetra_attr.begin(); i != m.tetra_attr.end(); ++i)
-      if ((*i)._handle == h._handle)
-      {
-        delete ((SimpleTempData<TetraContainer, ATTR_TYPE> *)(*i)._handle);
-        m.tetra_attr.erase(i);
-        return;
-      }
+    AttrIterator i = m.tetra_attr.FindById(h.n_attr);
+    if (i != m.tetra_attr.end() && (*i)._handle == h._handle)
+    {
+      delete ((SimpleTempData<TetraContainer, ATTR_TYPE> *)(*i)._handle);
+      m.tetra_attr.erase(i);
+    }
   }
 
   // Generic DeleteAttribute.
@@ -2155,18 +2419,14 @@ public:
   static
   bool IsValidHandle(const MeshType & m,  const typename MeshType::template PerMeshAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.mesh_attr.begin(); i!=m.mesh_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.mesh_attr.FindById(a.n_attr) != m.mesh_attr.end();
   }
 
   template <class ATTR_TYPE>
   static
   bool IsValidHandle(const MeshType & m,  const typename MeshType::template ConstPerMeshAttributeHandle<ATTR_TYPE> & a){
     if(a._handle == nullptr) return false;
-    for(AttrIterator i = m.mesh_attr.begin(); i!=m.mesh_attr.end();++i)
-      if ( (*i).n_attr == a.n_attr ) return true;
-    return false;
+    return m.mesh_attr.FindById(a.n_attr) != m.mesh_attr.end();
   }
 
   template <class ATTR_TYPE>
@@ -2270,12 +2530,11 @@ public:
       */
   template <class ATTR_TYPE>
   static void DeletePerMeshAttribute( MeshType & m,typename MeshType::template PerMeshAttributeHandle<ATTR_TYPE> & h){
-    typename std::set<PointerToAttribute > ::iterator i;
-    for( i = m.mesh_attr.begin(); i !=  m.mesh_attr.end(); ++i)
-      if( (*i)._handle == h._handle ){
-        delete (( Attribute<ATTR_TYPE> *)(*i)._handle);
-        m.mesh_attr.erase(i);
-        return;}
+    AttrIterator i = m.mesh_attr.FindById(h.n_attr);
+    if( i != m.mesh_attr.end() && (*i)._handle == h._handle ){
+      delete (( Attribute<ATTR_TYPE> *)(*i)._handle);
+      m.mesh_attr.erase(i);
+    }
   }
 
   // Generic DeleteAttribute.
@@ -2292,6 +2551,22 @@ public:
     return true;
   }
 
+  /*! \brief Report the memory used by every attribute of the mesh (per vertex, edge, face, tetra and per mesh).
+      \returns the total number of bytes used by the attributes.
+      */
+  static size_t AttributeMemoryReport(const MeshType & m, std::vector<AttributeMemoryInfo> &report){
+    report.clear();
+    AppendAttributeMemoryInfo(m.vert_attr,"vertex",m.vert.size(),report);
+    AppendAttributeMemoryInfo(m.edge_attr,"edge",m.edge.size(),report);
+    AppendAttributeMemoryInfo(m.face_attr,"face",m.face.size(),report);
+    AppendAttributeMemoryInfo(m.tetra_attr,"tetra",m.tetra.size(),report);
+    AppendAttributeMemoryInfo(m.mesh_attr,"mesh",1,report);
+    size_t total=0;
+    for(size_t i=0;i<report.size();++i)
+      total+=report[i].bytes;
+    return total;
+  }
+
   template <class ATTR_TYPE>
   static void FixPaddedPerVertexAttribute (MeshType & m, PointerToAttribute & pa){
 
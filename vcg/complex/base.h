@@ -26,6 +26,8 @@
 
 #include <typeindex>
 #include <set>
+#include <string>
+#include <unordered_map>
 
 #include <vcg/container/simple_temporary_data.h>
 
@@ -51,6 +53,222 @@ public:
 	PointerToAttribute(): _type(typeid(void)) { };
 };
 
+/* AttributeSet is the container of the attributes of one kind of element (vertex, face...).
+   It wraps a std::set ordered by name (its iterators are the std::set ones, so the code that scans
+   the attributes is unchanged), but the named attributes are also hashed by name and all the attributes
+   by their unique id, so that name lookups and handle validity checks do not scan the whole set.
+   The set is not exposed for writing: every mutation goes through the members below, that keep
+   the indexes in sync.
+*/
+class AttributeSet
+{
+public:
+	typedef std::set<PointerToAttribute> SetType;
+	typedef SetType::value_type value_type;
+	typedef SetType::key_type key_type;
+	typedef SetType::size_type size_type;
+	typedef SetType::iterator iterator;
+	typedef SetType::const_iterator const_iterator;
+
+	AttributeSet() {}
+	AttributeSet(const AttributeSet &s) : attr(s.attr) { RebuildIndex(); }
+	AttributeSet & operator = (const AttributeSet &s)
+	{
+		attr = s.attr;
+		RebuildIndex();
+		return *this;
+	}
+
+	/// read only access to the underlying set
+	const SetType &Set() const { return attr; }
+
+	iterator begin() { return attr.begin(); }
+	iterator end() { return attr.end(); }
+	const_iterator begin() const { return attr.begin(); }
+	const_iterator end() const { return attr.end(); }
+	const_iterator cbegin() const { return attr.begin(); }
+	const_iterator cend() const { return attr.end(); }
+	size_type size() const { return attr.size(); }
+	bool empty() const { return attr.empty(); }
+
+	std::pair<iterator,bool> insert(const PointerToAttribute &pa)
+	{
+		std::pair<iterator,bool> res = attr.insert(pa);
+		if(res.second) AddToIndex(res.first);
+		return res;
+	}
+
+	iterator insert(const_iterator hint, const PointerToAttribute &pa)
+	{
+		const size_type sz = attr.size();
+		iterator i = attr.insert(hint,pa);
+		if(attr.size() != sz) AddToIndex(i);
+		return i;
+	}
+
+	template <class InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		for(; first != last; ++first)
+			insert(*first);
+	}
+
+	iterator erase(const_iterator i)
+	{
+		if(!i->_name.empty()) nameIndex.erase(i->_name);
+		idIndex.erase(i->n_attr);
+		return attr.erase(i);
+	}
+
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		while(first != last)
+			first = erase(first);
+		return attr.erase(last,last);
+	}
+
+	size_type erase(const PointerToAttribute &pa)
+	{
+		iterator i = find(pa);
+		if(i == end()) return 0;
+		erase(i);
+		return 1;
+	}
+
+	void clear()
+	{
+		attr.clear();
+		nameIndex.clear();
+		idIndex.clear();
+	}
+
+	void swap(AttributeSet &s)
+	{
+		attr.swap(s.attr);
+		nameIndex.swap(s.nameIndex);
+		idIndex.swap(s.idIndex);
+	}
+
+	iterator find(const PointerToAttribute &pa)
+	{
+		if(pa._name.empty()) return attr.find(pa);
+		return FindByName(pa._name);
+	}
+	const_iterator find(const PointerToAttribute &pa) const
+	{
+		if(pa._name.empty()) return attr.find(pa);
+		return FindByName(pa._name);
+	}
+	size_type count(const PointerToAttribute &pa) const { return find(pa) == end() ? 0 : 1; }
+
+	/// the attribute with the given (non empty) name, end() if none
+	iterator FindByName(const std::string &name)
+	{
+		std::unordered_map<std::string,iterator>::const_iterator hi = nameIndex.find(name);
+		return (hi == nameIndex.end()) ? end() : hi->second;
+	}
+	const_iterator FindByName(const std::string &name) const
+	{
+		std::unordered_map<std::string,iterator>::const_iterator hi = nameIndex.find(name);
+		return (hi == nameIndex.end()) ? end() : const_iterator(hi->second);
+	}
+
+	/// the attribute with the given unique id (PointerToAttribute::n_attr), end() if none
+	iterator FindById(int n_attr)
+	{
+		std::unordered_map<int,iterator>::const_iterator hi = idIndex.find(n_attr);
+		return (hi == idIndex.end()) ? end() : hi->second;
+	}
+	const_iterator FindById(int n_attr) const
+	{
+		std::unordered_map<int,iterator>::const_iterator hi = idIndex.find(n_attr);
+		return (hi == idIndex.end()) ? end() : const_iterator(hi->second);
+	}
+
+private:
+	void AddToIndex(iterator i)
+	{
+		if(!i->_name.empty()) nameIndex[i->_name] = i;
+		idIndex[i->n_attr] = i;
+	}
+
+	void RebuildIndex()
+	{
+		nameIndex.clear();
+		idIndex.clear();
+		for(iterator i = begin(); i != end(); ++i)
+			AddToIndex(i);
+	}
+
+	SetType attr;
+	std::unordered_map<std::string,iterator> nameIndex;
+	std::unordered_map<int,iterator> idIndex;
+};
+
+/* Memory used by a single attribute, as returned by tri::Allocator::AttributeMemoryReport */
+struct AttributeMemoryInfo
+{
+	std::string name;       // empty for unnamed attributes
+	std::string element;    // "vertex", "edge", "face", "tetra" or "mesh"
+	std::type_index type;
+	size_t elemSize;        // size of a single attribute value
+	size_t elemNum;         // number of stored values
+	size_t bytes;           // elemSize*elemNum
+
+	AttributeMemoryInfo() : type(typeid(void)), elemSize(0), elemNum(0), bytes(0) {}
+};
+
+/* Elements touched since the last incremental update of normals and bounding box.
+   It is kept as a per-mesh attribute (see tri::Allocator::EnableDirtyTracking) and filled by the Allocator
+   (add/delete/compaction) and by the local editing operators; it is consumed by
+   tri::UpdateNormal::PerVertexNormalizedPerFaceDirty and tri::UpdateBounding::BoxDirty.
+*/
+class DirtyRegion
+{
+public:
+	/* A set of element indexes, possibly with repetitions.
+	   When it grows over a quarter of the container it degrades to "all the elements", since a full update is cheaper. */
+	class IndexSet
+	{
+	public:
+		std::vector<size_t> idx;
+		bool all;
+
+		IndexSet() : all(true) {}
+		bool Empty() const { return !all && idx.empty(); }
+		void Clear() { all=false; idx.clear(); }
+		void SetAll() { all=true; std::vector<size_t>().swap(idx); }
+
+		void Add(size_t i, size_t containerSize) { AddRange(i,1,containerSize); }
+		void AddRange(size_t first, size_t n, size_t containerSize)
+		{
+			if(all) return;
+			if((idx.size()+n)*4 > containerSize+4) { SetAll(); return; }
+			for(size_t i=0;i<n;++i) idx.push_back(first+i);
+		}
+
+		// remap[i] is the new index of the i-th element, or max size_t if it has been removed
+		void Remap(const std::vector<size_t> &remap)
+		{
+			size_t k=0;
+			for(size_t i=0;i<idx.size();++i)
+				if(idx[i]<remap.size() && remap[idx[i]]!=std::numeric_limits<size_t>::max())
+					idx[k++]=remap[idx[i]];
+			idx.resize(k);
+		}
+	};
+
+	IndexSet normalVert;  // vertices that have been moved or have lost an incident face
+	IndexSet normalFace;  // faces that have been added or whose vertices have been changed
+	IndexSet boxVert;     // vertices that could lie outside the current bounding box
+	bool boxShrink;       // the bounding box could be larger than needed
+
+	// a new region covers everything, so that the first incremental update is a full one
+	DirtyRegion() : boxShrink(true) {}
+
+	static const std::string &AttributeName() { static const std::string name("__DirtyRegion"); return name; }
+};
+
 
 namespace tri {
 /** \addtogroup trimesh */
@@ -272,12 +490,15 @@ public:
 
 	int attrn;	// total numer of attribute created
 
+	/// true while the DirtyRegion attribute is attached (see Allocator::EnableDirtyTracking), so that the allocator can skip the attribute lookup
+	bool dirtyTracking;
 
-	std::set< PointerToAttribute > vert_attr;
-	std::set< PointerToAttribute > edge_attr;
-	std::set< PointerToAttribute > face_attr;
-	std::set< PointerToAttribute > mesh_attr;
-	std::set< PointerToAttribute > tetra_attr;
+
+	AttributeSet vert_attr;
+	AttributeSet edge_attr;
+	AttributeSet face_attr;
+	AttributeSet mesh_attr;
+	AttributeSet tetra_attr;
 
 
 	template <class ATTR_TYPE, class CONT>
@@ -440,6 +661,7 @@ public:
 	/// Default constructor
 	TriMesh()
 	{
+		dirtyTracking = false;
 		Clear();
 	}
 
@@ -533,6 +755,7 @@ public:
 			delete ((SimpleTempDataBase*)(*i)._handle);
 		mesh_attr.clear();
 		attrn = 0;
+		dirtyTracking = false;
 	}
 
 	bool IsEmpty() const
@@ -683,6 +906,10 @@ template < class VertexType> bool VertexVectorHasPerVertexRadius      (const std
 template < class VertexType> bool VertexVectorHasPerVertexCurvatureDir(const std::vector<VertexType> &) {  return VertexType::HasCurvatureDir(); }
 template < class VertexType> bool VertexVectorHasPerVertexTexCoord    (const std::vector<VertexType> &) {  return VertexType::HasTexCoord    (); }
 
+/// Pointer to the packed array of vertex positions when the container stores them out of the vertices (vertex::CoordOcf), 0 otherwise
+template < class VertexType> const typename VertexType::CoordType *VertexVectorCoordData(const std::vector<VertexType> &) { return 0; }
+template < class VertexType>       typename VertexType::CoordType *VertexVectorCoordData(      std::vector<VertexType> &) { return 0; }
+
 template < class TriMeshType> bool HasPerVertexQuality     (const TriMeshType &m) { return tri::VertexVectorHasPerVertexQuality     (m.vert); }
 template < class TriMeshType> bool HasPerVertexNormal      (const TriMeshType &m) { return tri::VertexVectorHasPerVertexNormal      (m.vert); }
 template < class TriMeshType> bool HasPerVertexColor       (const TriMeshType &m) { return tri::VertexVectorHasPerVertexColor       (m.vert); }
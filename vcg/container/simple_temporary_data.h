@@ -29,6 +29,8 @@
 #include <limits>
 #include <vector>
 #include <cassert>
+#include <algorithm>
+#include <utility>
 
 namespace vcg
 {
@@ -193,6 +195,11 @@ public:
 
     void Reorder(std::vector<size_t> &newVertIndex)
     {
+        if (data.size() >= 65536 && IsCompaction(newVertIndex))
+        {
+            ReorderCompaction(newVertIndex);
+            return;
+        }
         for (size_t i = 0; i < data.size(); ++i)
         {
             if (newVertIndex[i] != (std::numeric_limits<size_t>::max)())
@@ -203,6 +210,50 @@ public:
     size_t SizeOf() const { return sizeof(ATTR_TYPE); }
     void *DataBegin() { return data.empty() ? nullptr : data.data(); }
     const void *DataBegin() const { return data.empty() ? nullptr : data.data(); }
+
+private:
+    // true if the remap only moves elements backward, keeping their order (as done when compacting a container)
+    bool IsCompaction(const std::vector<size_t> &newVertIndex) const
+    {
+        const int n = int(data.size());
+        const size_t invalid = (std::numeric_limits<size_t>::max)();
+        bool ok = true;
+#pragma omp parallel for reduction(&& : ok) schedule(static)
+        for (int i = 0; i < n; ++i)
+            if (newVertIndex[i] != invalid && newVertIndex[i] > size_t(i))
+                ok = false;
+        return ok;
+    }
+
+    // Parallel version of the in place reorder for a compaction remap; it gives the same result as the serial loop.
+    // Each block first saves the values that go before the block, then moves the others inside the block,
+    // finally the saved values are written in the slots they left in the previous blocks.
+    void ReorderCompaction(const std::vector<size_t> &newVertIndex)
+    {
+        const size_t n = data.size();
+        const size_t invalid = (std::numeric_limits<size_t>::max)();
+        const int blockNum = int(std::min<size_t>(256, n / 16384));
+        const size_t blockSize = (n + blockNum - 1) / blockNum;
+        std::vector<std::vector<std::pair<size_t, ATTR_TYPE> > > spill(blockNum);
+#pragma omp parallel
+        {
+#pragma omp for schedule(static)
+            for (int b = 0; b < blockNum; ++b)
+            {
+                const size_t lo = b * blockSize, hi = std::min(n, lo + blockSize);
+                for (size_t i = lo; i < hi; ++i)
+                    if (newVertIndex[i] != invalid && newVertIndex[i] < lo)
+                        spill[b].push_back(std::make_pair(newVertIndex[i], ATTR_TYPE(data[i])));
+                for (size_t i = lo; i < hi; ++i)
+                    if (newVertIndex[i] != invalid && newVertIndex[i] >= lo)
+                        data[newVertIndex[i]] = data[i];
+            }
+#pragma omp for schedule(static)
+            for (int b = 0; b < blockNum; ++b)
+                for (size_t k = 0; k < spill[b].size(); ++k)
+                    data[spill[b][k].first] = spill[b][k].second;
+        }
+    }
 };
 
 template <class ATTR_TYPE>
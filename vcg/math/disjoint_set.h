@@ -24,7 +24,9 @@
 #ifndef VCG_MATH_UNIONSET_H
 #define VCG_MATH_UNIONSET_H
 
+#include <atomic>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <assert.h>
 
@@ -125,6 +127,72 @@ namespace vcg
   protected:
     std::vector< DisjointSetNode >				nodes;
   };
+
+  /*!
+  * Disjoint set over the integers [0,n) that can be used concurrently by several threads.
+  * Union() and FindSet() are lock free: a root is always linked below the root with the smaller index
+  * by a compare and swap on its parent, and FindSet() does path halving.
+  * Since parents always have a smaller index, the representative of each set is its smallest element,
+  * so the final partition and its representatives do not depend on the order of the unions.
+  */
+  class ConcurrentDisjointSet
+  {
+  public:
+    ConcurrentDisjointSet() {}
+    explicit ConcurrentDisjointSet(int n) { Init(n); }
+
+    /*!
+    * Makes n singletons, one for each integer in [0,n).
+    */
+    void Init(int n)
+    {
+      std::vector< std::atomic<int> > p(n);
+      for(int i=0;i<n;++i)
+        p[i].store(i,std::memory_order_relaxed);
+      parent.swap(p);
+    }
+
+    int Size() const { return int(parent.size()); }
+
+    /*!
+    * Determine which group a particular element is in (the smallest element of the group).
+    */
+    int FindSet(int x)
+    {
+      assert(x>=0 && x<Size());
+      int p = parent[x].load(std::memory_order_relaxed);
+      while(p!=x)
+      {
+        const int gp = parent[p].load(std::memory_order_relaxed);
+        if(gp!=p)
+          parent[x].compare_exchange_weak(p,gp,std::memory_order_relaxed);
+        x = gp;
+        p = parent[x].load(std::memory_order_relaxed);
+      }
+      return x;
+    }
+
+    /*!
+    * Combine or merge two groups into a single group.
+    */
+    void Union(int x, int y)
+    {
+      for(;;)
+      {
+        x = FindSet(x);
+        y = FindSet(y);
+        if(x==y) return;
+        if(x<y) std::swap(x,y);
+        // x is a root with a larger index than y: link it below y, unless someone else changed it meanwhile
+        int expected = x;
+        if(parent[x].compare_exchange_strong(expected,y,std::memory_order_relaxed))
+          return;
+      }
+    }
+
+  private:
+    std::vector< std::atomic<int> > parent;
+  };
 };// end of namespace vcg
 
 #endif //VCG_MATH_UNIONSET_H
@@ -27,11 +27,21 @@
 #include <string>
 #include <limits>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include <vcg/math/base.h>
 #include <stdio.h>
 
 namespace vcg {
 
+/**
+ * Distribution.
+ *
+ * Keeps all the added values, so that exact percentiles can be computed.
+ * Add() is not thread safe: when filling a distribution from a parallel loop use a
+ * partial distribution for each thread and Merge() them at the end.
+ * For very large number of values see QuantileSketch, that uses a bounded amount of memory.
+ */
 template <class ScalarType>
 class Distribution
 {
@@ -67,6 +77,15 @@ public:
     if(v>max_v) max_v=v;
   }
 
+  //! Add all the values of another distribution (e.g. a partial one filled by another thread).
+  void Merge(const Distribution &d)
+  {
+    vec.insert(vec.end(),d.vec.begin(),d.vec.end());
+    dirty=true;
+    if(d.min_v<min_v) min_v=d.min_v;
+    if(d.max_v>max_v) max_v=d.max_v;
+  }
+
   ScalarType Min() const { return min_v; }
   ScalarType Max() const { return max_v; }
   ScalarType Cnt() const { return ScalarType(vec.size()); }
@@ -120,6 +139,10 @@ public:
  * Histogram.
  *
  * This class implements a single-value histogram.
+ * Counters and sums are kept in double precision, so that the counts stay exact for very large number of samples
+ * even for float histograms.
+ * Add() is not thread safe: when filling a histogram from a parallel loop use a partial histogram for each thread,
+ * defined with the same SetRange() parameters, and Merge() them at the end.
  */
 template <class ScalarType>
 class Histogram
@@ -128,7 +151,7 @@ class Histogram
   // public data members
 protected:
 
-  std::vector <ScalarType> H; 	//! Counters for bins.
+  std::vector <double> H; 	//! Counters for bins.
   std::vector <ScalarType> R; 	//! Range for bins.
   ScalarType minv; 	//! Minimum value.
   ScalarType maxv;	//! Maximum value.
@@ -138,14 +161,14 @@ protected:
 
 
   /// incrementally updated values
-  ScalarType cnt;	//! Number of accumulated samples.
-  ScalarType sum;	//! Average.
-  ScalarType rms; 	//! Root mean square.
+  double cnt;	//! Number of accumulated samples.
+  double sum;	//! Sum of the samples.
+  double rms; 	//! Sum of the squared samples.
 
   /**
         * Returns the index of the bin which contains a given value.
         */
-  int BinIndex(ScalarType val) ;
+  int BinIndex(ScalarType val) const;
 
   // public methods
 public:
@@ -162,13 +185,13 @@ public:
      */
   void SetRange(ScalarType _minv, ScalarType _maxv, int _n,ScalarType gamma=1.0 );
 
-  ScalarType MinV() {return minv;} 	//! Minimum value of the range where the histogram is defined.
-  ScalarType MaxV() {return maxv;} 	//! Maximum value of the range where the histogram is defined.
-  ScalarType Sum()  {return sum;} 	//! Total sum of inserted values.
-  ScalarType Cnt()  {return cnt;}
+  ScalarType MinV() const {return minv;} 	//! Minimum value of the range where the histogram is defined.
+  ScalarType MaxV() const {return maxv;} 	//! Maximum value of the range where the histogram is defined.
+  ScalarType Sum()  const {return sum;} 	//! Total sum of inserted values.
+  ScalarType Cnt()  const {return cnt;}
 
-  ScalarType MinElem() {return minElem;} 	//! Minimum element that has been added to the histogram. It could be < or > than MinV;.
-  ScalarType MaxElem() {return maxElem;} 	//! Maximum element that has been added to the histogram. It could be < or > than MinV;..
+  ScalarType MinElem() const {return minElem;} 	//! Minimum element that has been added to the histogram. It could be < or > than MinV;.
+  ScalarType MaxElem() const {return maxElem;} 	//! Maximum element that has been added to the histogram. It could be < or > than MinV;..
 
   /**
      * Add a new value to the histogram.
@@ -178,16 +201,22 @@ public:
      */
   void Add(ScalarType v, ScalarType increment=ScalarType(1.0));
 
+  /**
+     * Add the content of another histogram defined on the same bins (e.g. a partial histogram
+     * filled by another thread after a SetRange with the same parameters).
+     */
+  void Merge(const Histogram &h);
+
   ScalarType MaxCount() const;        //! Max number of elements among all buckets (including the two infinity bounded buckets)
   ScalarType MaxCountInRange() const; //! Max number of elements among all buckets between MinV and MaxV.
   int BinNum() const {return n;}
-  ScalarType BinCount(ScalarType v);
-  ScalarType BinCountInd(int index) {return H[index];}
-  ScalarType BinCount(ScalarType v, ScalarType width);
-  ScalarType BinLowerBound(int index) {return R[index];}
-  ScalarType BinUpperBound(int index) {return R[index+1];}
-  ScalarType RangeCount(ScalarType rangeMin, ScalarType rangeMax);
-  ScalarType BinWidth(ScalarType v);
+  ScalarType BinCount(ScalarType v) const;
+  ScalarType BinCountInd(int index) const {return H[index];}
+  ScalarType BinCount(ScalarType v, ScalarType width) const;
+  ScalarType BinLowerBound(int index) const {return R[index];}
+  ScalarType BinUpperBound(int index) const {return R[index+1];}
+  ScalarType RangeCount(ScalarType rangeMin, ScalarType rangeMax) const;
+  ScalarType BinWidth(ScalarType v) const;
 
   /**
      * Returns the value corresponding to a given percentile of the data.
@@ -197,16 +226,16 @@ public:
   ScalarType Percentile(ScalarType frac) const;
 
   //! Returns the average of the data.
-  ScalarType Avg(){ return sum/cnt;}
+  ScalarType Avg() const { return sum/cnt;}
 
   //! Returns the Root Mean Square of the data.
-  ScalarType RMS(){ return sqrt(rms/double(cnt));}
+  ScalarType RMS() const { return sqrt(rms/double(cnt));}
 
   //! Returns the variance of the data.
-  ScalarType Variance(){ return fabs(rms/cnt-Avg()*Avg());}
+  ScalarType Variance() const { return fabs(rms/cnt-(sum/cnt)*(sum/cnt));}
 
   //! Returns the standard deviation of the data.
-  ScalarType StandardDeviation(){ return sqrt(Variance());}
+  ScalarType StandardDeviation() const { return sqrt(Variance());}
 
   //! Dump the histogram to a file.
   void FileWrite(const std::string &filename);
@@ -277,11 +306,11 @@ void Histogram<ScalarType>::SetRange(ScalarType _minv, ScalarType _maxv, int _n,
 
 
 template <class ScalarType>
-int Histogram<ScalarType>::BinIndex(ScalarType val)
+int Histogram<ScalarType>::BinIndex(ScalarType val) const
 {
   // lower_bound returns the furthermost iterator i in [first, last) such that, for every iterator j in [first, i), *j < value.
   // E.g. An iterator pointing to the first element "not less than" val, or end() if every element is less than val.
-  typename std::vector<ScalarType>::iterator it = lower_bound(R.begin(),R.end(),val);
+  typename std::vector<ScalarType>::const_iterator it = lower_bound(R.begin(),R.end(),val);
 
   assert(it!=R.begin());
   assert(it!=R.end());
@@ -313,35 +342,48 @@ void Histogram<ScalarType>::Add(ScalarType v, ScalarType increment)
   assert((pos>=0)&&(pos<=n+1));
   H[pos]+=increment;
   cnt+=increment;
-  sum+=v*increment;
-  rms += (v*v)*increment;
+  sum += double(v)*increment;
+  rms += double(v)*double(v)*increment;
 }
 
 template <class ScalarType>
-ScalarType Histogram<ScalarType>::BinCount(ScalarType v)
+void Histogram<ScalarType>::Merge(const Histogram &h)
+{
+  assert(n==h.n && R==h.R);
+  for(size_t i=0;i<H.size();++i)
+    H[i]+=h.H[i];
+  if(h.minElem<minElem) minElem=h.minElem;
+  if(h.maxElem>maxElem) maxElem=h.maxElem;
+  cnt+=h.cnt;
+  sum+=h.sum;
+  rms+=h.rms;
+}
+
+template <class ScalarType>
+ScalarType Histogram<ScalarType>::BinCount(ScalarType v) const
 {
   return H[BinIndex(v)];
 }
 
 template <class ScalarType>
-ScalarType Histogram<ScalarType>::BinCount(ScalarType v, ScalarType width)
+ScalarType Histogram<ScalarType>::BinCount(ScalarType v, ScalarType width) const
 {
   return RangeCount(v-width/2.0,v+width/2.0);
 }
 
 template <class ScalarType>
-ScalarType Histogram<ScalarType>::RangeCount(ScalarType rangeMin, ScalarType rangeMax)
+ScalarType Histogram<ScalarType>::RangeCount(ScalarType rangeMin, ScalarType rangeMax) const
 {
   int firstBin=BinIndex(rangeMin);
   int lastBin=BinIndex (rangeMax);
-  ScalarType sum=0;
+  double sum=0;
   for(int i=firstBin; i<=lastBin;++i)
     sum+=H[i];
   return sum;
 }
 
 template <class ScalarType>
-ScalarType Histogram<ScalarType>::BinWidth(ScalarType v)
+ScalarType Histogram<ScalarType>::BinWidth(ScalarType v) const
 {
   int pos=BinIndex(v);
   return R[pos+1]-R[pos];
@@ -385,7 +427,7 @@ ScalarType Histogram<ScalarType>::Percentile(ScalarType frac) const
   // check percentile range
   assert(frac >= 0 && frac <= 1);
 
-  ScalarType sum=0,partsum=0;
+  double sum=0,partsum=0;
   size_t i;
 
   // useless summation just to be sure
@@ -404,6 +446,162 @@ ScalarType Histogram<ScalarType>::Percentile(ScalarType frac) const
   return R[i+1];
 }
 
+/**
+ * QuantileSketch.
+ *
+ * Bounded memory replacement of Distribution for very large streams of values (e.g. the distances
+ * sampled by a metro-like Hausdorff computation). Count, min, max, average, RMS and variance are exact;
+ * percentiles are approximated with a KLL sketch: the values are kept in a hierarchy of compactors,
+ * a value in level h standing for 2^h samples; when a level is full it is sorted and half of its values
+ * (the even or the odd ones, chosen by a coin flip) are promoted to the next level.
+ * With accuracy parameter k at most about 3k values are stored and the rank error of Percentile()
+ * is about 1.7/k of the number of samples (e.g. 0.2% for the default k=1024).
+ *
+ * As for the other accumulators Add() is not thread safe: fill a sketch for each thread and Merge() them.
+ * The coin flips come from a fixed seed generator, so the results are reproducible, but they depend
+ * (within the error bound) on the insertion and merge order.
+ */
+template <class ScalarType>
+class QuantileSketch
+{
+private:
+  int k;
+  std::vector<std::vector<ScalarType> > level;
+  std::vector<size_t> depthCapacity;  // capacity of the level at depth d below the top one, extended when a level is added
+  unsigned int seed;  // state of the generator of the coin flips choosing the promoted values
+  double n;
+  double valSum;
+  double sqrdValSum;
+  double min_v;
+  double max_v;
+
+  // sorted values with their cumulated weight, rebuilt lazily for the percentile queries
+  std::vector<std::pair<ScalarType,double> > cumulated;
+  bool dirty;
+
+  size_t Capacity(size_t h) const { return depthCapacity[level.size()-1-h]; }
+
+  void AddLevel()
+  {
+    level.push_back(std::vector<ScalarType>());
+    if(depthCapacity.size()<level.size())
+    {
+      const double c = std::ceil(double(k)*std::pow(2.0/3.0,double(depthCapacity.size())));
+      depthCapacity.push_back(std::max<size_t>(2,size_t(c)));
+    }
+  }
+
+  void Compress()
+  {
+    for(size_t h=0;h<level.size();++h)
+    {
+      if(level[h].size()<Capacity(h)) continue;
+      if(h+1==level.size()) AddLevel();
+      std::vector<ScalarType> &cur = level[h];
+      std::sort(cur.begin(),cur.end());
+      // with an odd number of values the smallest one stays in this level
+      const size_t first = cur.size()%2;
+      seed = seed*1664525u + 1013904223u;
+      for(size_t i=first+(seed>>31);i<cur.size();i+=2)
+        level[h+1].push_back(cur[i]);
+      cur.resize(first);
+    }
+  }
+
+public:
+  QuantileSketch(int _k=1024):k(std::max(_k,8)) { Clear(); }
+
+  void Clear()
+  {
+    level.clear();
+    AddLevel();
+    seed=0x9e3779b9u;
+    n=0;
+    valSum=0;
+    sqrdValSum=0;
+    min_v =  std::numeric_limits<double>::max();
+    max_v = -std::numeric_limits<double>::max();
+    cumulated.clear();
+    dirty=true;
+  }
+
+  void Add(const ScalarType v)
+  {
+    level[0].push_back(v);
+    n+=1;
+    valSum += double(v);
+    sqrdValSum += double(v)*double(v);
+    if(v<min_v) min_v=v;
+    if(v>max_v) max_v=v;
+    dirty=true;
+    if(level[0].size()>=Capacity(0)) Compress();
+  }
+
+  //! Add all the values summarized by another sketch (e.g. a partial one filled by another thread).
+  void Merge(const QuantileSketch &q)
+  {
+    while(level.size()<q.level.size()) AddLevel();
+    for(size_t h=0;h<q.level.size();++h)
+      level[h].insert(level[h].end(),q.level[h].begin(),q.level[h].end());
+    n+=q.n;
+    valSum+=q.valSum;
+    sqrdValSum+=q.sqrdValSum;
+    if(q.min_v<min_v) min_v=q.min_v;
+    if(q.max_v>max_v) max_v=q.max_v;
+    dirty=true;
+    Compress();
+  }
+
+  ScalarType Min() const { return min_v; }
+  ScalarType Max() const { return max_v; }
+  ScalarType Cnt() const { return ScalarType(n); }
+  //! Number of values actually stored by the sketch.
+  size_t Size() const
+  {
+    size_t sz=0;
+    for(size_t h=0;h<level.size();++h) sz+=level[h].size();
+    return sz;
+  }
+
+  ScalarType Sum() const { return valSum; }
+  ScalarType Avg() const { return valSum/n; }
+  //! Returns the Root Mean Square of the data.
+  ScalarType RMS() const { return math::Sqrt(sqrdValSum/n); }
+  //! \brief Returns the variance of the data.
+  /// the average of the squares less the square of the average.
+  ScalarType Variance() const { return sqrdValSum/n - (valSum/n)*(valSum/n); }
+  //! Returns the standard deviation of the data.
+  ScalarType StandardDeviation() const { return sqrt( Variance() ); }
+
+  //! Approximated value below which a fraction perc of the samples lies (same convention of Distribution::Percentile).
+  ScalarType Percentile(ScalarType perc)
+  {
+    assert(n>0);
+    assert(perc>=0 && perc<=1);
+    if(dirty)
+    {
+      cumulated.clear();
+      for(size_t h=0;h<level.size();++h)
+        for(size_t i=0;i<level[h].size();++i)
+          cumulated.push_back(std::make_pair(level[h][i],std::ldexp(1.0,int(h))));
+      std::sort(cumulated.begin(),cumulated.end());
+      for(size_t i=1;i<cumulated.size();++i)
+        cumulated[i].second+=cumulated[i-1].second;
+      dirty=false;
+    }
+    if(perc==0) return min_v;
+    if(perc==1) return max_v;
+    const double rank = std::max(1.0,std::floor(n*perc));
+    size_t lo=0, hi=cumulated.size()-1;
+    while(lo<hi)
+    {
+      const size_t mid=(lo+hi)/2;
+      if(cumulated[mid].second<rank) lo=mid+1; else hi=mid;
+    }
+    return cumulated[lo].first;
+  }
+};
+
 typedef Histogram<double> Histogramd ;
 typedef Histogram<float> Histogramf ;
 
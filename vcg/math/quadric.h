@@ -23,6 +23,7 @@
 #ifndef __VCGLIB_QUADRIC
 #define __VCGLIB_QUADRIC
 
+#include <cmath>
 #include <vcg/space/point3.h>
 #include <vcg/space/plane3.h>
 #include <vcg/math/matrix33.h>
@@ -35,6 +36,8 @@ namespace math {
  *  This class encode a quadric function 
  *  f(x) = xAx +bx + c
  *  where A is a symmetric 3x3 matrix, b a vector and c a scalar constant.  
+ *  The ten coefficients are stored contiguously and the arithmetic operators are written
+ *  as plain loops over them, so that the compiler can map them onto SIMD registers.
  */ 
 template<typename  _ScalarType>
 class Quadric
@@ -108,32 +111,18 @@ public:
 
   void SetZero()
   {
-    a[0] = 0;
-    a[1] = 0;
-    a[2] = 0;
-    a[3] = 0;
-    a[4] = 0;
-    a[5] = 0;
-    b[0] = 0;
-    b[1] = 0;
-    b[2] = 0;
-    c    = 0;
+    for(int i=0;i<6;++i) a[i] = 0;
+    for(int i=0;i<3;++i) b[i] = 0;
+    c = 0;
   }
   
   void operator = ( const Quadric & q )
   {
     assert( q.IsValid() );
     
-    a[0] = q.a[0];
-    a[1] = q.a[1];
-    a[2] = q.a[2];
-    a[3] = q.a[3];
-    a[4] = q.a[4];
-    a[5] = q.a[5];
-    b[0] = q.b[0];
-    b[1] = q.b[1];
-    b[2] = q.b[2];
-    c    = q.c;
+    for(int i=0;i<6;++i) a[i] = q.a[i];
+    for(int i=0;i<3;++i) b[i] = q.b[i];
+    c = q.c;
   }
   
   void operator += ( const Quadric & q )
@@ -141,46 +130,42 @@ public:
     assert( IsValid() );
     assert( q.IsValid() );
     
-    a[0] += q.a[0];
-    a[1] += q.a[1];
-    a[2] += q.a[2];
-    a[3] += q.a[3];
-    a[4] += q.a[4];
-    a[5] += q.a[5];
-    b[0] += q.b[0];
-    b[1] += q.b[1];
-    b[2] += q.b[2];
-    c    += q.c;
+    for(int i=0;i<6;++i) a[i] += q.a[i];
+    for(int i=0;i<3;++i) b[i] += q.b[i];
+    c += q.c;
   }
   
   void operator *= ( const ScalarType & w )			// Amplifica una quadirca
   {
     assert( IsValid() );
     
-    a[0] *= w;
-    a[1] *= w;
-    a[2] *= w;
-    a[3] *= w;
-    a[4] *= w;
-    a[5] *= w;
-    b[0] *= w;
-    b[1] *= w;
-    b[2] *= w;
-    c    *= w;
+    for(int i=0;i<6;++i) a[i] *= w;
+    for(int i=0;i<3;++i) b[i] *= w;
+    c *= w;
   }
   
-  
+  /// Set this quadric to the sum of q0 and q1 (avoids the temporary copy of q=q0; q+=q1;)
+  void SetSum( const Quadric & q0, const Quadric & q1 )
+  {
+    assert( q0.IsValid() && q1.IsValid() );
+    
+    for(int i=0;i<6;++i) a[i] = q0.a[i]+q1.a[i];
+    for(int i=0;i<3;++i) b[i] = q0.b[i]+q1.b[i];
+    c = q0.c+q1.c;
+  }
   
   /* Evaluate a quadric over a point p.
+   * It is computed as p.(Ap + b) + c, which needs about half of the products of the expanded form.
    */
   template <class ResultScalarType>
   ResultScalarType Apply( const Point3<ResultScalarType> & p ) const
   {
     assert( IsValid() );
-    return ResultScalarType (
-            p[0]*p[0]*a[0] + 2*p[0]*p[1]*a[1] + 2*p[0]*p[2]*a[2] + p[0]*b[0]
-        +   p[1]*p[1]*a[3] + 2*p[1]*p[2]*a[4] + p[1]*b[1]
-        +   p[2]*p[2]*a[5] + p[2]*b[2]	+ c);
+    const ResultScalarType x=p[0], y=p[1], z=p[2];
+    const ResultScalarType r0 = a[0]*x + a[1]*y + a[2]*z;
+    const ResultScalarType r1 = a[1]*x + a[3]*y + a[4]*z;
+    const ResultScalarType r2 = a[2]*x + a[4]*y + a[5]*z;
+    return ResultScalarType( x*(r0+b[0]) + y*(r1+b[1]) + z*(r2+b[2]) + c );
   }
   
   
@@ -193,10 +178,39 @@ public:
   // Find the point minimizing the quadric xAx + bx + c 
   // by solving the first derivative 2 Ax + b = 0 
   // return true if the found solution fits the system. 
+  // A well conditioned system is solved in closed form with the adjugate of the symmetric A;
+  // when it is not, or the closed form solution does not pass the residual check, a full pivoting LU is used.
   
   template <class ReturnScalarType>
   bool Minimum(Point3<ReturnScalarType> &x)
   {
+    const double a0=a[0], a1=a[1], a2=a[2], a3=a[3], a4=a[4], a5=a[5];
+    const double c00 = a3*a5 - a4*a4;
+    const double c01 = a2*a4 - a1*a5;
+    const double c02 = a1*a4 - a2*a3;
+    const double c11 = a0*a5 - a2*a2;
+    const double c12 = a1*a2 - a0*a4;
+    const double c22 = a0*a3 - a1*a1;
+    const double det = a0*c00 + a1*c01 + a2*c02;
+    // Hadamard bound of the determinant: |det| is close to it only when the rows are far from being dependent
+    const double rowNorm = std::sqrt((a0*a0+a1*a1+a2*a2)*(a1*a1+a3*a3+a4*a4)*(a2*a2+a4*a4+a5*a5));
+    if(std::fabs(det) > 1e-6*rowNorm)
+    {
+      const double be0=-b[0]/2, be1=-b[1]/2, be2=-b[2]/2;
+      const double x0 = (c00*be0 + c01*be1 + c02*be2)/det;
+      const double x1 = (c01*be0 + c11*be1 + c12*be2)/det;
+      const double x2 = (c02*be0 + c12*be1 + c22*be2)/det;
+      const double r0 = a0*x0 + a1*x1 + a2*x2 - be0;
+      const double r1 = a1*x0 + a3*x1 + a4*x2 - be1;
+      const double r2 = a2*x0 + a4*x1 + a5*x2 - be2;
+      if(r0*r0+r1*r1+r2*r2 <= (be0*be0+be1*be1+be2*be2) * RelativeErrorThr() * RelativeErrorThr())
+      {
+        x[0]=ReturnScalarType(x0); x[1]=ReturnScalarType(x1); x[2]=ReturnScalarType(x2);
+        return true;
+      }
+      // the closed form lost too much precision: solve it again with the LU below
+    }
+    
     Eigen::Matrix3d A;
     Eigen::Vector3d be;
     A << a[0], a[1], a[2],
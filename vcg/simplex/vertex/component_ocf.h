@@ -66,8 +66,13 @@ public:
 // redefined in order to manage the additional data.
   void push_back(const VALUE_TYPE & v)
     {
+        // The position is not stored in the vertex: read it from the container of v
+        // before the push_back, that could reallocate it if v belongs to this vector.
+        typename VALUE_TYPE::CoordType p = typename VALUE_TYPE::CoordType();
+        if (VALUE_TYPE::HasCoordOcf() && v._ovp!=0) p = v.cP();
         BaseType::push_back(v);
         BaseType::back()._ovp = this;
+        if (VALUE_TYPE::HasCoordOcf()) PV.push_back(p);
         if (ColorEnabled)         CV.push_back(vcg::Color4b(vcg::Color4b::White));
         if (QualityEnabled)       QV.push_back(0);
         if (MarkEnabled)          MV.push_back(0);
@@ -81,6 +86,21 @@ public:
 
     void pop_back();
 
+    void clear()
+    {
+        BaseType::clear();
+        PV.clear();
+        CV.clear();
+        QV.clear();
+        MV.clear();
+        NV.clear();
+        TV.clear();
+        AV.clear();
+        CuV.clear();
+        CuDV.clear();
+        RadiusV.clear();
+    }
+
     void resize(size_t _size)
     {
         const size_t oldsize = BaseType::size();
@@ -90,6 +110,7 @@ public:
             advance(firstnew,oldsize);
             _updateOVP(firstnew,(*this).end());
         }
+        if (VALUE_TYPE::HasCoordOcf()) PV.resize(_size);
         if (ColorEnabled)         CV.resize(_size);
         if (QualityEnabled)       QV.resize(_size,0);
         if (MarkEnabled)          MV.resize(_size);
@@ -104,6 +125,7 @@ public:
     void reserve(size_t _size)
     {
         BaseType::reserve(_size);
+        if (VALUE_TYPE::HasCoordOcf()) PV.reserve(_size);
         if (ColorEnabled)        CV.reserve(_size);
         if (QualityEnabled)      QV.reserve(_size);
         if (MarkEnabled)         MV.reserve(_size);
@@ -244,6 +266,7 @@ struct VFAdjType {
     };
 
 public:
+  std::vector<typename VALUE_TYPE::CoordType> PV;
   std::vector<typename VALUE_TYPE::ColorType> CV;
   std::vector<typename VALUE_TYPE::CurvatureType> CuV;
   std::vector<typename VALUE_TYPE::CurvatureDirType> CuDV;
@@ -269,6 +292,33 @@ public:
 //template<>	void EnableAttribute<typename VALUE_TYPE::NormalType>(){	NormalEnabled=true;}
 
 /*------------------------- COORD -----------------------------------------*/
+/*! \brief Position of the vertex stored outside the vertex, in a contiguous array of the vector_ocf.
+  Unlike the other ocf components it is always enabled. Positions of consecutive vertices
+  are packed together (vector_ocf::PV), so passes that only read or write P() stream
+  through a compact array instead of striding over whole vertices.
+  */
+template <class A, class T> class CoordOcf: public T {
+public:
+  typedef A CoordType;
+  typedef typename A::ScalarType      ScalarType;
+  inline const CoordType &P() const { return (*this).Base().PV[(*this).Index()]; }
+  inline       CoordType &P()       { return (*this).Base().PV[(*this).Index()]; }
+  inline       CoordType cP() const { return (*this).Base().PV[(*this).Index()]; }
+
+  template < class RightValueType>
+  void ImportData(const RightValueType  & rVert ) { if(rVert.IsCoordEnabled()) P().Import(rVert.cP()); T::ImportData( rVert); }
+  static bool HasCoord()   { return true; }
+  static bool HasCoordOcf()   { assert(!T::HasCoordOcf()); return true; }
+  static void Name(std::vector<std::string> & name){name.push_back(std::string("CoordOcf"));T::Name(name);}
+};
+
+template <class T> class Coord3fOcf: public CoordOcf<vcg::Point3f, T> {
+public: static void Name(std::vector<std::string> & name){name.push_back(std::string("Coord3fOcf"));T::Name(name);}
+};
+template <class T> class Coord3dOcf: public CoordOcf<vcg::Point3d, T> {
+public: static void Name(std::vector<std::string> & name){name.push_back(std::string("Coord3dOcf"));T::Name(name);}
+};
+
 /*----------------------------- VFADJ ------------------------------*/
 
 
@@ -522,6 +572,8 @@ template <class T> class RadiusdOcf: public RadiusOcf<double, T> {};
 
 template < class T> class InfoOcf: public T {
 public:
+    InfoOcf():_ovp(0) {}
+
     // You should never ever try to copy a vertex that has OCF stuff.
         // use ImportData function.
     inline InfoOcf &operator=(const InfoOcf & /*other*/) {
@@ -538,6 +590,7 @@ public:
 public:
     vector_ocf<typename T::VertexType> *_ovp;
 
+    static bool HasCoordOcf()   { return false; }
     static bool HasColorOcf()   { return false; }
     static bool HasCurvatureOcf()   { return false; }
     static bool HasCurvatureDirOcf()   { return false; }
@@ -604,6 +657,19 @@ bool VertexVectorHasPerVertexTexCoord(const vertex::vector_ocf<VertexType> &fv)
     if(VertexType::HasTexCoordOcf()) return fv.IsTexCoordEnabled();
     else return VertexType::HasTexCoord();
 }
+
+template < class VertexType >
+const typename VertexType::CoordType *VertexVectorCoordData(const vertex::vector_ocf<VertexType> &fv)
+{
+    if(VertexType::HasCoordOcf() && !fv.PV.empty()) return &fv.PV[0];
+    else return 0;
+}
+template < class VertexType >
+typename VertexType::CoordType *VertexVectorCoordData(vertex::vector_ocf<VertexType> &fv)
+{
+    if(VertexType::HasCoordOcf() && !fv.PV.empty()) return &fv.PV[0];
+    else return 0;
+}
 }
 }// end namespace vcg
 #endif
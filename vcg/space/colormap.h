@@ -2,6 +2,7 @@
 #define __VCGLIB_COLORMAP_H
 
 #include <vcg/space/color4.h>
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -253,6 +254,63 @@ inline vcg::Color4b GetColorMapping(double v, double minv, double maxv, ColorMap
 	return c0;
 }
 
+/**
+ * Lookup table of a color ramp over a range of values.
+ *
+ * The range [minv, maxv] is split into size bins, each one storing the color of the ramp at its center,
+ * so mapping a value costs a multiplication and a table access instead of a full ramp evaluation
+ * (colors differ at most by about one level from the exact ramp with the default 4096 bins).
+ * Values outside the range get the colors of its ends. The lookup is const and thread safe;
+ * it is used by the per element quality ramps of tri::UpdateColor.
+ */
+class ColorMapLUT
+{
+public:
+	/// LUT of one of the predefined color maps (see GetColorMapping)
+	ColorMapLUT(double minv, double maxv, ColorMap cmap = ColorMap::RGB, int size = 4096)
+	{
+		Init(minv, maxv, size, [cmap](double v, double mi, double ma) { return GetColorMapping(v, mi, ma, cmap); });
+	}
+
+	/// LUT of a generic ramp, ramp(v, minv, maxv) must return the vcg::Color4b of the value v
+	template <class RampFunctor>
+	ColorMapLUT(double minv, double maxv, RampFunctor ramp, int size = 4096)
+	{
+		Init(minv, maxv, size, ramp);
+	}
+
+	vcg::Color4b operator()(double v) const
+	{
+		const double t = (v - minv) * scale;
+		if (!(t > 0)) return lut.front();
+		if (t >= double(lut.size())) return lut.back();
+		return lut[size_t(t)];
+	}
+
+	size_t Size() const { return lut.size(); }
+
+private:
+	template <class RampFunctor>
+	void Init(double _minv, double _maxv, int size, RampFunctor ramp)
+	{
+		minv = _minv;
+		lut.resize(std::max(size, 1));
+		if (_maxv == _minv)
+		{
+			scale = 0;
+			std::fill(lut.begin(), lut.end(), ramp(_minv, _minv, _maxv));
+			return;
+		}
+		scale = double(lut.size()) / (_maxv - _minv);
+		for (size_t i = 0; i < lut.size(); ++i)
+			lut[i] = ramp(_minv + (double(i) + 0.5) / scale, _minv, _maxv);
+	}
+
+	std::vector<vcg::Color4b> lut;
+	double minv;
+	double scale;
+};
+
 } // namespace vcg
 
 #endif